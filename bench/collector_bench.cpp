@@ -0,0 +1,539 @@
+// Benchmark of the Linux collectors against generated fixture trees.
+//
+// Builds a /proc + /sys tree for each CPU/GPU count, points the collectors
+// at it through their root argument and measures collect(): wall time,
+// libc calls that enter the kernel, and heap allocations per sample. The
+// NVIDIA collector runs against the stub NVML library (tests/nvml_stub.cpp),
+// which also counts driver calls. The DRM fdinfo scan and the process
+// table run against process trees with a fixed handful of GPU clients
+// among many processes, the cgroup collector against container trees, the
+// disk collector against hosts with many NVMe namespaces and dm devices.
+// Usage: resmon_bench [iterations]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <dirent.h>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <new>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "backend/linux/cgroup_linux.h"
+#include "backend/linux/cpu_linux.h"
+#include "backend/linux/disk_linux.h"
+#include "backend/linux/drm_devices.h"
+#include "backend/linux/drm_fdinfo.h"
+#include "backend/linux/gpu_amd.h"
+#include "backend/linux/gpu_intel.h"
+#include "backend/linux/gpu_nvidia.h"
+#include "backend/linux/pressure_linux.h"
+#include "backend/linux/process_linux.h"
+#include "backend/linux/ram_linux.h"
+#include "fixtures.h"
+
+using namespace resmon::platform;
+
+// ============================================================================
+// Counters. Syscalls are counted by interposing the libc entry points the
+// collectors use; allocations by replacing the global operator new.
+// ============================================================================
+
+static std::atomic<bool> g_counting{false};
+static std::atomic<uint64_t> g_syscalls{0};
+static std::atomic<uint64_t> g_allocations{0};
+
+static void countSyscall() {
+    if (g_counting.load(std::memory_order_relaxed)) {
+        g_syscalls.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+template <typename Fn>
+static Fn nextSymbol(const char* name) {
+    return reinterpret_cast<Fn>(dlsym(RTLD_NEXT, name));
+}
+
+extern "C" {
+
+int open(const char* path, int flags, ...) {
+    static auto real = nextSymbol<int (*)(const char*, int, ...)>("open");
+    mode_t mode = 0;
+    if (flags & O_CREAT) {
+        va_list args;
+        va_start(args, flags);
+        mode = static_cast<mode_t>(va_arg(args, int));
+        va_end(args);
+    }
+    countSyscall();
+    return real(path, flags, mode);
+}
+
+int open64(const char* path, int flags, ...) {
+    static auto real = nextSymbol<int (*)(const char*, int, ...)>("open64");
+    mode_t mode = 0;
+    if (flags & O_CREAT) {
+        va_list args;
+        va_start(args, flags);
+        mode = static_cast<mode_t>(va_arg(args, int));
+        va_end(args);
+    }
+    countSyscall();
+    return real(path, flags, mode);
+}
+
+int openat(int dirfd, const char* path, int flags, ...) {
+    static auto real = nextSymbol<int (*)(int, const char*, int, ...)>("openat");
+    mode_t mode = 0;
+    if (flags & O_CREAT) {
+        va_list args;
+        va_start(args, flags);
+        mode = static_cast<mode_t>(va_arg(args, int));
+        va_end(args);
+    }
+    countSyscall();
+    return real(dirfd, path, flags, mode);
+}
+
+ssize_t pread(int fd, void* buf, size_t count, off_t offset) {
+    static auto real = nextSymbol<ssize_t (*)(int, void*, size_t, off_t)>("pread");
+    countSyscall();
+    return real(fd, buf, count, offset);
+}
+
+ssize_t pread64(int fd, void* buf, size_t count, off_t offset) {
+    static auto real = nextSymbol<ssize_t (*)(int, void*, size_t, off_t)>("pread64");
+    countSyscall();
+    return real(fd, buf, count, offset);
+}
+
+ssize_t read(int fd, void* buf, size_t count) {
+    static auto real = nextSymbol<ssize_t (*)(int, void*, size_t)>("read");
+    countSyscall();
+    return real(fd, buf, count);
+}
+
+int close(int fd) {
+    static auto real = nextSymbol<int (*)(int)>("close");
+    countSyscall();
+    return real(fd);
+}
+
+off_t lseek(int fd, off_t offset, int whence) {
+    static auto real = nextSymbol<off_t (*)(int, off_t, int)>("lseek");
+    countSyscall();
+    return real(fd, offset, whence);
+}
+
+ssize_t getdents64(int fd, void* buffer, size_t length) {
+    static auto real = nextSymbol<ssize_t (*)(int, void*, size_t)>("getdents64");
+    countSyscall();
+    return real(fd, buffer, length);
+}
+
+ssize_t readlinkat(int dirfd, const char* path, char* buf, size_t size) {
+    static auto real = nextSymbol<ssize_t (*)(int, const char*, char*, size_t)>("readlinkat");
+    countSyscall();
+    return real(dirfd, path, buf, size);
+}
+
+int access(const char* path, int mode) {
+    static auto real = nextSymbol<int (*)(const char*, int)>("access");
+    countSyscall();
+    return real(path, mode);
+}
+
+// opendir/readdir/closedir: open + getdents64 (+ a final empty one) + close
+DIR* opendir(const char* path) {
+    static auto real = nextSymbol<DIR* (*)(const char*)>("opendir");
+    countSyscall();
+    return real(path);
+}
+
+struct dirent* readdir(DIR* dir) {
+    static auto real = nextSymbol<struct dirent* (*)(DIR*)>("readdir");
+    struct dirent* entry = real(dir);
+    if (!entry) {
+        countSyscall();
+    }
+    return entry;
+}
+
+int closedir(DIR* dir) {
+    static auto real = nextSymbol<int (*)(DIR*)>("closedir");
+    countSyscall();
+    return real(dir);
+}
+
+} // extern "C"
+
+void* operator new(size_t size) {
+    if (g_counting.load(std::memory_order_relaxed)) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    void* p = std::malloc(size > 0 ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    std::free(p);
+}
+
+// ============================================================================
+// Fixtures
+// ============================================================================
+
+static const char PRESSURE_FILE[] =
+    "some avg10=1.25 avg60=3.80 avg300=2.11 total=413457471\n"
+    "full avg10=0.00 avg60=0.41 avg300=0.20 total=20117735\n";
+
+static void writeHostFixture(const FixtureTree& tree, int cpu_count) {
+    tree.write("proc/stat", makeProcStat(cpu_count));
+    tree.write("proc/meminfo", makeMemInfo());
+    tree.write("proc/pressure/cpu", PRESSURE_FILE);
+    tree.write("proc/pressure/memory", PRESSURE_FILE);
+    tree.write("proc/pressure/io", PRESSURE_FILE);
+    tree.write("sys/class/hwmon/hwmon0/name", "acpitz\n");
+    tree.write("sys/class/hwmon/hwmon0/temp1_input", "27800\n");
+    tree.write("sys/class/hwmon/hwmon1/name", "coretemp\n");
+    tree.write("sys/class/hwmon/hwmon1/temp1_input", "48000\n");
+}
+
+// gpu_count cards, alternating AMD and Intel
+static void writeGpuFixture(const FixtureTree& tree, int gpu_count) {
+    for (int i = 0; i < gpu_count; ++i) {
+        std::string device = "sys/class/drm/card" + std::to_string(i) + "/device/";
+        std::string connector = "sys/class/drm/card" + std::to_string(i) + "-DP-1/status";
+        tree.write(connector, "disconnected\n");
+        if (i % 2 == 0) {
+            tree.write(device + "vendor", "0x1002\n");
+            tree.write(device + "product_name", "AMD Instinct MI300X\n");
+            tree.write(device + "gpu_busy_percent", std::to_string(i * 5 % 100) + "\n");
+            tree.write(device + "mem_info_vram_used", "8589934592\n");
+            tree.write(device + "mem_info_vram_total", "206158430208\n");
+            tree.write(device + "hwmon/hwmon" + std::to_string(10 + i) + "/temp1_input", "61000\n");
+        } else {
+            tree.write(device + "vendor", "0x8086\n");
+            tree.write(device + "uevent", "DRIVER=i915\nPCI_SLOT_NAME=0000:00:0" + std::to_string(i) + ".0\n");
+            tree.write(device + "hwmon/hwmon" + std::to_string(10 + i) + "/temp1_input", "52000\n");
+        }
+    }
+}
+
+// process_count processes in /proc, the first DRM_CLIENTS of which hold a
+// render node of the Intel GPU at 0000:00:01.0 (card1 of writeGpuFixture)
+static constexpr int DRM_CLIENTS = 8;
+
+static void writeProcessFixture(const FixtureTree& tree, int process_count) {
+    for (int i = 0; i < process_count; ++i) {
+        std::string proc = "proc/" + std::to_string(1000 + i) + "/";
+        tree.write(proc + "comm", "worker" + std::to_string(i) + "\n");
+        tree.write(proc + "stat", std::to_string(1000 + i) + " (worker" + std::to_string(i) + ") S 1 " +
+                   std::to_string(1000 + i) + " 1000 0 -1 4194560 1532 0 0 0 " +
+                   std::to_string(i * 7 % 1000) + " " + std::to_string(i % 13) +
+                   " 0 0 20 0 1 0 4152 12345678 " + std::to_string(100 + i * 37 % 50000) +
+                   " 18446744073709551615 1 1 0 0 0 0 0 0 0 0 0 0 17 3 0 0 0 0 0\n");
+        tree.link(proc + "fd/0", "/dev/null");
+        tree.link(proc + "fd/1", "pipe:[" + std::to_string(20000 + i) + "]");
+        if (i < DRM_CLIENTS) {
+            tree.link(proc + "fd/3", "/dev/dri/renderD128");
+            tree.write(proc + "fdinfo/3",
+                       "pos:\t0\nflags:\t02100002\nmnt_id:\t26\nino:\t1045\n"
+                       "drm-driver:\ti915\ndrm-client-id:\t" + std::to_string(i + 1) + "\n"
+                       "drm-pdev:\t0000:00:01.0\n"
+                       "drm-total-system0:\t36 MiB\ndrm-resident-system0:\t36 MiB\n"
+                       "drm-engine-render:\t" + std::to_string(1000000ull * (i + 1)) + " ns\n"
+                       "drm-engine-copy:\t0 ns\ndrm-engine-video:\t5000 ns\n"
+                       "drm-engine-capacity-video:\t2\ndrm-engine-video-enhance:\t0 ns\n");
+        }
+    }
+}
+
+// disk_count NVMe namespaces with three partitions each, one dm device per
+// namespace (an LVM volume or dm-crypt mapping) and a few loop devices.
+// Only the namespaces have a /sys/block/<name>/device link.
+static void writeDiskFixture(const FixtureTree& tree, int disk_count) {
+    static const char COUNTERS[] =
+        " 3061258 1204 189112810 540121 9914302 8812215 1398120344 7621930 2 4021210 8187312"
+        " 118201 0 902318120 10211 614021 90112\n";
+    std::string diskstats;
+    for (int i = 0; i < 8; ++i) {
+        diskstats += "   7       " + std::to_string(i) + " loop" + std::to_string(i) + " 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0\n";
+    }
+    for (int i = 0; i < disk_count; ++i) {
+        std::string name = "nvme" + std::to_string(i) + "n1";
+        int minor = i * 4;
+        diskstats += " 259 " + std::to_string(minor) + " " + name + COUNTERS;
+        for (int part = 1; part <= 3; ++part) {
+            diskstats += " 259 " + std::to_string(minor + part) + " " + name + "p" + std::to_string(part) + COUNTERS;
+        }
+        tree.write("sys/block/" + name + "/device/uevent", "DEVTYPE=disk\n");
+    }
+    for (int i = 0; i < disk_count; ++i) {
+        std::string name = "dm-" + std::to_string(i);
+        diskstats += " 253 " + std::to_string(i) + " " + name + COUNTERS;
+        tree.write("sys/block/" + name + "/dm/name", "vg0-lv" + std::to_string(i) + "\n");
+    }
+    tree.write("proc/diskstats", diskstats);
+}
+
+// group_count container scopes under /system.slice, each with the files
+// a cgroup v2 group with cpu, memory, io and pids enabled has
+static void writeCgroupFixture(const FixtureTree& tree, int group_count) {
+    tree.write("sys/fs/cgroup/cgroup.controllers", "cpuset cpu io memory hugetlb pids rdma misc\n");
+    tree.write("sys/fs/cgroup/cgroup.events", "populated 1\nfrozen 0\n");
+    for (int i = 0; i < group_count; ++i) {
+        std::string group = "sys/fs/cgroup/system.slice/docker-" + std::to_string(100000 + i) + ".scope/";
+        tree.write(group + "cgroup.events", "populated 1\nfrozen 0\n");
+        tree.write(group + "cpu.stat", "usage_usec " + std::to_string(123456789ull * (i + 1)) +
+                   "\nuser_usec 98765432\nsystem_usec 24691357\nnr_periods 3012\n"
+                   "nr_throttled 12\nthrottled_usec 456789\nnr_bursts 0\nburst_usec 0\n");
+        tree.write(group + "memory.current", std::to_string(268435456ull + i * 4096ull) + "\n");
+        tree.write(group + "memory.max", i % 3 == 0 ? "max\n" : "1073741824\n");
+        tree.write(group + "memory.events", "low 0\nhigh 0\nmax 17\noom 1\noom_kill 1\noom_group_kill 0\n");
+        tree.write(group + "io.stat", "259:0 rbytes=18698240 wbytes=4096000 rios=512 wios=1000 dbytes=0 dios=0\n"
+                   "253:0 rbytes=18698240 wbytes=4096000 rios=512 wios=1000 dbytes=0 dios=0\n");
+        tree.write(group + "pids.current", "12\n");
+        tree.write(group + "cpu.pressure", PRESSURE_FILE);
+        tree.write(group + "memory.pressure", PRESSURE_FILE);
+        tree.write(group + "io.pressure", PRESSURE_FILE);
+    }
+}
+
+// ============================================================================
+// Measurement
+// ============================================================================
+
+struct Result {
+    double ns_per_sample;
+    double syscalls_per_sample;
+    double allocations_per_sample;
+    double driver_calls_per_sample;
+};
+
+typedef uint64_t (*CallCounter)();
+
+// Keep results observable so the compiler can't drop the work
+static volatile uint64_t g_sink;
+
+// driver_calls: optional counter of NVML calls (the stub's)
+template <typename Fn>
+static Result measure(int iterations, Fn&& collect, CallCounter driver_calls = nullptr) {
+    // Warm up: first reads size the buffers and open the descriptors
+    for (int i = 0; i < 3; ++i) {
+        collect();
+    }
+
+    uint64_t calls_before = driver_calls ? driver_calls() : 0;
+    g_syscalls = 0;
+    g_allocations = 0;
+    g_counting = true;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        collect();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    g_counting = false;
+    uint64_t calls_after = driver_calls ? driver_calls() : 0;
+
+    Result result;
+    result.ns_per_sample =
+        static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / iterations;
+    result.syscalls_per_sample = static_cast<double>(g_syscalls.load()) / iterations;
+    result.allocations_per_sample = static_cast<double>(g_allocations.load()) / iterations;
+    result.driver_calls_per_sample = static_cast<double>(calls_after - calls_before) / iterations;
+    return result;
+}
+
+static void printResult(int cpus, int gpus, const char* collector, const Result& result) {
+    std::printf("%5d %5d  %-11s %9.0f %10.1f %10.1f %10.1f\n", cpus, gpus, collector,
+                result.ns_per_sample, result.syscalls_per_sample, result.allocations_per_sample,
+                result.driver_calls_per_sample);
+}
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 2000;
+    if (iterations < 1) {
+        std::fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    static const int cpu_counts[] = {1, 8, 64, 512};
+    static const int gpu_counts[] = {0, 1, 4, 16};
+
+    std::printf(" cpus  gpus  collector    ns/sample   syscalls     allocs nvml calls\n");
+
+    for (int cpus : cpu_counts) {
+        FixtureTree tree;
+        if (!tree.valid()) {
+            std::fprintf(stderr, "cannot create a fixture directory\n");
+            return 1;
+        }
+        writeHostFixture(tree, cpus);
+
+        CpuCollector cpu(tree.root());
+        printResult(cpus, 0, "cpu", measure(iterations, [&] {
+            g_sink = g_sink + static_cast<uint64_t>(cpu.collect().usage_percent);
+        }));
+
+        RamCollector ram(tree.root());
+        printResult(cpus, 0, "ram", measure(iterations, [&] {
+            g_sink = g_sink + ram.collect().total_bytes;
+        }));
+
+        PressureCollector pressure(tree.root());
+        printResult(cpus, 0, "pressure", measure(iterations, [&] {
+            g_sink = g_sink + pressure.collect().memory.some.total_us;
+        }));
+    }
+
+    for (int gpus : gpu_counts) {
+        FixtureTree tree;
+        if (!tree.valid()) {
+            std::fprintf(stderr, "cannot create a fixture directory\n");
+            return 1;
+        }
+        writeGpuFixture(tree, gpus);
+
+        // A hotplug rescan: the cost paid once per drm uevent burst
+        DrmDeviceEnumerator drm(tree.root());
+        static const char uevent[] = "add@/devices/pci0000:00/0000:00:02.0/drm/card9\0ACTION=add\0"
+                                     "DEVPATH=/devices/pci0000:00/0000:00:02.0/drm/card9\0SUBSYSTEM=drm\0";
+        printResult(0, gpus, "drm rescan", measure(iterations, [&] {
+            drm.injectUevent(uevent, sizeof(uevent));
+            g_sink = g_sink + drm.poll();
+        }));
+
+        // No /proc in this tree: the client scan is measured below
+        DrmClientScanner clients(tree.root());
+        AmdGpuCollector amd(clients);
+        amd.setDevices(drm.devices());
+        printResult(0, gpus, "amd", measure(iterations, [&] {
+            g_sink = g_sink + amd.collect().size();
+        }));
+
+        IntelGpuCollector intel(clients);
+        intel.setDevices(drm.devices());
+        printResult(0, gpus, "intel", measure(iterations, [&] {
+            g_sink = g_sink + intel.collect().size();
+        }));
+    }
+
+    static const int process_counts[] = {100, 1000, 4000, 20000};
+    for (int processes : process_counts) {
+        // Fewer rounds for the large trees, same total work as ~100 processes
+        int rounds = std::max(10, iterations / std::max(1, processes / 100));
+        FixtureTree tree;
+        if (!tree.valid()) {
+            std::fprintf(stderr, "cannot create a fixture directory\n");
+            return 1;
+        }
+        writeGpuFixture(tree, 2);
+        writeProcessFixture(tree, processes);
+
+        DrmDeviceEnumerator drm(tree.root());
+        drm.scan();
+        // The backend's per-sample work: one client scan, then the summary
+        DrmClientScanner clients(tree.root());
+        std::vector<std::string> pdevs;
+        for (const DrmDevice& device : drm.devices()) {
+            pdevs.push_back(device.pci_address);
+        }
+        clients.setDevices(pdevs);
+        IntelGpuCollector intel(clients);
+        intel.setDevices(drm.devices());
+        char label[32];
+        std::snprintf(label, sizeof(label), "intel/%dp", processes);
+        printResult(0, 2, label, measure(rounds, [&] {
+            clients.update();
+            g_sink = g_sink + intel.collect().front().processes.size();
+        }));
+
+        ProcessCollector top(tree.root());
+        std::snprintf(label, sizeof(label), "procs/%dp", processes);
+        printResult(0, 0, label, measure(rounds, [&] {
+            g_sink = g_sink + top.collect().top_cpu.size();
+        }));
+    }
+
+    static const int disk_counts[] = {4, 64, 256};
+    for (int disks : disk_counts) {
+        FixtureTree tree;
+        if (!tree.valid()) {
+            std::fprintf(stderr, "cannot create a fixture directory\n");
+            return 1;
+        }
+        writeDiskFixture(tree, disks);
+
+        DiskCollector disk(tree.root());
+        char label[32];
+        std::snprintf(label, sizeof(label), "disks/%d", disks);
+        printResult(0, 0, label, measure(iterations, [&] {
+            g_sink = g_sink + disk.collect().size();
+        }));
+    }
+
+    static const int cgroup_counts[] = {30, 300, 1000};
+    for (int groups : cgroup_counts) {
+        FixtureTree tree;
+        if (!tree.valid()) {
+            std::fprintf(stderr, "cannot create a fixture directory\n");
+            return 1;
+        }
+        writeCgroupFixture(tree, groups);
+
+        CgroupCollector cgroups(tree.root());
+        int rounds = std::max(10, iterations / std::max(1, groups / 30));
+        char label[32];
+        std::snprintf(label, sizeof(label), "cgroup/%d", groups);
+        printResult(0, 0, label, measure(rounds, [&] {
+            g_sink = g_sink + cgroups.collect().size();
+        }));
+    }
+
+#ifdef RESMON_NVML_STUB
+    // Keep a reference to the stub so its call counter stays reachable
+    void* stub = dlopen(RESMON_NVML_STUB, RTLD_LAZY);
+    CallCounter stub_calls = stub
+        ? reinterpret_cast<CallCounter>(dlsym(stub, "resmonStubCallCount"))
+        : nullptr;
+    if (!stub_calls) {
+        std::fprintf(stderr, "cannot load the NVML stub %s\n", RESMON_NVML_STUB);
+        return 1;
+    }
+
+    for (int gpus : gpu_counts) {
+        setenv("RESMON_STUB_GPUS", std::to_string(gpus).c_str(), 1);
+        NvidiaGpuCollector nvidia(RESMON_NVML_STUB);
+        printResult(0, gpus, "nvidia", measure(iterations, [&] {
+            g_sink = g_sink + nvidia.collect().size();
+        }, stub_calls));
+    }
+#endif
+
+    return 0;
+}
@@ -0,0 +1,135 @@
+// Microbenchmark for the /proc/stat and /proc/meminfo parsers.
+//
+// Compares the stream-based parsing the collectors used before with the
+// allocation-free parsers in proc_parse.h, on synthetic files sized like
+// a large host, and the full per-CPU /proc/stat parse. Usage: resmon_parse_bench [cpu_count] [iterations]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+
+#include "backend/linux/proc_parse.h"
+#include "fixtures.h"
+
+using namespace resmon::platform;
+
+// Keep results observable so the compiler can't drop the work
+static volatile uint64_t g_sink;
+
+// Parsers as they were before proc_parse.h
+
+static bool legacyParseProcStat(const std::string& text, uint64_t& idle_time, uint64_t& total_time) {
+    std::istringstream stat_file(text);
+    std::string line;
+    if (!std::getline(stat_file, line)) {
+        return false;
+    }
+
+    std::istringstream iss(line);
+    std::string cpu_label;
+    iss >> cpu_label;
+    if (cpu_label != "cpu") {
+        return false;
+    }
+
+    uint64_t user = 0, nice = 0, system = 0, idle = 0;
+    uint64_t iowait = 0, irq = 0, softirq = 0, steal = 0;
+    iss >> user >> nice >> system >> idle >> iowait >> irq >> softirq >> steal;
+
+    idle_time = idle + iowait;
+    total_time = user + nice + system + idle + iowait + irq + softirq + steal;
+    return true;
+}
+
+static uint64_t legacyParseMemInfoLine(const std::string& line) {
+    std::istringstream iss(line);
+    std::string field_name;
+    uint64_t value = 0;
+    std::string unit;
+    iss >> field_name >> value >> unit;
+    return value;
+}
+
+static uint64_t legacyParseMemInfo(const std::string& text) {
+    std::istringstream meminfo(text);
+    uint64_t total = 0, available = 0, free_kb = 0, buffers = 0, cached = 0;
+    std::string line;
+    while (std::getline(meminfo, line)) {
+        if (line.find("MemTotal:") == 0) {
+            total = legacyParseMemInfoLine(line);
+        } else if (line.find("MemAvailable:") == 0) {
+            available = legacyParseMemInfoLine(line);
+        } else if (line.find("MemFree:") == 0) {
+            free_kb = legacyParseMemInfoLine(line);
+        } else if (line.find("Buffers:") == 0) {
+            buffers = legacyParseMemInfoLine(line);
+        } else if (line.find("Cached:") == 0) {
+            if (line.find("SwapCached:") != 0) {
+                cached = legacyParseMemInfoLine(line);
+            }
+        }
+    }
+    return total + available + free_kb + buffers + cached;
+}
+
+template <typename Fn>
+static double nsPerCall(int iterations, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        fn();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) /
+           iterations;
+}
+
+int main(int argc, char** argv) {
+    int cpu_count = argc > 1 ? std::atoi(argv[1]) : 256;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 200000;
+    if (cpu_count < 1 || iterations < 1) {
+        std::fprintf(stderr, "usage: %s [cpu_count] [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    // The collectors read the whole file into a buffer first, so the text
+    // is prepared once and only parsing is measured
+    const std::string stat_text = makeProcStat(cpu_count);
+    const std::string meminfo_text = makeMemInfo();
+
+    double stat_legacy = nsPerCall(iterations, [&] {
+        uint64_t idle = 0, total = 0;
+        legacyParseProcStat(stat_text, idle, total);
+        g_sink = g_sink + idle + total;
+    });
+    double stat_new = nsPerCall(iterations, [&] {
+        CpuTimes times;
+        parseProcStatCpu(stat_text, times);
+        g_sink = g_sink + times.idleTime() + times.totalTime();
+    });
+    // Every cpuN line plus ctxt/procs_*, as CpuCollector reads it now
+    ProcStat proc_stat;
+    double stat_all = nsPerCall(iterations, [&] {
+        parseProcStat(stat_text, proc_stat);
+        g_sink = g_sink + proc_stat.counters[CPU_IDLE].back() + proc_stat.context_switches;
+    });
+    double mem_legacy = nsPerCall(iterations, [&] {
+        g_sink = g_sink + legacyParseMemInfo(meminfo_text);
+    });
+    double mem_new = nsPerCall(iterations, [&] {
+        MemInfo info = parseMemInfo(meminfo_text);
+        g_sink = g_sink + info.mem_total_kb + info.mem_available_kb + info.mem_free_kb +
+                 info.buffers_kb + info.cached_kb;
+    });
+
+    std::printf("/proc/stat (%d cpus, %zu bytes)\n", cpu_count, stat_text.size());
+    std::printf("  istringstream  %10.1f ns/sample\n", stat_legacy);
+    std::printf("  proc_parse     %10.1f ns/sample  (%.1fx)\n", stat_new, stat_legacy / stat_new);
+    std::printf("  all cpu lines  %10.1f ns/sample\n", stat_all);
+    std::printf("/proc/meminfo (%zu bytes)\n", meminfo_text.size());
+    std::printf("  istringstream  %10.1f ns/sample\n", mem_legacy);
+    std::printf("  proc_parse     %10.1f ns/sample  (%.1fx)\n", mem_new, mem_legacy / mem_new);
+
+    return 0;
+}
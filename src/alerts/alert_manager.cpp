@@ -21,6 +21,11 @@ AlertSeverity AlertManager::checkThreshold(float value, const AlertThreshold& th
     return AlertSeverity::None;
 }
 
+AlertSeverity AlertManager::checkPressure(const ResourcePressure& pressure, const AlertThreshold& threshold) const {
+    float value = pressure.some.avg10 > pressure.triggered_percent ? pressure.some.avg10 : pressure.triggered_percent;
+    return checkThreshold(value, threshold);
+}
+
 AlertManager::AlertState AlertManager::check(const SystemMetrics& metrics) {
     AlertState state;
 
@@ -58,6 +63,24 @@ AlertManager::AlertState AlertManager::check(const SystemMetrics& metrics) {
         }
     }
 
+    // Check disks - return worst severity across all disks
+    state.disk = AlertSeverity::None;
+    for (const auto& disk : metrics.disks) {
+        AlertSeverity utilization_severity = checkThreshold(disk.utilization_percent, config_.disk_utilization);
+        AlertSeverity await_severity = checkThreshold(disk.await_ms, config_.disk_await_ms);
+        AlertSeverity disk_severity = (await_severity > utilization_severity) ? await_severity : utilization_severity;
+        if (disk_severity > state.disk) {
+            state.disk = disk_severity;
+        }
+    }
+
+    // Check pressure stalls (only if the kernel reports them)
+    if (metrics.pressure.available) {
+        state.cpu_pressure = checkPressure(metrics.pressure.cpu, config_.cpu_pressure);
+        state.memory_pressure = checkPressure(metrics.pressure.memory, config_.memory_pressure);
+        state.io_pressure = checkPressure(metrics.pressure.io, config_.io_pressure);
+    }
+
     return state;
 }
 
@@ -16,6 +16,10 @@ public:
         AlertSeverity cpu = AlertSeverity::None;
         AlertSeverity ram = AlertSeverity::None;
         AlertSeverity gpu = AlertSeverity::None;  // worst of all GPUs
+        AlertSeverity disk = AlertSeverity::None; // worst of all disks
+        AlertSeverity cpu_pressure = AlertSeverity::None;
+        AlertSeverity memory_pressure = AlertSeverity::None;
+        AlertSeverity io_pressure = AlertSeverity::None;
     };
 
     AlertState check(const SystemMetrics& metrics);
@@ -28,6 +32,10 @@ private:
     // Helper to check a value against a threshold
     AlertSeverity checkThreshold(float value, const AlertThreshold& threshold) const;
 
+    // Recent stall share, or the threshold a kernel trigger reported
+    // crossed since the last sample, whichever is higher
+    AlertSeverity checkPressure(const ResourcePressure& pressure, const AlertThreshold& threshold) const;
+
     AlertConfig config_;
     std::chrono::steady_clock::time_point last_notification_;
 };
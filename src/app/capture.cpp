@@ -0,0 +1,55 @@
+#include "app/capture.h"
+
+#include <cstdio>
+#include <iostream>
+
+#ifdef RESMON_LINUX
+#include "backend/linux/high_rate_sampler.h"
+#endif
+
+namespace resmon {
+
+#ifdef RESMON_LINUX
+
+int runHighRateCapture(const AppOptions& options) {
+    using platform::HighRateSampler;
+
+    // Size the buffer for the whole capture up front
+    double seconds = static_cast<double>(options.capture_duration.count()) / 1000.0;
+    size_t capacity = static_cast<size_t>(seconds * options.high_rate_hz) + 1;
+    HighRateSampler sampler(capacity, options.backend.fs_root);
+
+    std::cerr << "resmon: sampling CPU/RAM at " << options.high_rate_hz << " Hz for "
+              << seconds << " s\n";
+    platform::HighRateReport report = sampler.capture(options.high_rate_hz, options.capture_duration);
+
+    std::printf("time_ms,cpu_percent,window_ms,ram_percent\n");
+    for (const auto& sample : sampler.samples()) {
+        std::printf("%.3f,%.1f,%.1f,%.2f\n",
+                    static_cast<double>(sample.time_us) / 1000.0,
+                    sample.cpu_percent, sample.window_ms, sample.ram_percent);
+    }
+
+    std::fprintf(stderr,
+                 "resmon: %zu samples, %.1f Hz achieved (%.1f Hz requested)\n"
+                 "resmon: /proc/stat resolution %ld ticks/s, smoothing window >= %llu ticks\n"
+                 "resmon: read+parse %.1f us mean, %.1f us max; wakeup lateness %.1f us max\n"
+                 "resmon: sampler CPU overhead %.2f%% of one core\n",
+                 report.samples, report.achieved_hz, report.requested_hz,
+                 report.clock_ticks_per_sec,
+                 static_cast<unsigned long long>(HighRateSampler::MIN_WINDOW_JIFFIES),
+                 report.mean_read_us, report.max_read_us, report.max_lateness_us,
+                 report.sampler_cpu_percent);
+    return 0;
+}
+
+#else
+
+int runHighRateCapture(const AppOptions& /*options*/) {
+    std::cerr << "resmon: high-rate sampling is only supported on Linux\n";
+    return 1;
+}
+
+#endif
+
+} // namespace resmon
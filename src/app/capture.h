@@ -0,0 +1,14 @@
+#ifndef RESMON_APP_CAPTURE_H
+#define RESMON_APP_CAPTURE_H
+
+#include "app/options.h"
+
+namespace resmon {
+
+// Run a high-rate CPU/RAM capture, print the samples as CSV on stdout and
+// an overhead report on stderr. Returns the exit code.
+int runHighRateCapture(const AppOptions& options);
+
+} // namespace resmon
+
+#endif // RESMON_APP_CAPTURE_H
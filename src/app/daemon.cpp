@@ -0,0 +1,322 @@
+#include "app/daemon.h"
+
+#include <csignal>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <pthread.h>
+#include <string>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#include "app/sampler.h"
+
+namespace resmon {
+
+static const char* severityName(AlertSeverity severity) {
+    switch (severity) {
+        case AlertSeverity::Critical: return "critical";
+        case AlertSeverity::Warning:  return "warning";
+        case AlertSeverity::None:
+        default:                      return "ok";
+    }
+}
+
+// Append s to out as a JSON string literal
+static void appendJsonString(std::string& out, const std::string& s) {
+    out += '"';
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(c));
+            out += escaped;
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+static void appendJsonSamples(std::string& out, const std::vector<GpuSample>& samples) {
+    char buf[64];
+    out += '[';
+    for (size_t i = 0; i < samples.size(); ++i) {
+        snprintf(buf, sizeof(buf), "%s[%llu,%.1f]", i > 0 ? "," : "",
+                 static_cast<unsigned long long>(samples[i].timestamp_us), samples[i].value);
+        out += buf;
+    }
+    out += ']';
+}
+
+static void appendJsonModes(std::string& out, const CpuModes& modes) {
+    char buf[192];
+    snprintf(buf, sizeof(buf),
+             "{\"user\":%.1f,\"nice\":%.1f,\"system\":%.1f,\"iowait\":%.1f,\"irq\":%.1f,"
+             "\"softirq\":%.1f,\"steal\":%.1f,\"guest\":%.1f}",
+             modes.user, modes.nice, modes.system, modes.iowait, modes.irq, modes.softirq,
+             modes.steal, modes.guest);
+    out += buf;
+}
+
+static void appendJsonProcesses(std::string& out, const std::vector<ProcessInfo>& processes) {
+    char buf[96];
+    out += '[';
+    for (size_t i = 0; i < processes.size(); ++i) {
+        const ProcessInfo& process = processes[i];
+        snprintf(buf, sizeof(buf), "%s{\"pid\":%u,\"name\":", i > 0 ? "," : "",
+                 static_cast<unsigned>(process.pid));
+        out += buf;
+        appendJsonString(out, process.name);
+        snprintf(buf, sizeof(buf), ",\"cpu\":%.1f,\"rss\":%llu}", process.cpu_percent,
+                 static_cast<unsigned long long>(process.rss_bytes));
+        out += buf;
+    }
+    out += ']';
+}
+
+// "some" and "full" as [avg10, avg60, total_us]
+static void appendJsonPressure(std::string& out, const char* name, const ResourcePressure& pressure,
+                               AlertSeverity severity) {
+    char buf[192];
+    snprintf(buf, sizeof(buf),
+             "\"%s\":{\"some\":[%.2f,%.2f,%llu],\"full\":[%.2f,%.2f,%llu],\"triggered\":%.1f,\"alert\":\"%s\"}",
+             name, pressure.some.avg10, pressure.some.avg60,
+             static_cast<unsigned long long>(pressure.some.total_us), pressure.full.avg10,
+             pressure.full.avg60, static_cast<unsigned long long>(pressure.full.total_us),
+             pressure.triggered_percent, severityName(severity));
+    out += buf;
+}
+
+// One sample as a single-line JSON object
+static void formatJson(const Snapshot& snapshot, std::string& out) {
+    const SystemMetrics& m = snapshot.metrics;
+    char buf[256];
+
+    out.clear();
+    snprintf(buf, sizeof(buf),
+             "{\"seq\":%llu,\"time_ms\":%llu,\"cpu\":{\"usage\":%.1f,\"temp\":%.1f,\"cores\":%d,\"alert\":\"%s\","
+             "\"ctxt_rate\":%.0f,\"procs_running\":%u,\"procs_blocked\":%u,\"modes\":",
+             static_cast<unsigned long long>(snapshot.sequence),
+             static_cast<unsigned long long>(m.timestamp_ms),
+             m.cpu.usage_percent, m.cpu.temperature_celsius, m.cpu.core_count,
+             severityName(snapshot.alerts.cpu), m.cpu.context_switches_per_second,
+             static_cast<unsigned>(m.cpu.procs_running), static_cast<unsigned>(m.cpu.procs_blocked));
+    out += buf;
+    appendJsonModes(out, m.cpu.modes);
+
+    // Per core: id, usage, then the modes in CpuModes order
+    out += ",\"per_core\":[";
+    for (size_t i = 0; i < m.cpu.cores.size(); ++i) {
+        const CpuCoreMetrics& core = m.cpu.cores[i];
+        const CpuModes& modes = core.modes;
+        snprintf(buf, sizeof(buf), "%s[%u,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f]",
+                 i > 0 ? "," : "", static_cast<unsigned>(core.id), core.usage_percent, modes.user,
+                 modes.nice, modes.system, modes.iowait, modes.irq, modes.softirq, modes.steal,
+                 modes.guest);
+        out += buf;
+    }
+
+    snprintf(buf, sizeof(buf),
+             "]},\"ram\":{\"used\":%llu,\"total\":%llu,\"usage\":%.1f,\"alert\":\"%s\"},\"gpus\":[",
+             static_cast<unsigned long long>(m.ram.used_bytes),
+             static_cast<unsigned long long>(m.ram.total_bytes),
+             m.ram.usage_percent, severityName(snapshot.alerts.ram));
+    out += buf;
+
+    for (size_t i = 0; i < m.gpus.size(); ++i) {
+        const GpuMetrics& gpu = m.gpus[i];
+        if (i > 0) {
+            out += ',';
+        }
+        out += "{\"name\":";
+        appendJsonString(out, gpu.name);
+        out += ",\"vendor\":";
+        appendJsonString(out, gpu.vendor);
+        snprintf(buf, sizeof(buf),
+                 ",\"usage\":%.1f,\"temp\":%.1f,\"vram_used\":%llu,\"vram_total\":%llu,\"power\":%.1f,",
+                 gpu.usage_percent, gpu.temperature_celsius,
+                 static_cast<unsigned long long>(gpu.vram_used_bytes),
+                 static_cast<unsigned long long>(gpu.vram_total_bytes), gpu.power_watts);
+        out += buf;
+
+        // Driver samples since the previous line, as [time_us, value] pairs
+        out += "\"util_samples\":";
+        appendJsonSamples(out, gpu.utilization_samples);
+        out += ",\"power_samples\":";
+        appendJsonSamples(out, gpu.power_samples);
+        out += ",\"engines\":[";
+        for (size_t j = 0; j < gpu.engines.size(); ++j) {
+            out += j > 0 ? ",{\"name\":" : "{\"name\":";
+            appendJsonString(out, gpu.engines[j].name);
+            snprintf(buf, sizeof(buf), ",\"busy\":%.1f}", gpu.engines[j].busy_percent);
+            out += buf;
+        }
+        out += "],\"processes\":[";
+
+        for (size_t j = 0; j < gpu.processes.size(); ++j) {
+            const GpuProcess& process = gpu.processes[j];
+            snprintf(buf, sizeof(buf), "%s{\"pid\":%u,\"name\":", j > 0 ? "," : "",
+                     static_cast<unsigned>(process.pid));
+            out += buf;
+            appendJsonString(out, process.name);
+            snprintf(buf, sizeof(buf), ",\"vram\":%llu,\"usage\":%.1f,\"type\":\"%s\"}",
+                     static_cast<unsigned long long>(process.vram_bytes), process.usage_percent,
+                     gpuProcessType(process));
+            out += buf;
+        }
+        out += "]}";
+    }
+
+    snprintf(buf, sizeof(buf), "],\"gpu_alert\":\"%s\",\"processes\":{\"count\":%u,\"top_cpu\":",
+             severityName(snapshot.alerts.gpu), static_cast<unsigned>(m.processes.count));
+    out += buf;
+    appendJsonProcesses(out, m.processes.top_cpu);
+    out += ",\"top_rss\":";
+    appendJsonProcesses(out, m.processes.top_rss);
+
+    out += "}";
+    if (m.pressure.available) {
+        out += ",\"pressure\":{";
+        appendJsonPressure(out, "cpu", m.pressure.cpu, snapshot.alerts.cpu_pressure);
+        out += ',';
+        appendJsonPressure(out, "memory", m.pressure.memory, snapshot.alerts.memory_pressure);
+        out += ',';
+        appendJsonPressure(out, "io", m.pressure.io, snapshot.alerts.io_pressure);
+        out += '}';
+    }
+
+    out += ",\"disks\":[";
+    for (size_t i = 0; i < m.disks.size(); ++i) {
+        const DiskMetrics& disk = m.disks[i];
+        out += i > 0 ? ",{\"name\":" : "{\"name\":";
+        appendJsonString(out, disk.name);
+        snprintf(buf, sizeof(buf),
+                 ",\"read\":%.0f,\"write\":%.0f,\"read_iops\":%.1f,\"write_iops\":%.1f,\"await_ms\":%.2f,"
+                 "\"util\":%.1f,\"queue\":%.2f,\"in_flight\":%u}",
+                 disk.read_bytes_per_second, disk.write_bytes_per_second, disk.read_ops_per_second,
+                 disk.write_ops_per_second, disk.await_ms, disk.utilization_percent, disk.queue_depth,
+                 static_cast<unsigned>(disk.in_flight));
+        out += buf;
+    }
+    snprintf(buf, sizeof(buf), "],\"disk_alert\":\"%s\"", severityName(snapshot.alerts.disk));
+    out += buf;
+
+    out += ",\"cgroups\":[";
+    for (size_t i = 0; i < m.cgroups.size(); ++i) {
+        const CgroupMetrics& group = m.cgroups[i];
+        out += i > 0 ? ",{\"path\":" : "{\"path\":";
+        appendJsonString(out, group.path);
+        snprintf(buf, sizeof(buf),
+                 ",\"populated\":%s,\"cpu\":%.1f,\"throttled\":%.1f,\"mem\":%llu,\"mem_max\":%llu,"
+                 "\"oom_kills\":%llu,\"io_read\":%.0f,\"io_write\":%.0f,\"iops\":%.0f,\"pids\":%llu",
+                 group.populated ? "true" : "false", group.cpu_percent, group.throttled_percent,
+                 static_cast<unsigned long long>(group.memory_bytes),
+                 static_cast<unsigned long long>(group.memory_max_bytes),
+                 static_cast<unsigned long long>(group.oom_kills), group.io_read_bytes_per_second,
+                 group.io_write_bytes_per_second, group.io_ops_per_second,
+                 static_cast<unsigned long long>(group.pids));
+        out += buf;
+        if (group.pressure.available) {
+            // "some" avg10 of each resource
+            snprintf(buf, sizeof(buf), ",\"psi\":{\"cpu\":%.2f,\"memory\":%.2f,\"io\":%.2f}",
+                     group.pressure.cpu.some.avg10, group.pressure.memory.some.avg10,
+                     group.pressure.io.some.avg10);
+            out += buf;
+        }
+        out += '}';
+    }
+
+    // resmon's own cost, so a reader can rule the monitor out as the load
+    const OverheadMetrics& overhead = m.overhead;
+    snprintf(buf, sizeof(buf),
+             "],\"overhead\":{\"cpu\":%.2f,\"rss\":%llu,\"collect_us\":%.1f,\"collect_p50_us\":%.1f,"
+             "\"collect_p99_us\":%.1f,\"collect_max_us\":%.1f,\"collectors\":[",
+             overhead.cpu_percent,
+             static_cast<unsigned long long>(overhead.rss_bytes), overhead.collect_us,
+             overhead.collect_p50_us, overhead.collect_p99_us, overhead.collect_max_us);
+    out += buf;
+
+    for (size_t i = 0; i < overhead.collectors.size(); ++i) {
+        const CollectorTiming& timing = overhead.collectors[i];
+        snprintf(buf, sizeof(buf),
+                 "%s{\"name\":\"%s\",\"calls\":%llu,\"last_us\":%.1f,\"mean_us\":%.1f,"
+                 "\"p50_us\":%.1f,\"p99_us\":%.1f,\"max_us\":%.1f}",
+                 i > 0 ? "," : "", timing.name, static_cast<unsigned long long>(timing.calls),
+                 timing.last_us, timing.mean_us, timing.p50_us, timing.p99_us, timing.max_us);
+        out += buf;
+    }
+    out += "]}}\n";
+}
+
+// Log a line when a metric's alert severity changes
+static void reportAlertChange(const char* metric, AlertSeverity previous, AlertSeverity current) {
+    if (previous != current) {
+        std::cerr << "resmon: " << metric << " " << severityName(previous)
+                  << " -> " << severityName(current) << "\n";
+    }
+}
+
+int runDaemon(const AppOptions& options) {
+    // Block the shutdown signals before any thread starts so every thread
+    // inherits the mask and the main thread can take them with sigwait()
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGHUP);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    MetricArchiveWriter archive;
+    if (!options.record_path.empty() && !archive.open(options.record_path, options.record_size_bytes)) {
+        std::cerr << "resmon: " << archive.error() << "\n";
+        return 1;
+    }
+
+    std::unique_ptr<IMetricsBackend> backend = createBackend(options);
+    if (!backend) {
+        return 1;
+    }
+
+    Sampler sampler(std::move(backend), options.interval);
+    if (archive.isOpen()) {
+        sampler.setArchive(&archive);
+    }
+
+    // The sampler thread is also the only consumer of its snapshots here
+    AlertManager::AlertState last_alerts;
+    std::string line;
+    sampler.setOnPublish([&] {
+        sampler.update();
+        const Snapshot& snapshot = sampler.latest();
+
+        reportAlertChange("cpu", last_alerts.cpu, snapshot.alerts.cpu);
+        reportAlertChange("ram", last_alerts.ram, snapshot.alerts.ram);
+        reportAlertChange("gpu", last_alerts.gpu, snapshot.alerts.gpu);
+        reportAlertChange("disk", last_alerts.disk, snapshot.alerts.disk);
+        reportAlertChange("cpu pressure", last_alerts.cpu_pressure, snapshot.alerts.cpu_pressure);
+        reportAlertChange("memory pressure", last_alerts.memory_pressure, snapshot.alerts.memory_pressure);
+        reportAlertChange("io pressure", last_alerts.io_pressure, snapshot.alerts.io_pressure);
+        last_alerts = snapshot.alerts;
+
+        if (options.json_output) {
+            formatJson(snapshot, line);
+            fwrite(line.data(), 1, line.size(), stdout);
+            fflush(stdout);
+        }
+    });
+    // A replay ends on its own: stop as if signalled
+    sampler.setOnFinished([] { kill(getpid(), SIGTERM); });
+    sampler.start();
+
+    int signal_number = 0;
+    sigwait(&signals, &signal_number);
+
+    sampler.stop();
+    return 0;
+}
+
+} // namespace resmon
@@ -0,0 +1,15 @@
+#ifndef RESMON_APP_DAEMON_H
+#define RESMON_APP_DAEMON_H
+
+#include "app/options.h"
+
+namespace resmon {
+
+// Sample without a window until SIGINT/SIGTERM (or the end of a replay),
+// logging alert changes to stderr and optionally each sample to stdout.
+// Returns the exit code.
+int runDaemon(const AppOptions& options);
+
+} // namespace resmon
+
+#endif // RESMON_APP_DAEMON_H
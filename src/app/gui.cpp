@@ -0,0 +1,956 @@
+#include "app/gui.h"
+
+#include <iostream>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <utility>
+
+#include "imgui.h"
+#include "imgui_impl_glfw.h"
+#include "imgui_impl_opengl3.h"
+
+#include <GLFW/glfw3.h>
+
+#include "core/metrics.h"
+#include "core/backend.h"
+#include "core/gpu_sample_history.h"
+#include "core/history.h"
+#include "core/rollup.h"
+#include "alerts/alert_manager.h"
+#include "app/sampler.h"
+
+static void glfw_error_callback(int error, const char* description) {
+    std::cerr << "GLFW Error " << error << ": " << description << "\n";
+}
+
+// Format bytes to human-readable string
+static std::string formatBytes(uint64_t bytes) {
+    const char* units[] = {"B", "KB", "MB", "GB", "TB"};
+    int unit = 0;
+    double size = static_cast<double>(bytes);
+    while (size >= 1024.0 && unit < 4) {
+        size /= 1024.0;
+        unit++;
+    }
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.1f %s", size, units[unit]);
+    return buf;
+}
+
+// Get color for progress bar based on alert severity
+static ImVec4 getSeverityColor(resmon::AlertSeverity severity) {
+    switch (severity) {
+        case resmon::AlertSeverity::Critical:
+            return ImVec4(0.9f, 0.2f, 0.2f, 1.0f);  // Red
+        case resmon::AlertSeverity::Warning:
+            return ImVec4(0.9f, 0.7f, 0.0f, 1.0f);  // Yellow/orange
+        case resmon::AlertSeverity::None:
+        default:
+            return ImVec4(0.26f, 0.59f, 0.98f, 1.0f);  // Default blue
+    }
+}
+
+// Memory budget for the in-memory history (~5 h at 1 Hz with 16 GPUs)
+static constexpr size_t HISTORY_BUDGET_BYTES = 4 * 1024 * 1024;
+static constexpr size_t HISTORY_MAX_GPUS = 16;
+
+// Samples shown in the history sparklines
+static constexpr size_t SPARKLINE_SAMPLES = 120;
+
+static float ringViewGetter(void* data, int idx) {
+    float value = (*static_cast<const resmon::RingView<float>*>(data))[static_cast<size_t>(idx)];
+    return std::isnan(value) ? 0.0f : value;
+}
+
+// Draw the recent history of a 0-100% series as a small line plot,
+// reading straight from the history store
+static void drawSparkline(const char* id, resmon::RingView<float> values) {
+    if (values.size() < 2) {
+        return;
+    }
+    ImGui::PlotLines(id, ringViewGetter, &values, static_cast<int>(values.size()),
+                     0, nullptr, 0.0f, 100.0f, ImVec2(-1, 28));
+}
+
+// GPU slots kept in the rollup tiers (a week of 1 min buckets per series)
+static constexpr size_t ROLLUP_MAX_GPUS = 8;
+
+// One rollup series of one tier, as a PlotLines data source
+struct TrendSource {
+    const resmon::RollupStore* store;
+    size_t tier;
+    resmon::HistorySeries series;
+};
+
+static float trendPeakGetter(void* data, int idx) {
+    const auto* source = static_cast<const TrendSource*>(data);
+    return source->store->bucket(source->tier, source->series, static_cast<size_t>(idx)).max;
+}
+
+// Plot the per-bucket peak of a series over a whole tier, with the peak and
+// mean over that span as the overlay
+static void drawTrend(const char* id, const char* label, const TrendSource& source) {
+    size_t count = source.store->size(source.tier);
+    if (count < 2) {
+        ImGui::TextDisabled("%s: collecting...", label);
+        return;
+    }
+
+    float peak = 0.0f;
+    double sum = 0.0;
+    uint64_t samples = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const resmon::RollupBucket& bucket = source.store->bucket(source.tier, source.series, i);
+        if (bucket.count == 0) {
+            continue;
+        }
+        if (bucket.max > peak) {
+            peak = bucket.max;
+        }
+        sum += bucket.sum;
+        samples += bucket.count;
+    }
+    double mean = samples > 0 ? sum / static_cast<double>(samples) : 0.0;
+
+    char overlay[64];
+    snprintf(overlay, sizeof(overlay), "%s peak %.0f%% avg %.0f%%", label, peak, mean);
+    ImGui::PlotLines(id, trendPeakGetter, const_cast<TrendSource*>(&source),
+                     static_cast<int>(count), 0, overlay, 0.0f, 100.0f, ImVec2(-1, 40));
+}
+
+// Driver samples kept per GPU series (~60 s of 50 Hz power samples)
+static constexpr size_t GPU_SAMPLE_CAPACITY = 3000;
+
+// Span of the sub-second activity plot, and its resolution
+static constexpr uint64_t ACTIVITY_WINDOW_US = 10 * 1000 * 1000;
+static constexpr int ACTIVITY_BINS = 200;
+
+// Plot the driver's utilization samples over the last ACTIVITY_WINDOW_US
+// at their own timestamps. Each sample holds until the next one, and a bin
+// shows the peak within it, so a burst shorter than the collection
+// interval still shows up.
+static void drawGpuActivity(const resmon::GpuSampleHistory& samples, size_t gpu) {
+    const resmon::GpuSampleSeries series = resmon::GpuSampleSeries::Utilization;
+    uint64_t newest = samples.newest(series, gpu);
+    if (newest == 0) {
+        return;
+    }
+    uint64_t from = newest > ACTIVITY_WINDOW_US ? newest - ACTIVITY_WINDOW_US : 0;
+    resmon::HistoryRange range = samples.range(series, gpu, from, newest);
+    resmon::RingView<uint64_t> times = samples.timestamps(series, gpu, range);
+    resmon::RingView<float> values = samples.values(series, gpu, range);
+
+    float bins[ACTIVITY_BINS];
+    float held = 0.0f;
+    float peak = 0.0f;
+    size_t next = 0;
+    for (int b = 0; b < ACTIVITY_BINS; ++b) {
+        uint64_t bin_end = from + ACTIVITY_WINDOW_US * static_cast<uint64_t>(b + 1) / ACTIVITY_BINS;
+        float bin_peak = held;
+        while (next < times.size() && times[next] <= bin_end) {
+            held = values[next];
+            bin_peak = std::max(bin_peak, held);
+            ++next;
+        }
+        bins[b] = bin_peak;
+        peak = std::max(peak, bin_peak);
+    }
+
+    char overlay[64];
+    snprintf(overlay, sizeof(overlay), "driver samples, 10 s: peak %.0f%%", peak);
+    ImGui::PlotLines("##gpu_activity", bins, ACTIVITY_BINS, 0, overlay, 0.0f, 100.0f, ImVec2(-1, 30));
+}
+
+// Busy rate of each engine on one line, e.g. "render 35%  video 4%"
+static void drawGpuEngines(const resmon::GpuMetrics& gpu) {
+    for (size_t e = 0; e < gpu.engines.size(); ++e) {
+        if (e > 0) {
+            ImGui::SameLine();
+        }
+        ImGui::TextDisabled("%s %.0f%%", gpu.engines[e].name.c_str(), gpu.engines[e].busy_percent);
+    }
+}
+
+// Heatmap cell for one core; smaller on hosts with hundreds of CPUs
+static constexpr float CORE_CELL_SIZE = 12.0f;
+static constexpr float CORE_CELL_SIZE_SMALL = 8.0f;
+static constexpr size_t CORE_SMALL_CELLS_FROM = 128;
+static constexpr float CORE_CELL_GAP = 2.0f;
+
+// Heatmap color of a 0-100% value: dark at idle, then blue, yellow, red.
+// Precomputed per whole percent so a cell costs a table lookup.
+static ImU32 heatColor(float percent) {
+    static const std::array<ImU32, 101> table = [] {
+        const ImVec4 stops[] = {
+            ImVec4(0.12f, 0.12f, 0.15f, 1.0f),
+            ImVec4(0.26f, 0.59f, 0.98f, 1.0f),
+            ImVec4(0.9f, 0.7f, 0.0f, 1.0f),
+            ImVec4(0.9f, 0.2f, 0.2f, 1.0f),
+        };
+        std::array<ImU32, 101> colors{};
+        for (int i = 0; i <= 100; ++i) {
+            float position = static_cast<float>(i) / 100.0f * 3.0f;
+            int stop = std::min(static_cast<int>(position), 2);
+            float t = position - static_cast<float>(stop);
+            const ImVec4& a = stops[stop];
+            const ImVec4& b = stops[stop + 1];
+            colors[static_cast<size_t>(i)] = IM_COL32(
+                static_cast<int>((a.x + (b.x - a.x) * t) * 255.0f),
+                static_cast<int>((a.y + (b.y - a.y) * t) * 255.0f),
+                static_cast<int>((a.z + (b.z - a.z) * t) * 255.0f), 255);
+        }
+        return colors;
+    }();
+    int index = static_cast<int>(percent + 0.5f);
+    return table[static_cast<size_t>(std::clamp(index, 0, 100))];
+}
+
+// Every core as one colored cell, laid out to the window width. The cells
+// go straight to the draw list in one pass (one rect each, no widgets),
+// so the cost stays flat from a handful of cores to several hundred; the
+// hovered cell's breakdown is shown as a tooltip.
+static void drawCoreHeatmap(const std::vector<resmon::CpuCoreMetrics>& cores) {
+    float cell = cores.size() >= CORE_SMALL_CELLS_FROM ? CORE_CELL_SIZE_SMALL : CORE_CELL_SIZE;
+    float pitch = cell + CORE_CELL_GAP;
+    float width = ImGui::GetContentRegionAvail().x;
+    size_t columns = std::max<size_t>(1, static_cast<size_t>((width + CORE_CELL_GAP) / pitch));
+    size_t rows = (cores.size() + columns - 1) / columns;
+
+    ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImGui::InvisibleButton("##core_heatmap",
+        ImVec2(std::max(width, 1.0f), static_cast<float>(rows) * pitch - CORE_CELL_GAP));
+    if (!ImGui::IsItemVisible()) {
+        return;
+    }
+
+    ImDrawList* draw = ImGui::GetWindowDrawList();
+    for (size_t i = 0; i < cores.size(); ++i) {
+        ImVec2 min(origin.x + static_cast<float>(i % columns) * pitch,
+                   origin.y + static_cast<float>(i / columns) * pitch);
+        draw->AddRectFilled(min, ImVec2(min.x + cell, min.y + cell), heatColor(cores[i].usage_percent));
+    }
+
+    if (ImGui::IsItemHovered()) {
+        ImVec2 mouse = ImGui::GetMousePos();
+        size_t column = static_cast<size_t>((mouse.x - origin.x) / pitch);
+        size_t index = static_cast<size_t>((mouse.y - origin.y) / pitch) * columns + column;
+        if (column < columns && index < cores.size()) {
+            const resmon::CpuCoreMetrics& core = cores[index];
+            ImGui::SetTooltip("cpu%u %.0f%%\nuser %.0f%%  sys %.0f%%  iowait %.0f%%\nirq %.0f%%  steal %.0f%%  guest %.0f%%",
+                static_cast<unsigned>(core.id), core.usage_percent, core.modes.user + core.modes.nice,
+                core.modes.system, core.modes.iowait, core.modes.irq + core.modes.softirq,
+                core.modes.steal, core.modes.guest);
+        }
+    }
+}
+
+// GPU rows shown before the list scrolls
+static constexpr int GPU_LIST_ROWS = 6;
+
+// One fixed-height row per GPU (name, usage bar, usage and temperature)
+// in a scrolling child. ImGuiListClipper skips the rows that are out of
+// view, and each visible row is a single invisible button plus draw-list
+// primitives. Clicking a row selects the GPU whose details are shown.
+static void drawGpuList(const std::vector<resmon::GpuMetrics>& gpus, resmon::AlertSeverity severity,
+                        size_t& selected) {
+    float row_height = ImGui::GetTextLineHeight() + 4.0f;
+    int visible_rows = std::min(static_cast<int>(gpus.size()), GPU_LIST_ROWS);
+    ImGui::BeginChild("##gpu_list", ImVec2(0, row_height * static_cast<float>(visible_rows)));
+    ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(0, 0));
+
+    ImDrawList* draw = ImGui::GetWindowDrawList();
+    ImU32 text_color = ImGui::GetColorU32(ImGuiCol_Text);
+    ImU32 track_color = ImGui::GetColorU32(ImGuiCol_FrameBg);
+    ImU32 bar_color = ImGui::GetColorU32(getSeverityColor(severity));
+    ImU32 selected_color = ImGui::GetColorU32(ImGuiCol_Header);
+    ImU32 hovered_color = ImGui::GetColorU32(ImGuiCol_HeaderHovered);
+    float value_width = ImGui::CalcTextSize("100% 100\xC2\xB0""C").x + 8.0f;
+
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(gpus.size()), row_height);
+    while (clipper.Step()) {
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+            const resmon::GpuMetrics& gpu = gpus[static_cast<size_t>(i)];
+            ImVec2 min = ImGui::GetCursorScreenPos();
+            float width = std::max(ImGui::GetContentRegionAvail().x, 1.0f);
+            ImVec2 max(min.x + width, min.y + row_height);
+
+            ImGui::PushID(i);
+            if (ImGui::InvisibleButton("##gpu_row", ImVec2(width, row_height))) {
+                selected = static_cast<size_t>(i);
+            }
+            ImGui::PopID();
+            if (static_cast<size_t>(i) == selected) {
+                draw->AddRectFilled(min, max, selected_color);
+            } else if (ImGui::IsItemHovered()) {
+                draw->AddRectFilled(min, max, hovered_color);
+            }
+
+            // name | bar | "54% 61°C"
+            float name_width = width * 0.45f;
+            draw->PushClipRect(min, ImVec2(min.x + name_width - 4.0f, max.y), true);
+            draw->AddText(ImVec2(min.x + 4.0f, min.y + 2.0f), text_color, gpu.name.c_str());
+            draw->PopClipRect();
+
+            ImVec2 bar_min(min.x + name_width, min.y + 4.0f);
+            ImVec2 bar_max(std::max(max.x - value_width, bar_min.x), max.y - 4.0f);
+            float fraction = std::clamp(gpu.usage_percent / 100.0f, 0.0f, 1.0f);
+            draw->AddRectFilled(bar_min, bar_max, track_color, 2.0f);
+            draw->AddRectFilled(bar_min, ImVec2(bar_min.x + (bar_max.x - bar_min.x) * fraction, bar_max.y),
+                                bar_color, 2.0f);
+
+            char value[32];
+            if (gpu.temperature_celsius >= 0) {
+                snprintf(value, sizeof(value), "%.0f%% %.0f\xC2\xB0""C", gpu.usage_percent, gpu.temperature_celsius);
+            } else {
+                snprintf(value, sizeof(value), "%.0f%%", gpu.usage_percent);
+            }
+            draw->AddText(ImVec2(bar_max.x + 6.0f, min.y + 2.0f), text_color, value);
+        }
+    }
+    clipper.End();
+
+    ImGui::PopStyleVar();
+    ImGui::EndChild();
+}
+
+// Where CPU time goes, plus the busiest core: one pinned core (or a
+// steal-starved vCPU) barely moves the aggregate on a large host
+static void drawCpuModes(const resmon::CpuMetrics& cpu) {
+    const resmon::CpuModes& modes = cpu.modes;
+    ImGui::TextDisabled("user %.0f%%  sys %.0f%%  iowait %.0f%%  irq %.0f%%  steal %.0f%%  guest %.0f%%",
+        modes.user + modes.nice, modes.system, modes.iowait, modes.irq + modes.softirq,
+        modes.steal, modes.guest);
+
+    const resmon::CpuCoreMetrics* busiest = &cpu.cores.front();
+    for (const auto& core : cpu.cores) {
+        if (core.usage_percent > busiest->usage_percent) {
+            busiest = &core;
+        }
+    }
+    ImGui::TextDisabled("busiest: cpu%u %.0f%%  ctxt/s %.0f  running %u  blocked %u",
+        static_cast<unsigned>(busiest->id), busiest->usage_percent, cpu.context_switches_per_second,
+        static_cast<unsigned>(cpu.procs_running), static_cast<unsigned>(cpu.procs_blocked));
+}
+
+// Width of the pressure bars, leaving room for the averages beside them
+static constexpr float PRESSURE_BAR_WIDTH = 180.0f;
+
+// Share of time tasks stalled on each resource ("some", last 10 s),
+// colored by its alert, with the 60 s average and the "full" share beside
+static void drawPressure(const resmon::PressureMetrics& pressure, const resmon::AlertManager::AlertState& alerts) {
+    struct Row {
+        const char* name;
+        const resmon::ResourcePressure& value;
+        resmon::AlertSeverity severity;
+    };
+    const Row rows[] = {
+        {"cpu", pressure.cpu, alerts.cpu_pressure},
+        {"memory", pressure.memory, alerts.memory_pressure},
+        {"io", pressure.io, alerts.io_pressure},
+    };
+    for (const Row& row : rows) {
+        char overlay[64];
+        snprintf(overlay, sizeof(overlay), "%s %.1f%%", row.name, row.value.some.avg10);
+        ImGui::PushStyleColor(ImGuiCol_PlotHistogram, getSeverityColor(row.severity));
+        ImGui::ProgressBar(row.value.some.avg10 / 100.0f, ImVec2(PRESSURE_BAR_WIDTH, 14), overlay);
+        ImGui::PopStyleColor();
+        ImGui::SameLine();
+        ImGui::TextDisabled("avg60 %.1f%%  full %.1f%%", row.value.some.avg60, row.value.full.avg10);
+    }
+}
+
+// Processes on a GPU, largest VRAM first (as the collector sorts them)
+static void drawGpuProcesses(const resmon::GpuMetrics& gpu) {
+    if (!ImGui::BeginTable("##gpu_processes", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp)) {
+        return;
+    }
+    ImGui::TableSetupColumn("pid");
+    ImGui::TableSetupColumn("process");
+    ImGui::TableSetupColumn("type");
+    ImGui::TableSetupColumn("VRAM");
+    ImGui::TableSetupColumn("GPU");
+    ImGui::TableHeadersRow();
+    for (const auto& process : gpu.processes) {
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::Text("%u", static_cast<unsigned>(process.pid));
+        ImGui::TableNextColumn();
+        if (process.name.empty()) {
+            ImGui::TextDisabled("?");
+        } else {
+            ImGui::TextUnformatted(process.name.c_str());
+        }
+        ImGui::TableNextColumn();
+        ImGui::TextUnformatted(resmon::gpuProcessType(process));
+        ImGui::TableNextColumn();
+        ImGui::TextUnformatted(formatBytes(process.vram_bytes).c_str());
+        ImGui::TableNextColumn();
+        if (process.usage_percent >= 0) {
+            ImGui::Text("%.0f%%", process.usage_percent);
+        } else {
+            ImGui::TextDisabled("-");
+        }
+    }
+    ImGui::EndTable();
+}
+
+// The top-N process table, in the order the collector ranked it
+static void drawProcesses(const std::vector<resmon::ProcessInfo>& processes) {
+    if (!ImGui::BeginTable("##processes", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp)) {
+        return;
+    }
+    ImGui::TableSetupColumn("pid");
+    ImGui::TableSetupColumn("process");
+    ImGui::TableSetupColumn("CPU");
+    ImGui::TableSetupColumn("RSS");
+    ImGui::TableHeadersRow();
+    for (const auto& process : processes) {
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::Text("%u", static_cast<unsigned>(process.pid));
+        ImGui::TableNextColumn();
+        ImGui::TextUnformatted(process.name.c_str());
+        ImGui::TableNextColumn();
+        ImGui::Text("%.1f%%", process.cpu_percent);
+        ImGui::TableNextColumn();
+        ImGui::TextUnformatted(formatBytes(process.rss_bytes).c_str());
+    }
+    ImGui::EndTable();
+}
+
+// Throughput, IOPS, latency and load per disk; util and queue depth as
+// iostat reports them (%util, aqu-sz)
+static void drawDisks(const std::vector<resmon::DiskMetrics>& disks) {
+    if (!ImGui::BeginTable("##disks", 7, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp)) {
+        return;
+    }
+    ImGui::TableSetupColumn("disk");
+    ImGui::TableSetupColumn("read");
+    ImGui::TableSetupColumn("write");
+    ImGui::TableSetupColumn("IOPS");
+    ImGui::TableSetupColumn("await");
+    ImGui::TableSetupColumn("util");
+    ImGui::TableSetupColumn("queue");
+    ImGui::TableHeadersRow();
+    for (const auto& disk : disks) {
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::TextUnformatted(disk.name.c_str());
+        ImGui::TableNextColumn();
+        ImGui::Text("%s/s", formatBytes(static_cast<uint64_t>(disk.read_bytes_per_second)).c_str());
+        ImGui::TableNextColumn();
+        ImGui::Text("%s/s", formatBytes(static_cast<uint64_t>(disk.write_bytes_per_second)).c_str());
+        ImGui::TableNextColumn();
+        ImGui::Text("%.0f", disk.read_ops_per_second + disk.write_ops_per_second);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.1f ms", disk.await_ms);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.0f%%", disk.utilization_percent);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.1f", disk.queue_depth);
+    }
+    ImGui::EndTable();
+}
+
+// Columns of the cgroup table, also used as sort keys
+enum CgroupColumn {
+    CGROUP_COLUMN_PATH,
+    CGROUP_COLUMN_CPU,
+    CGROUP_COLUMN_THROTTLED,
+    CGROUP_COLUMN_MEMORY,
+    CGROUP_COLUMN_IO,
+    CGROUP_COLUMN_PIDS,
+    CGROUP_COLUMN_STALL,
+    CGROUP_COLUMN_COUNT
+};
+
+// The resource a group waits on most ("some" avg10)
+static float worstStall(const resmon::PressureMetrics& pressure) {
+    return std::max({pressure.cpu.some.avg10, pressure.memory.some.avg10, pressure.io.some.avg10});
+}
+
+// Rows shown before the cgroup table scrolls
+static constexpr float CGROUP_TABLE_ROWS = 12.0f;
+
+// Order rows by the table's sort spec (one column at a time)
+static void sortCgroups(const std::vector<resmon::CgroupMetrics>& groups, int column, bool ascending,
+                        std::vector<size_t>& order) {
+    order.resize(groups.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    auto key = [&groups, column](size_t i) -> double {
+        const resmon::CgroupMetrics& group = groups[i];
+        switch (column) {
+            case CGROUP_COLUMN_CPU:       return group.cpu_percent;
+            case CGROUP_COLUMN_THROTTLED: return group.throttled_percent;
+            case CGROUP_COLUMN_MEMORY:    return static_cast<double>(group.memory_bytes);
+            case CGROUP_COLUMN_IO:
+                return static_cast<double>(group.io_read_bytes_per_second) + group.io_write_bytes_per_second;
+            case CGROUP_COLUMN_PIDS:      return static_cast<double>(group.pids);
+            case CGROUP_COLUMN_STALL:     return worstStall(group.pressure);
+            default:                      return 0.0;
+        }
+    };
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        if (column == CGROUP_COLUMN_PATH) {
+            return ascending ? groups[a].path < groups[b].path : groups[b].path < groups[a].path;
+        }
+        return ascending ? key(a) < key(b) : key(b) < key(a);
+    });
+}
+
+// Every cgroup in a scrolling, sortable table. Rows are re-sorted only
+// when a new sample arrives or the sort column changes, and only the
+// visible ones are emitted (ImGuiListClipper), so hundreds of containers
+// cost what a screenful does.
+static void drawCgroups(const std::vector<resmon::CgroupMetrics>& groups, bool new_sample,
+                        std::vector<size_t>& order) {
+    ImGuiTableFlags flags = ImGuiTableFlags_Sortable | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY |
+                            ImGuiTableFlags_Resizable | ImGuiTableFlags_SizingStretchProp;
+    float height = ImGui::GetTextLineHeightWithSpacing() * (CGROUP_TABLE_ROWS + 1.0f);
+    if (!ImGui::BeginTable("##cgroups", CGROUP_COLUMN_COUNT, flags, ImVec2(0.0f, height))) {
+        return;
+    }
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("cgroup", ImGuiTableColumnFlags_WidthStretch, 3.0f, CGROUP_COLUMN_PATH);
+    ImGui::TableSetupColumn("CPU", ImGuiTableColumnFlags_DefaultSort | ImGuiTableColumnFlags_PreferSortDescending,
+                            1.0f, CGROUP_COLUMN_CPU);
+    ImGui::TableSetupColumn("thr", ImGuiTableColumnFlags_PreferSortDescending, 1.0f, CGROUP_COLUMN_THROTTLED);
+    ImGui::TableSetupColumn("memory", ImGuiTableColumnFlags_PreferSortDescending, 1.5f, CGROUP_COLUMN_MEMORY);
+    ImGui::TableSetupColumn("I/O", ImGuiTableColumnFlags_PreferSortDescending, 1.5f, CGROUP_COLUMN_IO);
+    ImGui::TableSetupColumn("pids", ImGuiTableColumnFlags_PreferSortDescending, 1.0f, CGROUP_COLUMN_PIDS);
+    ImGui::TableSetupColumn("stall", ImGuiTableColumnFlags_PreferSortDescending, 1.0f, CGROUP_COLUMN_STALL);
+    ImGui::TableHeadersRow();
+
+    ImGuiTableSortSpecs* specs = ImGui::TableGetSortSpecs();
+    if (specs && (specs->SpecsDirty || new_sample || order.size() != groups.size())) {
+        int column = specs->SpecsCount > 0 ? static_cast<int>(specs->Specs[0].ColumnUserID) : CGROUP_COLUMN_CPU;
+        bool ascending = specs->SpecsCount > 0 && specs->Specs[0].SortDirection == ImGuiSortDirection_Ascending;
+        sortCgroups(groups, column, ascending, order);
+        specs->SpecsDirty = false;
+    }
+
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(order.size()));
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+            const resmon::CgroupMetrics& group = groups[order[static_cast<size_t>(row)]];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            if (group.populated) {
+                ImGui::TextUnformatted(group.path.c_str());
+            } else {
+                ImGui::TextDisabled("%s", group.path.c_str());
+            }
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f%%", group.cpu_percent);
+            ImGui::TableNextColumn();
+            if (group.throttled_percent > 0.0f) {
+                ImGui::Text("%.0f%%", group.throttled_percent);
+            } else {
+                ImGui::TextDisabled("-");
+            }
+            ImGui::TableNextColumn();
+            if (group.memory_max_bytes > 0) {
+                ImGui::Text("%s / %s", formatBytes(group.memory_bytes).c_str(),
+                            formatBytes(group.memory_max_bytes).c_str());
+            } else {
+                ImGui::TextUnformatted(formatBytes(group.memory_bytes).c_str());
+            }
+            ImGui::TableNextColumn();
+            ImGui::Text("%s/s", formatBytes(static_cast<uint64_t>(
+                group.io_read_bytes_per_second + group.io_write_bytes_per_second)).c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", static_cast<unsigned long long>(group.pids));
+            ImGui::TableNextColumn();
+            if (group.pressure.available) {
+                ImGui::Text("%.1f%%", worstStall(group.pressure));
+            } else {
+                ImGui::TextDisabled("-");
+            }
+        }
+    }
+    clipper.End();
+    ImGui::EndTable();
+}
+
+// Frames drawn after each wakeup in event-driven mode; ImGui needs an extra
+// frame after input for hover/active state to settle
+static constexpr int SETTLE_FRAMES = 2;
+
+// Upper bound on an idle wait; the sampler normally wakes us sooner
+static constexpr double IDLE_WAIT_SECONDS = 2.0;
+
+namespace resmon {
+
+int runGui(const AppOptions& options) {
+    // Open the backend and recording first so errors show before a window
+    std::unique_ptr<IMetricsBackend> backend = createBackend(options);
+    if (!backend) {
+        return 1;
+    }
+    MetricArchiveWriter archive;
+    if (!options.record_path.empty() && !archive.open(options.record_path, options.record_size_bytes)) {
+        std::cerr << "resmon: " << archive.error() << "\n";
+        return 1;
+    }
+
+    // Setup GLFW
+    glfwSetErrorCallback(glfw_error_callback);
+    if (!glfwInit()) {
+        std::cerr << "Failed to initialize GLFW\n";
+        return 1;
+    }
+
+    // OpenGL 3.3 Core
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // Create window
+    GLFWwindow* window = glfwCreateWindow(350, 400, "resmon", nullptr, nullptr);
+    if (!window) {
+        std::cerr << "Failed to create GLFW window\n";
+        glfwTerminate();
+        return 1;
+    }
+    glfwSetWindowSizeLimits(window, 300, 240, GLFW_DONT_CARE, GLFW_DONT_CARE);
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(1); // VSync
+
+    // Setup Dear ImGui
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
+
+    // Setup style - polished dark theme
+    ImGui::StyleColorsDark();
+    ImGuiStyle& style = ImGui::GetStyle();
+    style.WindowRounding = 0.0f;
+    style.FrameRounding = 3.0f;
+    style.WindowBorderSize = 0.0f;
+    style.FrameBorderSize = 0.0f;
+    style.ItemSpacing = ImVec2(8, 8);
+    style.WindowPadding = ImVec2(12, 12);
+    style.FramePadding = ImVec2(8, 4);
+
+    // Professional dark color scheme with blue accents
+    ImVec4* colors = style.Colors;
+    colors[ImGuiCol_WindowBg] = ImVec4(0.06f, 0.06f, 0.08f, 1.0f);
+    colors[ImGuiCol_FrameBg] = ImVec4(0.12f, 0.12f, 0.15f, 1.0f);
+    colors[ImGuiCol_FrameBgHovered] = ImVec4(0.18f, 0.18f, 0.22f, 1.0f);
+    colors[ImGuiCol_FrameBgActive] = ImVec4(0.20f, 0.20f, 0.25f, 1.0f);
+    colors[ImGuiCol_PlotHistogram] = ImVec4(0.26f, 0.59f, 0.98f, 1.0f);
+    colors[ImGuiCol_Text] = ImVec4(0.9f, 0.9f, 0.9f, 1.0f);
+    colors[ImGuiCol_TextDisabled] = ImVec4(0.5f, 0.5f, 0.5f, 1.0f);
+    colors[ImGuiCol_Separator] = ImVec4(0.2f, 0.2f, 0.25f, 1.0f);
+    colors[ImGuiCol_Header] = ImVec4(0.15f, 0.15f, 0.18f, 1.0f);
+    colors[ImGuiCol_HeaderHovered] = ImVec4(0.20f, 0.20f, 0.25f, 1.0f);
+
+    // Setup backends
+    ImGui_ImplGlfw_InitForOpenGL(window, true);
+    ImGui_ImplOpenGL3_Init("#version 330");
+
+    // Sample on a dedicated thread so slow collectors never stall a frame
+    resmon::Sampler sampler(std::move(backend), options.interval);
+    if (archive.isOpen()) {
+        sampler.setArchive(&archive);
+    }
+    // Wake the (possibly idle) main loop whenever a new snapshot is ready
+    sampler.setOnPublish([] { glfwPostEmptyEvent(); });
+    sampler.start();
+
+    // History of every sample, allocated once up front
+    resmon::HistoryStore history(
+        resmon::HistoryStore::capacityForBudget(HISTORY_BUDGET_BYTES, HISTORY_MAX_GPUS),
+        HISTORY_MAX_GPUS);
+
+    // Cascading 1s/10s/1m/1h min/max/mean rollups for long-term trends
+    resmon::RollupStore rollups(resmon::RollupStore::defaultTiers(), ROLLUP_MAX_GPUS);
+    int trend_tier = 1;
+
+    // Process table ranking: 0 = CPU, 1 = resident memory
+    int process_order = 0;
+
+    // GPU whose details are shown when there are several
+    size_t selected_gpu = 0;
+
+    // Row order of the cgroup table under its current sort
+    std::vector<size_t> cgroup_order;
+
+    // Sub-second utilization and power samples from the GPU drivers
+    resmon::GpuSampleHistory gpu_samples(GPU_SAMPLE_CAPACITY, HISTORY_MAX_GPUS);
+
+    // Main loop
+    int frames_pending = SETTLE_FRAMES;
+    while (!glfwWindowShouldClose(window)) {
+        if (options.continuous_rendering || frames_pending > 0) {
+            glfwPollEvents();
+        } else {
+            // Sleep until input arrives or the sampler publishes
+            glfwWaitEventsTimeout(IDLE_WAIT_SECONDS);
+            frames_pending = SETTLE_FRAMES;
+        }
+
+        // Pick up the newest snapshot, if any; no lock or copy involved
+        bool new_sample = sampler.update();
+        if (new_sample) {
+            history.append(sampler.latest().metrics);
+            rollups.append(sampler.latest().metrics);
+            gpu_samples.append(sampler.latest().metrics);
+        }
+        const resmon::HistoryRange recent = history.latest(SPARKLINE_SAMPLES);
+
+        // Nothing to draw while minimized or hidden. GLFW has no occlusion
+        // query, so a covered but visible window still renders.
+        if (glfwGetWindowAttrib(window, GLFW_ICONIFIED) ||
+            !glfwGetWindowAttrib(window, GLFW_VISIBLE)) {
+            frames_pending = 0;
+            if (options.continuous_rendering) {
+                glfwWaitEvents();
+            }
+            continue;
+        }
+
+        const resmon::SystemMetrics& metrics = sampler.latest().metrics;
+        const resmon::AlertManager::AlertState& alertState = sampler.latest().alerts;
+
+        // Start ImGui frame
+        ImGui_ImplOpenGL3_NewFrame();
+        ImGui_ImplGlfw_NewFrame();
+        ImGui::NewFrame();
+
+        // Main window (fills viewport)
+        ImGui::SetNextWindowPos(ImVec2(0, 0));
+        ImGui::SetNextWindowSize(io.DisplaySize);
+        ImGui::Begin("resmon", nullptr,
+            ImGuiWindowFlags_NoTitleBar |
+            ImGuiWindowFlags_NoResize |
+            ImGuiWindowFlags_NoMove |
+            ImGuiWindowFlags_NoCollapse);
+
+        // Header
+        ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.6f, 0.6f, 0.65f, 1.0f));
+        ImGui::Text("RESMON");
+        ImGui::PopStyleColor();
+        ImGui::SameLine();
+        ImGui::TextDisabled("v0.1.0");
+        ImGui::Spacing();
+        ImGui::Separator();
+        ImGui::Spacing();
+
+        // CPU Section
+        if (metrics.cpu.core_count > 0) {
+            ImGui::Text("CPU (%d cores)", metrics.cpu.core_count);
+        } else {
+            ImGui::Text("CPU");
+        }
+        char cpu_overlay[64];
+        snprintf(cpu_overlay, sizeof(cpu_overlay), "%.1f%%", metrics.cpu.usage_percent);
+        ImGui::PushStyleColor(ImGuiCol_PlotHistogram, getSeverityColor(alertState.cpu));
+        ImGui::ProgressBar(metrics.cpu.usage_percent / 100.0f, ImVec2(-1, 18), cpu_overlay);
+        ImGui::PopStyleColor();
+        if (metrics.cpu.temperature_celsius >= 0) {
+            ImGui::SameLine();
+            ImGui::Text("%.0f\xC2\xB0""C", metrics.cpu.temperature_celsius);
+        }
+        drawSparkline("##cpu_history", history.series(resmon::HistorySeries::CpuUsage, recent));
+        if (!metrics.cpu.cores.empty()) {
+            drawCpuModes(metrics.cpu);
+            if (metrics.cpu.cores.size() > 1) {
+                drawCoreHeatmap(metrics.cpu.cores);
+            }
+        }
+
+        ImGui::Spacing();
+        ImGui::Spacing();
+
+        // RAM Section
+        ImGui::Text("Memory");
+        char ram_overlay[64];
+        snprintf(ram_overlay, sizeof(ram_overlay), "%.1f%% (%s / %s)",
+            metrics.ram.usage_percent,
+            formatBytes(metrics.ram.used_bytes).c_str(),
+            formatBytes(metrics.ram.total_bytes).c_str());
+        ImGui::PushStyleColor(ImGuiCol_PlotHistogram, getSeverityColor(alertState.ram));
+        ImGui::ProgressBar(metrics.ram.usage_percent / 100.0f, ImVec2(-1, 18), ram_overlay);
+        ImGui::PopStyleColor();
+        drawSparkline("##ram_history", history.series(resmon::HistorySeries::RamUsage, recent));
+
+        // Pressure Section: time lost waiting on CPU, memory and I/O (PSI)
+        if (metrics.pressure.available) {
+            ImGui::Spacing();
+            ImGui::Text("Pressure stalls");
+            drawPressure(metrics.pressure, alertState);
+        }
+
+        ImGui::Spacing();
+        ImGui::Spacing();
+
+        // GPU Section: with several GPUs, a compact list to pick from and
+        // the details of the selected one
+        if (metrics.gpus.empty()) {
+            ImGui::Text("GPU");
+            ImGui::TextDisabled("No GPU detected");
+        } else {
+            if (metrics.gpus.size() > 1) {
+                ImGui::Text("GPUs (%zu)", metrics.gpus.size());
+                drawGpuList(metrics.gpus, alertState.gpu, selected_gpu);
+                ImGui::Spacing();
+            }
+            selected_gpu = std::min(selected_gpu, metrics.gpus.size() - 1);
+            const size_t i = selected_gpu;
+            const auto& gpu = metrics.gpus[i];
+            ImGui::Text("GPU: %s", gpu.name.c_str());
+            char gpu_overlay[64];
+            snprintf(gpu_overlay, sizeof(gpu_overlay), "%.1f%%", gpu.usage_percent);
+            ImGui::PushStyleColor(ImGuiCol_PlotHistogram, getSeverityColor(alertState.gpu));
+            ImGui::ProgressBar(gpu.usage_percent / 100.0f, ImVec2(-1, 18), gpu_overlay);
+            ImGui::PopStyleColor();
+            if (gpu.temperature_celsius >= 0) {
+                ImGui::SameLine();
+                ImGui::Text("%.0f\xC2\xB0""C", gpu.temperature_celsius);
+            }
+            ImGui::PushID(static_cast<int>(i));
+            drawSparkline("##gpu_history", history.series(resmon::HistorySeries::GpuUsage, recent, i));
+            drawGpuActivity(gpu_samples, i);
+            if (gpu.vram_total_bytes > 0) {
+                ImGui::Text("VRAM: %s / %s",
+                    formatBytes(gpu.vram_used_bytes).c_str(),
+                    formatBytes(gpu.vram_total_bytes).c_str());
+            }
+            if (gpu.power_watts >= 0) {
+                ImGui::Text("Power: %.0f W", gpu.power_watts);
+            }
+            if (!gpu.engines.empty()) {
+                drawGpuEngines(gpu);
+            }
+            if (!gpu.processes.empty()) {
+                drawGpuProcesses(gpu);
+            }
+            ImGui::PopID();
+        }
+
+        // Disks Section: whole disks only, in kernel order
+        if (!metrics.disks.empty()) {
+            ImGui::Spacing();
+            ImGui::Spacing();
+            if (alertState.disk != resmon::AlertSeverity::None) {
+                ImGui::TextColored(getSeverityColor(alertState.disk), "Disks");
+            } else {
+                ImGui::Text("Disks");
+            }
+            drawDisks(metrics.disks);
+        }
+
+        // Trends Section (peaks per bucket of the selected rollup tier)
+        ImGui::Spacing();
+        if (ImGui::CollapsingHeader("Trends")) {
+            static const char* const tier_labels[] = {"1s", "10s", "1m", "1h"};
+            for (int tier = 0; tier < static_cast<int>(rollups.tierCount()) && tier < 4; ++tier) {
+                if (tier > 0) {
+                    ImGui::SameLine();
+                }
+                ImGui::RadioButton(tier_labels[tier], &trend_tier, tier);
+            }
+            TrendSource cpu_trend{&rollups, static_cast<size_t>(trend_tier), resmon::HistorySeries::CpuUsage};
+            TrendSource ram_trend{&rollups, static_cast<size_t>(trend_tier), resmon::HistorySeries::RamUsage};
+            drawTrend("##cpu_trend", "CPU", cpu_trend);
+            drawTrend("##ram_trend", "RAM", ram_trend);
+        }
+
+        // Processes Section (top N by CPU or by RSS)
+        if (metrics.processes.count > 0) {
+            ImGui::Spacing();
+            if (ImGui::CollapsingHeader("Processes")) {
+                ImGui::RadioButton("CPU", &process_order, 0);
+                ImGui::SameLine();
+                ImGui::RadioButton("Memory", &process_order, 1);
+                ImGui::SameLine();
+                ImGui::TextDisabled("%u processes", static_cast<unsigned>(metrics.processes.count));
+                drawProcesses(process_order == 0 ? metrics.processes.top_cpu : metrics.processes.top_rss);
+            }
+        }
+
+        // Control groups Section (cgroup v2: services, containers, pods)
+        if (!metrics.cgroups.empty()) {
+            ImGui::Spacing();
+            if (ImGui::CollapsingHeader("Control groups")) {
+                drawCgroups(metrics.cgroups, new_sample, cgroup_order);
+            }
+        }
+
+        // Overhead Section: what resmon itself costs (if the backend measures it)
+        const resmon::OverheadMetrics& overhead = metrics.overhead;
+        if (overhead.rss_bytes > 0) {
+            ImGui::Spacing();
+            if (ImGui::CollapsingHeader("resmon overhead")) {
+                ImGui::Text("CPU: %.2f%%  RSS: %s  collect: %.0f us",
+                    overhead.cpu_percent, formatBytes(overhead.rss_bytes).c_str(), overhead.collect_us);
+                ImGui::Text("collect p50/p99/max: %.0f / %.0f / %.0f us",
+                    overhead.collect_p50_us, overhead.collect_p99_us, overhead.collect_max_us);
+                if (!overhead.collectors.empty() &&
+                    ImGui::BeginTable("##collector_timings", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp)) {
+                    ImGui::TableSetupColumn("collector");
+                    ImGui::TableSetupColumn("p50 us");
+                    ImGui::TableSetupColumn("p99 us");
+                    ImGui::TableSetupColumn("max us");
+                    ImGui::TableSetupColumn("calls");
+                    ImGui::TableHeadersRow();
+                    for (const auto& timing : overhead.collectors) {
+                        ImGui::TableNextRow();
+                        ImGui::TableNextColumn();
+                        ImGui::TextUnformatted(timing.name);
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%.0f", timing.p50_us);
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%.0f", timing.p99_us);
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%.0f", timing.max_us);
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%llu", static_cast<unsigned long long>(timing.calls));
+                    }
+                    ImGui::EndTable();
+                }
+            }
+        }
+
+        ImGui::End();
+
+        // Render
+        ImGui::Render();
+        int display_w, display_h;
+        glfwGetFramebufferSize(window, &display_w, &display_h);
+        glViewport(0, 0, display_w, display_h);
+        glClearColor(0.06f, 0.06f, 0.08f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+
+        glfwSwapBuffers(window);
+
+        if (frames_pending > 0) {
+            --frames_pending;
+        }
+    }
+
+    // Cleanup
+    sampler.stop();
+    ImGui_ImplOpenGL3_Shutdown();
+    ImGui_ImplGlfw_Shutdown();
+    ImGui::DestroyContext();
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    return 0;
+}
+
+} // namespace resmon
@@ -0,0 +1,13 @@
+#ifndef RESMON_APP_GUI_H
+#define RESMON_APP_GUI_H
+
+#include "app/options.h"
+
+namespace resmon {
+
+// Open the monitor window and run until it is closed. Returns the exit code.
+int runGui(const AppOptions& options);
+
+} // namespace resmon
+
+#endif // RESMON_APP_GUI_H
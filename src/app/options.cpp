@@ -0,0 +1,141 @@
+#include "app/options.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "backend/replay/replay_backend.h"
+
+namespace resmon {
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --daemon          Run headless: sample and report alerts, no window\n"
+              << "  --json            Daemon: print each sample as a JSON line on stdout\n"
+              << "  --interval <ms>   Time between samples (default 1000)\n"
+              << "  --high-rate <hz>  Capture CPU/RAM at 10-1000 Hz as CSV, then exit (Linux)\n"
+              << "  --duration <ms>   Length of a --high-rate capture (default 10000)\n"
+              << "  --record <file>   Record every sample to a compressed archive file\n"
+              << "  --record-size <MiB>  Size of a new --record archive (default 64)\n"
+              << "  --replay <file>   Play back a recorded archive instead of sampling\n"
+              << "  --speed <x>       Replay speed multiplier, 0 = as fast as possible (default 1)\n"
+              << "  --fs-root <dir>   Read /proc and /sys below dir instead of / (Linux)\n"
+              << "  --nvml <library>  Load this NVML library instead of libnvidia-ml.so.1\n"
+              << "  --parallel        Run the collectors concurrently\n"
+#ifndef RESMON_HEADLESS
+              << "  --continuous      Redraw every vsync instead of only on new data or input\n"
+#endif
+              << "  --help            Show this message\n";
+}
+
+// Parse a positive integer argument; returns false if missing or invalid
+static bool parsePositive(int argc, char** argv, int& i, long& value) {
+    if (i + 1 >= argc) {
+        std::cerr << "Missing value for " << argv[i] << "\n";
+        return false;
+    }
+    char* end = nullptr;
+    value = std::strtol(argv[i + 1], &end, 10);
+    if (end == argv[i + 1] || *end != '\0' || value <= 0) {
+        std::cerr << "Invalid value for " << argv[i] << ": " << argv[i + 1] << "\n";
+        return false;
+    }
+    ++i;
+    return true;
+}
+
+bool parseOptions(int argc, char** argv, AppOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (std::strcmp(arg, "--daemon") == 0) {
+            options.daemon = true;
+        } else if (std::strcmp(arg, "--json") == 0) {
+            options.json_output = true;
+        } else if (std::strcmp(arg, "--interval") == 0) {
+            long ms = 0;
+            if (!parsePositive(argc, argv, i, ms)) {
+                return false;
+            }
+            options.interval = std::chrono::milliseconds(ms);
+        } else if (std::strcmp(arg, "--high-rate") == 0) {
+            long hz = 0;
+            if (!parsePositive(argc, argv, i, hz)) {
+                return false;
+            }
+            if (hz < 10 || hz > 1000) {
+                std::cerr << "--high-rate must be between 10 and 1000 Hz\n";
+                return false;
+            }
+            options.high_rate_hz = static_cast<double>(hz);
+        } else if (std::strcmp(arg, "--duration") == 0) {
+            long ms = 0;
+            if (!parsePositive(argc, argv, i, ms)) {
+                return false;
+            }
+            options.capture_duration = std::chrono::milliseconds(ms);
+        } else if (std::strcmp(arg, "--record") == 0) {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << arg << "\n";
+                return false;
+            }
+            options.record_path = argv[++i];
+        } else if (std::strcmp(arg, "--record-size") == 0) {
+            long mib = 0;
+            if (!parsePositive(argc, argv, i, mib)) {
+                return false;
+            }
+            options.record_size_bytes = static_cast<uint64_t>(mib) * 1024 * 1024;
+        } else if (std::strcmp(arg, "--replay") == 0) {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << arg << "\n";
+                return false;
+            }
+            options.replay_path = argv[++i];
+        } else if (std::strcmp(arg, "--speed") == 0) {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << arg << "\n";
+                return false;
+            }
+            char* end = nullptr;
+            double speed = std::strtod(argv[i + 1], &end);
+            if (end == argv[i + 1] || *end != '\0' || !(speed >= 0.0)) {
+                std::cerr << "Invalid value for " << arg << ": " << argv[i + 1] << "\n";
+                return false;
+            }
+            options.replay_speed = speed;
+            ++i;
+        } else if (std::strcmp(arg, "--fs-root") == 0) {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << arg << "\n";
+                return false;
+            }
+            options.backend.fs_root = argv[++i];
+        } else if (std::strcmp(arg, "--nvml") == 0) {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << arg << "\n";
+                return false;
+            }
+            options.backend.nvml_library = argv[++i];
+        } else if (std::strcmp(arg, "--parallel") == 0) {
+            options.backend.parallel_collection = true;
+        } else if (std::strcmp(arg, "--continuous") == 0) {
+            options.continuous_rendering = true;
+        } else if (std::strcmp(arg, "--help") == 0) {
+            options.show_help = true;
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+std::unique_ptr<IMetricsBackend> createBackend(const AppOptions& options) {
+    if (!options.replay_path.empty()) {
+        return createReplayBackend(options.replay_path, options.replay_speed);
+    }
+    return createPlatformBackend(options.backend);
+}
+
+} // namespace resmon
@@ -0,0 +1,58 @@
+#ifndef RESMON_APP_OPTIONS_H
+#define RESMON_APP_OPTIONS_H
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "core/backend.h"
+
+namespace resmon {
+
+// Command line configuration shared by the GUI and daemon front ends
+struct AppOptions {
+    BackendOptions backend;
+
+    // Time between samples
+    std::chrono::milliseconds interval{1000};
+
+    // Run as a headless sampling daemon instead of opening a window
+    bool daemon = false;
+
+    // Daemon: print every sample as a JSON line on stdout
+    bool json_output = false;
+
+    // High-rate capture: sample CPU/RAM at this rate (0 = off) for
+    // capture_duration, then exit
+    double high_rate_hz = 0.0;
+    std::chrono::milliseconds capture_duration{10000};
+
+    // Record every sample to this archive file (empty = off). A new file
+    // is created at record_size_bytes.
+    std::string record_path;
+    uint64_t record_size_bytes = 64ull * 1024 * 1024;
+
+    // Play back this archive instead of sampling the machine (empty = off),
+    // at replay_speed times the recorded rate; 0 = as fast as possible
+    std::string replay_path;
+    double replay_speed = 1.0;
+
+    // GUI: redraw every vsync instead of only on new samples or input
+    bool continuous_rendering = false;
+
+    bool show_help = false;
+};
+
+// Parse argv into options. Prints a message and returns false on error.
+bool parseOptions(int argc, char** argv, AppOptions& options);
+
+void printUsage(const char* program);
+
+// The backend the options select: the live collectors or a replay.
+// Prints a message and returns null on error.
+std::unique_ptr<IMetricsBackend> createBackend(const AppOptions& options);
+
+} // namespace resmon
+
+#endif // RESMON_APP_OPTIONS_H
@@ -0,0 +1,112 @@
+#include "app/sampler.h"
+
+namespace resmon {
+
+Sampler::Sampler(std::unique_ptr<IMetricsBackend> backend, std::chrono::milliseconds interval)
+    : backend_(std::move(backend))
+    , alert_manager_()
+    , interval_(interval)
+    , archive_(nullptr)
+    , sequence_(0)
+    , stopping_(false)
+    , sample_requested_(false)
+{
+}
+
+Sampler::~Sampler() {
+    stop();
+    // The backend may call requestSample() from its own threads until it
+    // is gone, so it must not outlive the mutex and condition variable
+    backend_.reset();
+}
+
+void Sampler::setOnPublish(std::function<void()> callback) {
+    on_publish_ = std::move(callback);
+}
+
+void Sampler::setOnFinished(std::function<void()> callback) {
+    on_finished_ = std::move(callback);
+}
+
+void Sampler::setArchive(MetricArchiveWriter* archive) {
+    archive_ = archive;
+}
+
+void Sampler::start() {
+    if (thread_.joinable()) {
+        return;
+    }
+    stopping_ = false;
+    backend_->watchThresholds(alert_manager_.config(), [this] { requestSample(); });
+    thread_ = std::thread(&Sampler::run, this);
+}
+
+void Sampler::requestSample() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sample_requested_ = true;
+    }
+    wake_.notify_all();
+}
+
+void Sampler::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void Sampler::run() {
+    auto next_sample = std::chrono::steady_clock::now();
+    bool scheduled = true;
+
+    for (;;) {
+        // Fill the private back slot; the consumer never touches it
+        Snapshot& snapshot = snapshots_.writeBuffer();
+        snapshot.metrics = backend_->collect();
+        snapshot.alerts = alert_manager_.check(snapshot.metrics);
+        snapshot.sequence = ++sequence_;
+        if (archive_) {
+            archive_->append(snapshot.metrics);
+        }
+        snapshots_.publish();
+
+        if (on_publish_) {
+            on_publish_();
+        }
+
+        if (backend_->exhausted()) {
+            if (on_finished_) {
+                on_finished_();
+            }
+            return;
+        }
+
+        // Fixed-rate schedule; if collection overran, start the next one now.
+        // Replays pace themselves instead. A requested sample leaves the
+        // schedule as it was.
+        if (scheduled && !backend_->nextSampleDue(next_sample)) {
+            next_sample += interval_;
+            auto now = std::chrono::steady_clock::now();
+            if (next_sample < now) {
+                next_sample = now;
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        wake_.wait_until(lock, next_sample, [this] { return stopping_ || sample_requested_; });
+        if (stopping_) {
+            return;
+        }
+        // Woken early by a request: the scheduled sample is still due later
+        scheduled = !sample_requested_ || std::chrono::steady_clock::now() >= next_sample;
+        sample_requested_ = false;
+    }
+}
+
+} // namespace resmon
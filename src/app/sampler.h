@@ -0,0 +1,83 @@
+#ifndef RESMON_APP_SAMPLER_H
+#define RESMON_APP_SAMPLER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "core/backend.h"
+#include "core/metrics.h"
+#include "core/triple_buffer.h"
+#include "alerts/alert_manager.h"
+#include "archive/metric_archive.h"
+
+namespace resmon {
+
+// One published sample: metrics plus the alert state computed from them
+struct Snapshot {
+    SystemMetrics metrics;
+    AlertManager::AlertState alerts;
+    uint64_t sequence = 0;  // 0 until the first sample is published
+};
+
+// Runs backend collection and alert checks on a dedicated thread and hands
+// the newest Snapshot to a single consumer (the render loop) through a
+// lock-free triple buffer. A backend that watches alert thresholds itself
+// can request an extra sample between intervals.
+class Sampler {
+public:
+    Sampler(std::unique_ptr<IMetricsBackend> backend, std::chrono::milliseconds interval);
+    ~Sampler();
+
+    // Non-copyable
+    Sampler(const Sampler&) = delete;
+    Sampler& operator=(const Sampler&) = delete;
+
+    // Called on the sampler thread after each publish
+    void setOnPublish(std::function<void()> callback);
+
+    // Called on the sampler thread after the last sample of a finite
+    // backend (a replay); sampling stops there
+    void setOnFinished(std::function<void()> callback);
+
+    // Record every sample to an open archive; it must outlive the sampler
+    void setArchive(MetricArchiveWriter* archive);
+
+    void start();
+    void stop();
+
+    // Consumer side: pick up the newest snapshot if there is one.
+    // Returns true if latest() changed. Must be called from one thread only.
+    bool update() { return snapshots_.update(); }
+    const Snapshot& latest() const { return snapshots_.read(); }
+
+private:
+    void run();
+
+    // Take the next sample now; called by the backend from any thread
+    void requestSample();
+
+    std::unique_ptr<IMetricsBackend> backend_;
+    AlertManager alert_manager_;
+    std::chrono::milliseconds interval_;
+    std::function<void()> on_publish_;
+    std::function<void()> on_finished_;
+    MetricArchiveWriter* archive_;
+
+    TripleBuffer<Snapshot> snapshots_;
+    uint64_t sequence_;
+
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_;
+    bool sample_requested_;
+};
+
+} // namespace resmon
+
+#endif // RESMON_APP_SAMPLER_H
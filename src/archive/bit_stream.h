@@ -0,0 +1,118 @@
+#ifndef RESMON_ARCHIVE_BIT_STREAM_H
+#define RESMON_ARCHIVE_BIT_STREAM_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace resmon {
+
+// MSB-first bit writer over a fixed, caller-owned buffer. Bits past the
+// write position are not assumed to be zero, so the buffer can be reused
+// without clearing it first.
+class BitWriter {
+public:
+    BitWriter()
+        : data_(nullptr)
+        , capacity_bits_(0)
+        , position_(0)
+    {
+    }
+
+    BitWriter(uint8_t* data, size_t capacity_bits, size_t position = 0)
+        : data_(data)
+        , capacity_bits_(capacity_bits)
+        , position_(position)
+    {
+    }
+
+    size_t position() const { return position_; }
+    size_t remaining() const { return capacity_bits_ - position_; }
+
+    // Write the low `bits` bits of value (bits <= 64). The caller checks
+    // remaining() first; writes past the end are dropped.
+    void write(uint64_t value, unsigned bits) {
+        if (bits > remaining()) {
+            position_ = capacity_bits_;
+            return;
+        }
+        while (bits > 0) {
+            size_t byte = position_ / 8;
+            unsigned used = static_cast<unsigned>(position_ % 8);
+            unsigned count = 8 - used < bits ? 8 - used : bits;
+
+            unsigned shift = 8 - used - count;
+            uint8_t mask = static_cast<uint8_t>(((1u << count) - 1) << shift);
+            uint8_t chunk = static_cast<uint8_t>(((value >> (bits - count)) & ((1u << count) - 1)) << shift);
+            data_[byte] = static_cast<uint8_t>((data_[byte] & ~mask) | chunk);
+
+            bits -= count;
+            position_ += count;
+        }
+    }
+
+    void writeBit(bool bit) { write(bit ? 1 : 0, 1); }
+
+private:
+    uint8_t* data_;
+    size_t capacity_bits_;
+    size_t position_;
+};
+
+// Reads what BitWriter wrote. Reads past the end fail and leave the reader
+// exhausted, so a truncated stream is detected rather than misdecoded.
+class BitReader {
+public:
+    BitReader()
+        : data_(nullptr)
+        , length_bits_(0)
+        , position_(0)
+    {
+    }
+
+    BitReader(const uint8_t* data, size_t length_bits)
+        : data_(data)
+        , length_bits_(length_bits)
+        , position_(0)
+    {
+    }
+
+    size_t remaining() const { return length_bits_ - position_; }
+
+    bool read(unsigned bits, uint64_t& value) {
+        if (bits > remaining()) {
+            position_ = length_bits_;
+            return false;
+        }
+        value = 0;
+        while (bits > 0) {
+            size_t byte = position_ / 8;
+            unsigned used = static_cast<unsigned>(position_ % 8);
+            unsigned count = 8 - used < bits ? 8 - used : bits;
+
+            unsigned shift = 8 - used - count;
+            value = (value << count) | ((data_[byte] >> shift) & ((1u << count) - 1));
+
+            bits -= count;
+            position_ += count;
+        }
+        return true;
+    }
+
+    bool readBit(bool& bit) {
+        uint64_t value = 0;
+        if (!read(1, value)) {
+            return false;
+        }
+        bit = value != 0;
+        return true;
+    }
+
+private:
+    const uint8_t* data_;
+    size_t length_bits_;
+    size_t position_;
+};
+
+} // namespace resmon
+
+#endif // RESMON_ARCHIVE_BIT_STREAM_H
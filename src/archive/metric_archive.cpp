@@ -0,0 +1,721 @@
+#include "archive/metric_archive.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace resmon {
+
+// ============================================================================
+// File layout
+//
+//   [file header, 4 KiB][block 0][block 1]...[block N-1]
+//
+// Each 64 KiB block is [BlockHeader][GPU descriptors][bitstream]. All
+// integers are stored in host byte order.
+// ============================================================================
+
+static const char FILE_MAGIC[8] = {'R', 'E', 'S', 'M', 'O', 'N', 'A', 'R'};
+static constexpr uint32_t FILE_VERSION = 1;
+static constexpr uint64_t FILE_HEADER_SIZE = 4096;
+static constexpr uint32_t BLOCK_SIZE = 64 * 1024;
+static constexpr uint32_t BLOCK_MAGIC = 0x4b4c4252;   // "RBLK"
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t block_size;
+    uint32_t block_count;
+    uint32_t max_gpus;
+};
+
+struct BlockHeader {
+    uint32_t magic;
+    uint32_t checksum;             // of the bitstream, valid once sealed
+    uint64_t sequence;             // increases by one per block, 0 = unused
+    uint64_t first_timestamp_ms;
+    uint64_t last_timestamp_ms;
+    uint32_t sample_count;         // committed samples
+    uint32_t bit_count;            // committed bits
+    uint16_t gpu_count;
+    uint8_t sealed;
+    uint8_t reserved[5];
+};
+
+struct GpuDescriptor {
+    char vendor[16];
+    char name[48];
+};
+
+static constexpr size_t BLOCK_HEADER_SIZE = 64;
+static constexpr size_t BLOCK_DATA_OFFSET =
+    BLOCK_HEADER_SIZE + MetricArchiveWriter::MAX_GPUS * sizeof(GpuDescriptor);
+static constexpr size_t BLOCK_DATA_BITS = (BLOCK_SIZE - BLOCK_DATA_OFFSET) * 8;
+
+static_assert(sizeof(FileHeader) <= FILE_HEADER_SIZE, "file header too large");
+static_assert(sizeof(BlockHeader) <= BLOCK_HEADER_SIZE, "block header too large");
+
+// Column widths of one sample: the host values, then GPU_COLUMNS per GPU
+static constexpr uint8_t HOST_WIDTHS[] = {
+    32,   // cpu.usage_percent
+    32,   // cpu.temperature_celsius
+    32,   // cpu.core_count
+    64,   // ram.used_bytes
+    64,   // ram.total_bytes
+    32,   // ram.usage_percent
+};
+static constexpr uint8_t GPU_WIDTHS[] = {
+    32,   // usage_percent
+    32,   // temperature_celsius
+    64,   // vram_used_bytes
+    64,   // vram_total_bytes
+};
+static constexpr size_t HOST_COLUMNS = sizeof(HOST_WIDTHS);
+static constexpr size_t GPU_COLUMNS = sizeof(GPU_WIDTHS);
+
+static size_t columnCount(size_t gpu_count) {
+    return HOST_COLUMNS + GPU_COLUMNS * gpu_count;
+}
+
+static unsigned columnWidth(size_t column) {
+    return column < HOST_COLUMNS ? HOST_WIDTHS[column]
+                                 : GPU_WIDTHS[(column - HOST_COLUMNS) % GPU_COLUMNS];
+}
+
+// Upper bound on the encoded size of one sample
+static size_t maxSampleBits(size_t gpu_count) {
+    // 4 control bits + raw 64-bit delta-of-delta, and per column
+    // 2 control bits + 6-bit leading zeros + 6-bit length + 64 bits
+    return (4 + 64) + columnCount(gpu_count) * (2 + 6 + 6 + 64);
+}
+
+static uint64_t floatBits(float value) {
+    uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static float bitsFloat(uint64_t bits) {
+    uint32_t narrow = static_cast<uint32_t>(bits);
+    float value = 0.0f;
+    std::memcpy(&value, &narrow, sizeof(value));
+    return value;
+}
+
+// FNV-1a, enough to reject blocks torn by a power loss
+static uint32_t checksum(const uint8_t* data, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; ++i) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static void copyField(char* dest, size_t size, const std::string& value) {
+    size_t length = std::min(value.size(), size - 1);
+    std::memcpy(dest, value.data(), length);
+    std::memset(dest + length, 0, size - length);
+}
+
+static bool fieldEquals(const char* field, size_t size, const std::string& value) {
+    size_t length = std::min(value.size(), size - 1);
+    return std::strncmp(field, value.c_str(), length) == 0 && field[length] == '\0';
+}
+
+static std::string errnoMessage(const char* what, const std::string& path) {
+    return std::string(what) + " " + path + ": " + std::strerror(errno);
+}
+
+// Size a new archive. On Linux the blocks are reserved up front so a full
+// disk fails here instead of as SIGBUS on a later write to the mapping.
+static bool allocateFile(int fd, uint64_t size) {
+#ifdef __linux__
+    int result = posix_fallocate(fd, 0, static_cast<off_t>(size));
+    if (result != 0) {
+        errno = result;
+        return false;
+    }
+    return true;
+#else
+    return ftruncate(fd, static_cast<off_t>(size)) == 0;
+#endif
+}
+
+static bool validFileHeader(const FileHeader* header, uint64_t file_size) {
+    return std::memcmp(header->magic, FILE_MAGIC, sizeof(FILE_MAGIC)) == 0 &&
+           header->version == FILE_VERSION &&
+           header->block_size == BLOCK_SIZE &&
+           header->max_gpus == MetricArchiveWriter::MAX_GPUS &&
+           header->block_count > 0 &&
+           FILE_HEADER_SIZE + static_cast<uint64_t>(header->block_count) * BLOCK_SIZE <= file_size;
+}
+
+// ============================================================================
+// Encoding
+// ============================================================================
+
+// Delta-of-delta with Gorilla's variable-length buckets. At a fixed
+// interval the delta-of-delta is 0 or a few ms of jitter: 1 or 9 bits.
+static void encodeTimestamp(BitWriter& out, ArchiveTimestampState& state, uint64_t timestamp) {
+    int64_t delta = static_cast<int64_t>(timestamp - state.previous);
+    int64_t dod = delta - state.previous_delta;
+    state.previous = timestamp;
+    state.previous_delta = delta;
+
+    if (dod == 0) {
+        out.write(0x0, 1);
+    } else if (dod >= -63 && dod <= 64) {
+        out.write(0x2, 2);
+        out.write(static_cast<uint64_t>(dod + 63), 7);
+    } else if (dod >= -255 && dod <= 256) {
+        out.write(0x6, 3);
+        out.write(static_cast<uint64_t>(dod + 255), 9);
+    } else if (dod >= -2047 && dod <= 2048) {
+        out.write(0xe, 4);
+        out.write(static_cast<uint64_t>(dod + 2047), 12);
+    } else {
+        out.write(0xf, 4);
+        out.write(static_cast<uint64_t>(dod), 64);
+    }
+}
+
+static bool decodeTimestamp(BitReader& in, ArchiveTimestampState& state, uint64_t& timestamp) {
+    // Count the leading 1s of the control prefix (at most 4)
+    unsigned ones = 0;
+    bool bit = false;
+    while (ones < 4) {
+        if (!in.readBit(bit)) {
+            return false;
+        }
+        if (!bit) {
+            break;
+        }
+        ++ones;
+    }
+
+    int64_t dod = 0;
+    uint64_t raw = 0;
+    switch (ones) {
+        case 0:
+            break;
+        case 1:
+            if (!in.read(7, raw)) return false;
+            dod = static_cast<int64_t>(raw) - 63;
+            break;
+        case 2:
+            if (!in.read(9, raw)) return false;
+            dod = static_cast<int64_t>(raw) - 255;
+            break;
+        case 3:
+            if (!in.read(12, raw)) return false;
+            dod = static_cast<int64_t>(raw) - 2047;
+            break;
+        default:
+            if (!in.read(64, raw)) return false;
+            dod = static_cast<int64_t>(raw);
+            break;
+    }
+
+    state.previous_delta += dod;
+    state.previous += static_cast<uint64_t>(state.previous_delta);
+    timestamp = state.previous;
+    return true;
+}
+
+// Gorilla XOR coding: an unchanged value costs one bit; a changed one
+// stores only the meaningful bits of the XOR, reusing the previous
+// leading/trailing-zero window when the new bits fit inside it
+static void encodeValue(BitWriter& out, ArchiveColumnState& state, uint64_t value, unsigned width) {
+    uint64_t x = value ^ state.previous;
+    state.previous = value;
+
+    if (x == 0) {
+        out.write(0x0, 1);
+        return;
+    }
+
+    const unsigned count_bits = width == 64 ? 6 : 5;
+    unsigned leading = static_cast<unsigned>(__builtin_clzll(x)) - (64 - width);
+    unsigned trailing = static_cast<unsigned>(__builtin_ctzll(x));
+
+    if (state.leading != 0xff && leading >= state.leading && trailing >= state.trailing) {
+        out.write(0x2, 2);
+        out.write(x >> state.trailing, width - state.leading - state.trailing);
+        return;
+    }
+
+    unsigned length = width - leading - trailing;
+    out.write(0x3, 2);
+    out.write(leading, count_bits);
+    out.write(length - 1, count_bits);
+    out.write(x >> trailing, length);
+    state.leading = static_cast<uint8_t>(leading);
+    state.trailing = static_cast<uint8_t>(trailing);
+}
+
+static bool decodeValue(BitReader& in, ArchiveColumnState& state, uint64_t& value, unsigned width) {
+    bool changed = false;
+    if (!in.readBit(changed)) {
+        return false;
+    }
+    if (!changed) {
+        value = state.previous;
+        return true;
+    }
+
+    bool new_window = false;
+    if (!in.readBit(new_window)) {
+        return false;
+    }
+    if (new_window) {
+        const unsigned count_bits = width == 64 ? 6 : 5;
+        uint64_t leading = 0;
+        uint64_t length = 0;
+        if (!in.read(count_bits, leading) || !in.read(count_bits, length)) {
+            return false;
+        }
+        length += 1;
+        if (leading + length > width) {
+            return false;
+        }
+        state.leading = static_cast<uint8_t>(leading);
+        state.trailing = static_cast<uint8_t>(width - leading - length);
+    } else if (state.leading == 0xff) {
+        return false;
+    }
+
+    uint64_t bits = 0;
+    if (!in.read(width - state.leading - state.trailing, bits)) {
+        return false;
+    }
+    value = state.previous ^ (bits << state.trailing);
+    state.previous = value;
+    return true;
+}
+
+// Flatten a sample into one value per column
+static void sampleToRow(const SystemMetrics& metrics, size_t gpu_count, uint64_t* row) {
+    row[0] = floatBits(metrics.cpu.usage_percent);
+    row[1] = floatBits(metrics.cpu.temperature_celsius);
+    row[2] = static_cast<uint32_t>(metrics.cpu.core_count);
+    row[3] = metrics.ram.used_bytes;
+    row[4] = metrics.ram.total_bytes;
+    row[5] = floatBits(metrics.ram.usage_percent);
+
+    for (size_t i = 0; i < gpu_count; ++i) {
+        const GpuMetrics& gpu = metrics.gpus[i];
+        uint64_t* out = row + HOST_COLUMNS + i * GPU_COLUMNS;
+        out[0] = floatBits(gpu.usage_percent);
+        out[1] = floatBits(gpu.temperature_celsius);
+        out[2] = gpu.vram_used_bytes;
+        out[3] = gpu.vram_total_bytes;
+    }
+}
+
+static void rowToSample(const uint64_t* row, size_t gpu_count, SystemMetrics& metrics) {
+    metrics.cpu.usage_percent = bitsFloat(row[0]);
+    metrics.cpu.temperature_celsius = bitsFloat(row[1]);
+    metrics.cpu.core_count = static_cast<int>(static_cast<uint32_t>(row[2]));
+    metrics.ram.used_bytes = row[3];
+    metrics.ram.total_bytes = row[4];
+    metrics.ram.usage_percent = bitsFloat(row[5]);
+
+    for (size_t i = 0; i < gpu_count; ++i) {
+        GpuMetrics& gpu = metrics.gpus[i];
+        const uint64_t* in = row + HOST_COLUMNS + i * GPU_COLUMNS;
+        gpu.usage_percent = bitsFloat(in[0]);
+        gpu.temperature_celsius = bitsFloat(in[1]);
+        gpu.vram_used_bytes = in[2];
+        gpu.vram_total_bytes = in[3];
+    }
+}
+
+// ============================================================================
+// MetricArchiveWriter
+// ============================================================================
+
+MetricArchiveWriter::MetricArchiveWriter()
+    : fd_(-1)
+    , base_(nullptr)
+    , size_(0)
+    , block_size_(0)
+    , block_count_(0)
+    , slot_(0)
+    , sequence_(0)
+    , block_open_(false)
+{
+    row_.resize(columnCount(MAX_GPUS));
+    columns_.reserve(columnCount(MAX_GPUS));
+}
+
+MetricArchiveWriter::~MetricArchiveWriter() {
+    close();
+}
+
+bool MetricArchiveWriter::open(const std::string& path, uint64_t size_bytes) {
+    close();
+
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        error_ = errnoMessage("cannot open", path);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd_, &st) != 0) {
+        error_ = errnoMessage("cannot stat", path);
+        close();
+        return false;
+    }
+
+    bool created = st.st_size == 0;
+    if (created) {
+        uint64_t blocks = size_bytes > FILE_HEADER_SIZE ? (size_bytes - FILE_HEADER_SIZE) / BLOCK_SIZE : 0;
+        if (blocks < 2 || blocks > UINT32_MAX) {
+            error_ = "archive size must hold at least two 64 KiB blocks";
+            close();
+            return false;
+        }
+        size_ = FILE_HEADER_SIZE + blocks * BLOCK_SIZE;
+
+        if (!allocateFile(fd_, size_)) {
+            error_ = errnoMessage("cannot allocate", path);
+            close();
+            ::unlink(path.c_str());
+            return false;
+        }
+    } else {
+        size_ = static_cast<uint64_t>(st.st_size);
+        if (size_ < FILE_HEADER_SIZE) {
+            error_ = path + " is not a resmon archive";
+            close();
+            return false;
+        }
+    }
+
+    void* mapping = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (mapping == MAP_FAILED) {
+        error_ = errnoMessage("cannot map", path);
+        close();
+        return false;
+    }
+    base_ = static_cast<uint8_t*>(mapping);
+
+    FileHeader* header = reinterpret_cast<FileHeader*>(base_);
+    if (created) {
+        header->version = FILE_VERSION;
+        header->block_size = BLOCK_SIZE;
+        header->block_count = static_cast<uint32_t>((size_ - FILE_HEADER_SIZE) / BLOCK_SIZE);
+        header->max_gpus = MAX_GPUS;
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(header->magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+    } else if (!validFileHeader(header, size_)) {
+        error_ = path + " is not a resmon archive";
+        close();
+        return false;
+    }
+    block_size_ = header->block_size;
+    block_count_ = header->block_count;
+
+    // Continue after the newest block, sealing it if its writer died
+    slot_ = block_count_ - 1;
+    sequence_ = 0;
+    for (uint32_t slot = 0; slot < block_count_; ++slot) {
+        const BlockHeader* block = reinterpret_cast<const BlockHeader*>(
+            base_ + FILE_HEADER_SIZE + static_cast<uint64_t>(slot) * block_size_);
+        if (block->magic == BLOCK_MAGIC && block->sequence > sequence_) {
+            sequence_ = block->sequence;
+            slot_ = slot;
+        }
+    }
+    if (sequence_ > 0) {
+        sealBlock(slot_);
+    }
+    block_open_ = false;
+    error_.clear();
+    return true;
+}
+
+void MetricArchiveWriter::close() {
+    if (base_) {
+        if (block_open_) {
+            sealBlock(slot_);
+        }
+        msync(base_, size_, MS_ASYNC);
+        munmap(base_, size_);
+        base_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    size_ = 0;
+    block_open_ = false;
+}
+
+bool MetricArchiveWriter::sameGpus(const SystemMetrics& metrics) const {
+    const BlockHeader* block = reinterpret_cast<const BlockHeader*>(
+        base_ + FILE_HEADER_SIZE + static_cast<uint64_t>(slot_) * block_size_);
+    size_t gpu_count = std::min(metrics.gpus.size(), MAX_GPUS);
+    if (block->gpu_count != gpu_count) {
+        return false;
+    }
+
+    const GpuDescriptor* descriptors = reinterpret_cast<const GpuDescriptor*>(
+        reinterpret_cast<const uint8_t*>(block) + BLOCK_HEADER_SIZE);
+    for (size_t i = 0; i < gpu_count; ++i) {
+        if (!fieldEquals(descriptors[i].name, sizeof(descriptors[i].name), metrics.gpus[i].name) ||
+            !fieldEquals(descriptors[i].vendor, sizeof(descriptors[i].vendor), metrics.gpus[i].vendor)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void MetricArchiveWriter::startBlock(const SystemMetrics& metrics) {
+    slot_ = (slot_ + 1) % block_count_;
+    uint8_t* start = base_ + FILE_HEADER_SIZE + static_cast<uint64_t>(slot_) * block_size_;
+    BlockHeader* block = reinterpret_cast<BlockHeader*>(start);
+
+    // Invalidate the slot before reusing it so a crash midway leaves no
+    // half-initialized block behind
+    block->magic = 0;
+    std::atomic_thread_fence(std::memory_order_release);
+
+    size_t gpu_count = std::min(metrics.gpus.size(), MAX_GPUS);
+    GpuDescriptor* descriptors = reinterpret_cast<GpuDescriptor*>(start + BLOCK_HEADER_SIZE);
+    for (size_t i = 0; i < gpu_count; ++i) {
+        copyField(descriptors[i].name, sizeof(descriptors[i].name), metrics.gpus[i].name);
+        copyField(descriptors[i].vendor, sizeof(descriptors[i].vendor), metrics.gpus[i].vendor);
+    }
+
+    block->checksum = 0;
+    block->sequence = ++sequence_;
+    block->first_timestamp_ms = metrics.timestamp_ms;
+    block->last_timestamp_ms = metrics.timestamp_ms;
+    block->sample_count = 0;
+    block->bit_count = 0;
+    block->gpu_count = static_cast<uint16_t>(gpu_count);
+    block->sealed = 0;
+    std::atomic_thread_fence(std::memory_order_release);
+    block->magic = BLOCK_MAGIC;
+
+    bits_ = BitWriter(start + BLOCK_DATA_OFFSET, BLOCK_DATA_BITS);
+    timestamp_ = ArchiveTimestampState();
+    timestamp_.previous = metrics.timestamp_ms;
+    columns_.assign(columnCount(gpu_count), ArchiveColumnState());
+    block_open_ = true;
+}
+
+void MetricArchiveWriter::sealBlock(uint32_t slot) {
+    uint8_t* start = base_ + FILE_HEADER_SIZE + static_cast<uint64_t>(slot) * block_size_;
+    BlockHeader* block = reinterpret_cast<BlockHeader*>(start);
+    if (block->magic != BLOCK_MAGIC || block->sealed || block->bit_count > BLOCK_DATA_BITS) {
+        return;
+    }
+
+    block->checksum = checksum(start + BLOCK_DATA_OFFSET, (block->bit_count + 7) / 8);
+    std::atomic_thread_fence(std::memory_order_release);
+    block->sealed = 1;
+
+    // Start writeback without waiting for it
+    msync(start, block_size_, MS_ASYNC);
+}
+
+void MetricArchiveWriter::append(const SystemMetrics& metrics) {
+    if (!base_) {
+        return;
+    }
+
+    size_t gpu_count = std::min(metrics.gpus.size(), MAX_GPUS);
+    if (!block_open_ || !sameGpus(metrics) || bits_.remaining() < maxSampleBits(gpu_count)) {
+        if (block_open_) {
+            sealBlock(slot_);
+        }
+        startBlock(metrics);
+    }
+
+    encodeTimestamp(bits_, timestamp_, metrics.timestamp_ms);
+    sampleToRow(metrics, gpu_count, row_.data());
+    for (size_t column = 0; column < columns_.size(); ++column) {
+        encodeValue(bits_, columns_[column], row_[column], columnWidth(column));
+    }
+
+    // Commit: the bits are in place before the counts that expose them
+    BlockHeader* block = reinterpret_cast<BlockHeader*>(
+        base_ + FILE_HEADER_SIZE + static_cast<uint64_t>(slot_) * block_size_);
+    block->last_timestamp_ms = metrics.timestamp_ms;
+    std::atomic_thread_fence(std::memory_order_release);
+    block->bit_count = static_cast<uint32_t>(bits_.position());
+    block->sample_count += 1;
+}
+
+// ============================================================================
+// MetricArchiveReader
+// ============================================================================
+
+MetricArchiveReader::MetricArchiveReader()
+    : fd_(-1)
+    , base_(nullptr)
+    , size_(0)
+    , block_size_(0)
+    , block_index_(0)
+    , samples_left_(0)
+    , gpu_count_(0)
+{
+    row_.resize(columnCount(MetricArchiveWriter::MAX_GPUS));
+    columns_.reserve(columnCount(MetricArchiveWriter::MAX_GPUS));
+}
+
+MetricArchiveReader::~MetricArchiveReader() {
+    close();
+}
+
+bool MetricArchiveReader::open(const std::string& path) {
+    close();
+
+    fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ < 0) {
+        error_ = errnoMessage("cannot open", path);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd_, &st) != 0) {
+        error_ = errnoMessage("cannot stat", path);
+        close();
+        return false;
+    }
+    size_ = static_cast<uint64_t>(st.st_size);
+    if (size_ < FILE_HEADER_SIZE) {
+        error_ = path + " is not a resmon archive";
+        close();
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+    if (mapping == MAP_FAILED) {
+        error_ = errnoMessage("cannot map", path);
+        close();
+        return false;
+    }
+    base_ = static_cast<const uint8_t*>(mapping);
+
+    const FileHeader* header = reinterpret_cast<const FileHeader*>(base_);
+    if (!validFileHeader(header, size_)) {
+        error_ = path + " is not a resmon archive";
+        close();
+        return false;
+    }
+    block_size_ = header->block_size;
+
+    // Keep the blocks that are intact, ordered by sequence
+    std::vector<std::pair<uint64_t, uint32_t>> found;
+    for (uint32_t slot = 0; slot < header->block_count; ++slot) {
+        const uint8_t* start = base_ + FILE_HEADER_SIZE + static_cast<uint64_t>(slot) * block_size_;
+        const BlockHeader* block = reinterpret_cast<const BlockHeader*>(start);
+        if (block->magic != BLOCK_MAGIC || block->sequence == 0 || block->sample_count == 0 ||
+            block->gpu_count > MetricArchiveWriter::MAX_GPUS || block->bit_count > BLOCK_DATA_BITS) {
+            continue;
+        }
+        if (block->sealed &&
+            block->checksum != checksum(start + BLOCK_DATA_OFFSET, (block->bit_count + 7) / 8)) {
+            continue;
+        }
+        found.emplace_back(block->sequence, slot);
+    }
+    std::sort(found.begin(), found.end());
+
+    blocks_.clear();
+    for (const auto& entry : found) {
+        blocks_.push_back(entry.second);
+    }
+
+    rewind();
+    error_.clear();
+    return true;
+}
+
+void MetricArchiveReader::close() {
+    if (base_) {
+        munmap(const_cast<uint8_t*>(base_), size_);
+        base_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    size_ = 0;
+    blocks_.clear();
+    rewind();
+}
+
+void MetricArchiveReader::rewind() {
+    block_index_ = 0;
+    samples_left_ = 0;
+}
+
+bool MetricArchiveReader::beginBlock(size_t index) {
+    const uint8_t* start = base_ + FILE_HEADER_SIZE + static_cast<uint64_t>(blocks_[index]) * block_size_;
+    const BlockHeader* block = reinterpret_cast<const BlockHeader*>(start);
+
+    samples_left_ = block->sample_count;
+    gpu_count_ = block->gpu_count;
+    bits_ = BitReader(start + BLOCK_DATA_OFFSET, std::min<size_t>(block->bit_count, BLOCK_DATA_BITS));
+    timestamp_ = ArchiveTimestampState();
+    timestamp_.previous = block->first_timestamp_ms;
+    columns_.assign(columnCount(gpu_count_), ArchiveColumnState());
+    return gpu_count_ <= MetricArchiveWriter::MAX_GPUS;
+}
+
+bool MetricArchiveReader::next(SystemMetrics& metrics) {
+    if (!base_) {
+        return false;
+    }
+
+    uint64_t timestamp = 0;
+    for (;;) {
+        while (samples_left_ == 0) {
+            if (block_index_ >= blocks_.size()) {
+                return false;
+            }
+            if (!beginBlock(block_index_++)) {
+                samples_left_ = 0;
+            }
+        }
+
+        bool ok = decodeTimestamp(bits_, timestamp_, timestamp);
+        for (size_t column = 0; ok && column < columns_.size(); ++column) {
+            ok = decodeValue(bits_, columns_[column], row_[column], columnWidth(column));
+        }
+        if (ok) {
+            break;
+        }
+        // Corrupt block: skip what is left of it
+        samples_left_ = 0;
+    }
+    --samples_left_;
+
+    const uint8_t* start = base_ + FILE_HEADER_SIZE +
+        static_cast<uint64_t>(blocks_[block_index_ - 1]) * block_size_;
+    const GpuDescriptor* descriptors = reinterpret_cast<const GpuDescriptor*>(start + BLOCK_HEADER_SIZE);
+
+    metrics.timestamp_ms = timestamp;
+    metrics.gpus.resize(gpu_count_);
+    for (size_t i = 0; i < gpu_count_; ++i) {
+        metrics.gpus[i].name.assign(descriptors[i].name,
+                                    strnlen(descriptors[i].name, sizeof(descriptors[i].name)));
+        metrics.gpus[i].vendor.assign(descriptors[i].vendor,
+                                      strnlen(descriptors[i].vendor, sizeof(descriptors[i].vendor)));
+    }
+    rowToSample(row_.data(), gpu_count_, metrics);
+    return true;
+}
+
+} // namespace resmon
@@ -0,0 +1,132 @@
+#ifndef RESMON_ARCHIVE_METRIC_ARCHIVE_H
+#define RESMON_ARCHIVE_METRIC_ARCHIVE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "archive/bit_stream.h"
+#include "core/metrics.h"
+
+namespace resmon {
+
+// On-disk metric archive: a fixed-size file, memory-mapped and used as a
+// ring of fixed-size blocks. Each block holds a run of samples with the
+// same GPU set, compressed Gorilla-style: timestamps as delta-of-delta,
+// every value as the XOR with its previous value in the block.
+//
+// Appending only writes into the mapping (no fsync, no syscalls except an
+// asynchronous msync when a block fills). A block's committed sample count
+// and bit length are stored after its bits, so a reader never sees a
+// partially written sample. Sealed blocks carry a checksum; after a crash
+// at most the block being written is lost.
+
+// Per-column XOR coder state, shared by the writer and reader
+struct ArchiveColumnState {
+    uint64_t previous = 0;
+    uint8_t leading = 0xff;   // 0xff = no window yet
+    uint8_t trailing = 0;
+};
+
+// Delta-of-delta timestamp coder state
+struct ArchiveTimestampState {
+    uint64_t previous = 0;
+    int64_t previous_delta = 0;
+};
+
+class MetricArchiveWriter {
+public:
+    // GPUs beyond this are not recorded
+    static constexpr size_t MAX_GPUS = 16;
+
+    static constexpr uint64_t DEFAULT_SIZE_BYTES = 64ull * 1024 * 1024;
+
+    MetricArchiveWriter();
+    ~MetricArchiveWriter();
+
+    // Non-copyable (owns the mapping)
+    MetricArchiveWriter(const MetricArchiveWriter&) = delete;
+    MetricArchiveWriter& operator=(const MetricArchiveWriter&) = delete;
+
+    // Open or create an archive. A new file is allocated at size_bytes; an
+    // existing archive keeps its own size and recording continues in a new
+    // block after its newest one. Returns false (see error()) on failure,
+    // including for an existing file that is not an archive.
+    bool open(const std::string& path, uint64_t size_bytes = DEFAULT_SIZE_BYTES);
+    void close();
+    bool isOpen() const { return base_ != nullptr; }
+
+    void append(const SystemMetrics& metrics);
+
+    const std::string& error() const { return error_; }
+
+private:
+    bool sameGpus(const SystemMetrics& metrics) const;
+    void startBlock(const SystemMetrics& metrics);
+    void sealBlock(uint32_t slot);
+
+    int fd_;
+    uint8_t* base_;
+    uint64_t size_;
+    uint32_t block_size_;
+    uint32_t block_count_;
+
+    uint32_t slot_;            // newest block
+    uint64_t sequence_;        // its sequence number, 0 = none yet
+    bool block_open_;          // slot_ was started by this writer
+    BitWriter bits_;
+    ArchiveTimestampState timestamp_;
+    std::vector<ArchiveColumnState> columns_;
+    std::vector<uint64_t> row_;
+
+    std::string error_;
+};
+
+// Sequential reader over the samples of an archive, oldest first
+class MetricArchiveReader {
+public:
+    MetricArchiveReader();
+    ~MetricArchiveReader();
+
+    // Non-copyable (owns the mapping)
+    MetricArchiveReader(const MetricArchiveReader&) = delete;
+    MetricArchiveReader& operator=(const MetricArchiveReader&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return base_ != nullptr; }
+
+    // Decode the next sample into metrics. Returns false at the end.
+    bool next(SystemMetrics& metrics);
+
+    // Start again from the oldest sample
+    void rewind();
+
+    size_t blockCount() const { return blocks_.size(); }
+
+    const std::string& error() const { return error_; }
+
+private:
+    bool beginBlock(size_t index);
+
+    int fd_;
+    const uint8_t* base_;
+    uint64_t size_;
+    uint32_t block_size_;
+
+    std::vector<uint32_t> blocks_;   // valid block slots, oldest first
+    size_t block_index_;
+    uint32_t samples_left_;
+    size_t gpu_count_;
+    BitReader bits_;
+    ArchiveTimestampState timestamp_;
+    std::vector<ArchiveColumnState> columns_;
+    std::vector<uint64_t> row_;
+
+    std::string error_;
+};
+
+} // namespace resmon
+
+#endif // RESMON_ARCHIVE_METRIC_ARCHIVE_H
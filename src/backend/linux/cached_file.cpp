@@ -0,0 +1,201 @@
+#include "cached_file.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace resmon {
+namespace platform {
+
+// Most sysfs attributes fit in a few bytes; procfs files grow the buffer
+// on first read and keep it
+static constexpr size_t INITIAL_BUFFER_SIZE = 256;
+
+CachedFile::CachedFile(std::string path)
+    : path_(std::move(path))
+{
+}
+
+CachedFile::~CachedFile() {
+    close();
+}
+
+CachedFile::CachedFile(CachedFile&& other) noexcept
+    : path_(std::move(other.path_))
+    , fd_(other.fd_)
+    , buffer_(std::move(other.buffer_))
+    , size_(other.size_)
+{
+    other.fd_ = -1;
+    other.size_ = 0;
+}
+
+CachedFile& CachedFile::operator=(CachedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        path_ = std::move(other.path_);
+        fd_ = other.fd_;
+        buffer_ = std::move(other.buffer_);
+        size_ = other.size_;
+        other.fd_ = -1;
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+void CachedFile::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool CachedFile::open() {
+    if (path_.empty()) {
+        return false;
+    }
+    fd_ = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+    return fd_ >= 0;
+}
+
+bool CachedFile::read() {
+    size_ = 0;
+
+    if (fd_ < 0 && !open()) {
+        return false;
+    }
+    if (buffer_.empty()) {
+        buffer_.resize(INITIAL_BUFFER_SIZE);
+    }
+
+    bool reopened = false;
+    for (;;) {
+        // Keep one byte spare so the contents are always NUL-terminated
+        if (size_ + 1 >= buffer_.size()) {
+            buffer_.resize(buffer_.size() * 2);
+        }
+
+        ssize_t n = ::pread(fd_, buffer_.data() + size_, buffer_.size() - size_ - 1,
+                            static_cast<off_t>(size_));
+        if (n > 0) {
+            size_ += static_cast<size_t>(n);
+            continue;
+        }
+        if (n == 0) {
+            break;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+
+        // Device went away or was re-created under us: reopen once and retry
+        if ((errno == ESTALE || errno == ENODEV) && !reopened) {
+            reopened = true;
+            close();
+            size_ = 0;
+            if (open()) {
+                continue;
+            }
+        }
+        size_ = 0;
+        return false;
+    }
+
+    buffer_[size_] = '\0';
+    return true;
+}
+
+std::string_view CachedFile::readString() {
+    if (!read()) {
+        return {};
+    }
+    std::string_view value = contents();
+    size_t newline = value.find('\n');
+    if (newline != std::string_view::npos) {
+        value = value.substr(0, newline);
+    }
+    return trimValue(value);
+}
+
+int64_t CachedFile::readInt() {
+    int64_t value = -1;
+    if (!readInt(value)) {
+        return -1;
+    }
+    return value;
+}
+
+bool CachedFile::readInt(int64_t& value) {
+    if (!read() || size_ == 0) {
+        return false;
+    }
+    char* end = nullptr;
+    errno = 0;
+    long long parsed = std::strtoll(buffer_.data(), &end, 10);
+    if (end == buffer_.data() || errno == ERANGE) {
+        return false;
+    }
+    value = static_cast<int64_t>(parsed);
+    return true;
+}
+
+std::string_view trimValue(std::string_view value) {
+    while (!value.empty() && (value.back() == '\n' || value.back() == '\r' || value.back() == ' ')) {
+        value.remove_suffix(1);
+    }
+    return value;
+}
+
+// Descriptors RLIMIT_NOFILE leaves to everything but kept files
+static constexpr size_t RESERVED_FDS = 256;
+
+static std::atomic<size_t> kept_fds{0};
+
+size_t keptFdLimit() {
+    static const size_t kept_limit = [] {
+        struct rlimit limit;
+        if (getrlimit(RLIMIT_NOFILE, &limit) != 0) {
+            return size_t{0};
+        }
+        if (limit.rlim_cur == RLIM_INFINITY) {
+            return MAX_KEPT_FDS;
+        }
+        size_t soft = static_cast<size_t>(limit.rlim_cur);
+        return soft > RESERVED_FDS ? std::min(MAX_KEPT_FDS, (soft - RESERVED_FDS) / 2) : size_t{0};
+    }();
+    return kept_limit;
+}
+
+bool reserveKeptFds(size_t count) {
+    size_t limit = keptFdLimit();
+    size_t held = kept_fds.load(std::memory_order_relaxed);
+    do {
+        if (count > limit - held) {
+            return false;
+        }
+    } while (!kept_fds.compare_exchange_weak(held, held + count, std::memory_order_relaxed));
+    return true;
+}
+
+void releaseKeptFds(size_t count) {
+    kept_fds.fetch_sub(count, std::memory_order_relaxed);
+}
+
+std::string readFileString(const std::string& path) {
+    CachedFile file(path);
+    return std::string(file.readString());
+}
+
+int64_t readFileInt(const std::string& path) {
+    CachedFile file(path);
+    return file.readInt();
+}
+
+} // namespace platform
+} // namespace resmon
@@ -0,0 +1,86 @@
+#ifndef RESMON_BACKEND_LINUX_CACHED_FILE_H
+#define RESMON_BACKEND_LINUX_CACHED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace resmon {
+namespace platform {
+
+// A procfs/sysfs file that is opened once and re-read with pread() from
+// offset 0 on every sample. The read buffer is reused between reads, so
+// steady-state sampling costs one or two pread() calls and no allocations.
+// The file is reopened only if the descriptor goes stale (ESTALE/ENODEV),
+// e.g. after a driver reload.
+class CachedFile {
+public:
+    CachedFile() = default;
+    explicit CachedFile(std::string path);
+    ~CachedFile();
+
+    // Movable, non-copyable (owns a file descriptor)
+    CachedFile(CachedFile&& other) noexcept;
+    CachedFile& operator=(CachedFile&& other) noexcept;
+    CachedFile(const CachedFile&) = delete;
+    CachedFile& operator=(const CachedFile&) = delete;
+
+    // Re-read the whole file. Returns false if it could not be read; the
+    // previous contents are discarded either way.
+    bool read();
+
+    // Contents from the last successful read()
+    std::string_view contents() const { return std::string_view(buffer_.data(), size_); }
+
+    // Convenience wrappers around read(): first line without trailing
+    // whitespace, or the leading integer (-1 on failure)
+    std::string_view readString();
+    int64_t readInt();
+
+    // Same as readInt(), but distinguishes a failed read from a value of -1
+    bool readInt(int64_t& value);
+
+    const std::string& path() const { return path_; }
+    bool empty() const { return path_.empty(); }
+
+    // Close the descriptor; the next read() reopens it
+    void close();
+
+private:
+    bool open();
+
+    std::string path_;
+    int fd_ = -1;
+    std::vector<char> buffer_;
+    size_t size_ = 0;
+};
+
+// One-shot helpers for values that are only read during discovery
+std::string readFileString(const std::string& path);
+int64_t readFileInt(const std::string& path);
+
+// Budget for the descriptors collectors keep open between samples (a stat
+// file per process, the files of each cgroup), shared by all of them:
+// MAX_KEPT_FDS, or half of what RLIMIT_NOFILE leaves after a reserve for
+// the rest of the program if that is less. MAX_KEPT_FDS is half of
+// FD_SETSIZE (1024), so descriptors the program opens later (sockets, PSI
+// triggers) still get numbers select() can take. RLIMIT_NOFILE itself is
+// left alone. Files that don't fit are opened, read and closed each time
+// instead.
+constexpr size_t MAX_KEPT_FDS = 512;
+size_t keptFdLimit();
+
+// Take count descriptors from the budget; false (nothing taken) if they
+// don't fit. Thread-safe, collectors run in parallel.
+bool reserveKeptFds(size_t count);
+void releaseKeptFds(size_t count);
+
+// Trim trailing whitespace/newlines from a file value
+std::string_view trimValue(std::string_view value);
+
+} // namespace platform
+} // namespace resmon
+
+#endif // RESMON_BACKEND_LINUX_CACHED_FILE_H
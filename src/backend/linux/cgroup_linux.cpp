@@ -0,0 +1,340 @@
+#include "cgroup_linux.h"
+#include "pressure_linux.h"
+#include "proc_parse.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <dirent.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace resmon {
+namespace platform {
+
+static const char* const GROUP_FILE_NAMES[] = {
+    "cpu.stat", "memory.current", "memory.max", "memory.events", "io.stat", "pids.current", "cgroup.events",
+    "cpu.pressure", "memory.pressure", "io.pressure",
+};
+
+// Room for a few hundred events per read()
+static constexpr size_t EVENT_BUFFER_SIZE = 65536;
+
+static bool fileExists(const std::string& path) {
+    return access(path.c_str(), R_OK) == 0;
+}
+
+CgroupCollector::CgroupCollector(const std::string& root)
+    : cgroup_root_(root + "/sys/fs/cgroup")
+    , available_(fileExists(cgroup_root_ + "/cgroup.controllers"))
+    , inotify_fd_(-1)
+    , collects_since_rescan_(0)
+    , open_fds_(0)
+    , has_previous_(false)
+{
+    if (!available_) {
+        return;
+    }
+    inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd_ >= 0) {
+        event_buffer_.resize(EVENT_BUFFER_SIZE);
+    }
+    addTree("");
+}
+
+CgroupCollector::~CgroupCollector() {
+    if (inotify_fd_ >= 0) {
+        // Closing the inotify descriptor drops every watch with it
+        close(inotify_fd_);
+    }
+    releaseKeptFds(open_fds_);
+}
+
+void CgroupCollector::addGroup(const std::string& path) {
+    auto found = groups_.find(path);
+    if (found != groups_.end()) {
+        found->second.seen = true;
+        return;
+    }
+
+    Group& group = groups_[path];
+    group.path = path;
+    group.seen = true;
+    std::string directory = cgroup_root_ + path;
+
+    // Controllers only provide their files where they are enabled (and the
+    // root has no memory.* or pids.*); absent files are never opened
+    size_t present = 0;
+    for (int f = 0; f < GROUP_FILE_COUNT; ++f) {
+        std::string file = directory + "/" + GROUP_FILE_NAMES[f];
+        if (fileExists(file)) {
+            group.files[f] = CachedFile(file);
+            ++present;
+        }
+    }
+    group.keep_open = present > 0 && reserveKeptFds(present);
+    if (group.keep_open) {
+        open_fds_ += present;
+    }
+
+    if (inotify_fd_ >= 0) {
+        group.dir_watch = inotify_add_watch(inotify_fd_, directory.c_str(), IN_CREATE | IN_DELETE | IN_ONLYDIR);
+        if (group.dir_watch >= 0) {
+            watches_[group.dir_watch] = &group;
+        }
+        if (!group.files[FILE_CGROUP_EVENTS].empty()) {
+            group.events_watch = inotify_add_watch(inotify_fd_, group.files[FILE_CGROUP_EVENTS].path().c_str(),
+                                                   IN_MODIFY);
+            if (group.events_watch >= 0) {
+                watches_[group.events_watch] = &group;
+            }
+        }
+    }
+    readPopulated(group);
+}
+
+void CgroupCollector::addTree(const std::string& path) {
+    addGroup(path);
+
+    // Watch first, list second: a child created in between shows up in the
+    // listing or as an event, and adding it twice is harmless
+    DIR* dir = opendir((cgroup_root_ + path).c_str());
+    if (!dir) {
+        return;
+    }
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        if (entry->d_type != DT_DIR || entry->d_name[0] == '.') {
+            continue;
+        }
+        addTree(path + "/" + entry->d_name);
+    }
+    closedir(dir);
+}
+
+void CgroupCollector::closeGroup(Group& group) {
+    size_t kept = 0;
+    for (int f = 0; f < GROUP_FILE_COUNT; ++f) {
+        if (group.keep_open && !group.files[f].empty()) {
+            ++kept;
+        }
+        group.files[f].close();
+    }
+    group.keep_open = false;
+    open_fds_ -= kept;
+    releaseKeptFds(kept);
+    // The kernel drops the watches of a removed directory by itself; this
+    // only matters for groups dropped by a rescan
+    if (group.dir_watch >= 0) {
+        watches_.erase(group.dir_watch);
+        inotify_rm_watch(inotify_fd_, group.dir_watch);
+    }
+    if (group.events_watch >= 0) {
+        watches_.erase(group.events_watch);
+        inotify_rm_watch(inotify_fd_, group.events_watch);
+    }
+}
+
+void CgroupCollector::removeTree(const std::string& path) {
+    // The subtree is path itself plus the keys starting with "path/". Those
+    // are contiguous, but not next to path: siblings such as "path-b" and
+    // "path.slice" sort between them, since '-' and '.' come before '/'.
+    auto group = groups_.find(path);
+    if (group != groups_.end()) {
+        closeGroup(group->second);
+        groups_.erase(group);
+    }
+    std::string prefix = path + "/";
+    auto it = groups_.lower_bound(prefix);
+    while (it != groups_.end() && it->first.compare(0, prefix.size(), prefix) == 0) {
+        closeGroup(it->second);
+        it = groups_.erase(it);
+    }
+}
+
+void CgroupCollector::rescan() {
+    for (auto& entry : groups_) {
+        entry.second.seen = false;
+    }
+    addTree("");
+    for (auto it = groups_.begin(); it != groups_.end();) {
+        if (!it->second.seen) {
+            closeGroup(it->second);
+            it = groups_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    collects_since_rescan_ = 0;
+}
+
+bool CgroupCollector::drainEvents() {
+    bool complete = true;
+    for (;;) {
+        ssize_t length = read(inotify_fd_, event_buffer_.data(), event_buffer_.size());
+        if (length <= 0) {
+            break;   // EAGAIN: drained
+        }
+        for (ssize_t offset = 0; offset < length;) {
+            const struct inotify_event* event =
+                reinterpret_cast<const struct inotify_event*>(event_buffer_.data() + offset);
+            offset += static_cast<ssize_t>(sizeof(struct inotify_event) + event->len);
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                complete = false;
+                continue;
+            }
+            auto watch = watches_.find(event->wd);
+            if (watch == watches_.end()) {
+                continue;   // e.g. IN_IGNORED for a group already removed
+            }
+            Group& group = *watch->second;
+
+            if (event->wd == group.events_watch) {
+                readPopulated(group);
+            } else if ((event->mask & IN_ISDIR) && event->len > 0) {
+                std::string child = group.path + "/" + event->name;
+                if (event->mask & IN_CREATE) {
+                    addTree(child);
+                } else if (event->mask & IN_DELETE) {
+                    removeTree(child);
+                }
+            }
+        }
+    }
+    return complete;
+}
+
+void CgroupCollector::readPopulated(Group& group) {
+    uint64_t populated = 1;
+    if (readFile(group, FILE_CGROUP_EVENTS)) {
+        findKeyedValue(group.files[FILE_CGROUP_EVENTS].contents(), "populated", populated);
+    }
+    group.populated = populated != 0;
+}
+
+bool CgroupCollector::readFile(Group& group, GroupFile file) {
+    CachedFile& cached = group.files[file];
+    if (cached.empty()) {
+        return false;
+    }
+    bool ok = cached.read();
+    if (!group.keep_open) {
+        cached.close();
+    }
+    return ok;
+}
+
+void CgroupCollector::sample(Group& group, double elapsed_seconds, CgroupMetrics& metrics) {
+    metrics.path = group.path;
+    metrics.populated = group.populated;
+
+    int64_t value = 0;
+    if (!group.files[FILE_MEMORY_CURRENT].empty()) {
+        if (group.files[FILE_MEMORY_CURRENT].readInt(value) && value > 0) {
+            metrics.memory_bytes = static_cast<uint64_t>(value);
+        }
+        if (!group.keep_open) {
+            group.files[FILE_MEMORY_CURRENT].close();
+        }
+    }
+    if (!group.populated) {
+        // No tasks: no CPU or I/O, and the counters can't move until a
+        // populated event arrives, which re-reads everything
+        group.primed = false;
+        return;
+    }
+
+    // memory.max is "max" when unlimited, which reads as no number
+    if (readFile(group, FILE_MEMORY_MAX)) {
+        uint64_t limit = 0;
+        std::string_view contents = group.files[FILE_MEMORY_MAX].contents();
+        if (parseU64(contents.data(), contents.data() + contents.size(), limit)) {
+            metrics.memory_max_bytes = limit;
+        }
+    }
+    if (readFile(group, FILE_MEMORY_EVENTS)) {
+        findKeyedValue(group.files[FILE_MEMORY_EVENTS].contents(), "oom_kill", metrics.oom_kills);
+    }
+    if (readFile(group, FILE_PIDS_CURRENT)) {
+        std::string_view contents = group.files[FILE_PIDS_CURRENT].contents();
+        parseU64(contents.data(), contents.data() + contents.size(), metrics.pids);
+    }
+
+    uint64_t usage_usec = 0;
+    uint64_t throttled_usec = 0;
+    if (readFile(group, FILE_CPU_STAT)) {
+        std::string_view contents = group.files[FILE_CPU_STAT].contents();
+        findKeyedValue(contents, "usage_usec", usage_usec);
+        findKeyedValue(contents, "throttled_usec", throttled_usec);
+    }
+    // Stall shares; the files read as EOPNOTSUPP where PSI is switched off
+    // for the group (cgroup.pressure = 0)
+    ResourcePressure* pressures[] = {&metrics.pressure.cpu, &metrics.pressure.memory, &metrics.pressure.io};
+    for (int f = FILE_CPU_PRESSURE; f <= FILE_IO_PRESSURE; ++f) {
+        GroupFile file = static_cast<GroupFile>(f);
+        if (readFile(group, file) &&
+            parseResourcePressure(group.files[file].contents(), *pressures[f - FILE_CPU_PRESSURE])) {
+            metrics.pressure.available = true;
+        }
+    }
+
+    CgroupIoStat io;
+    if (readFile(group, FILE_IO_STAT)) {
+        parseCgroupIoStat(group.files[FILE_IO_STAT].contents(), io);
+    }
+    uint64_t ios = io.read_ios + io.write_ios;
+
+    if (group.primed && elapsed_seconds > 0.0) {
+        // Counters only grow; a smaller value means the group was recreated
+        auto rate = [elapsed_seconds](uint64_t now, uint64_t before) {
+            return now >= before ? static_cast<float>(static_cast<double>(now - before) / elapsed_seconds) : 0.0f;
+        };
+        metrics.cpu_percent = rate(usage_usec, group.usage_usec) / 10000.0f;
+        metrics.throttled_percent = rate(throttled_usec, group.throttled_usec) / 10000.0f;
+        metrics.io_read_bytes_per_second = rate(io.read_bytes, group.read_bytes);
+        metrics.io_write_bytes_per_second = rate(io.write_bytes, group.write_bytes);
+        metrics.io_ops_per_second = rate(ios, group.ios);
+    }
+    group.usage_usec = usage_usec;
+    group.throttled_usec = throttled_usec;
+    group.read_bytes = io.read_bytes;
+    group.write_bytes = io.write_bytes;
+    group.ios = ios;
+    group.primed = true;
+}
+
+std::vector<CgroupMetrics> CgroupCollector::collect() {
+    std::vector<CgroupMetrics> result;
+    if (!available_) {
+        return result;
+    }
+
+    if (inotify_fd_ >= 0) {
+        if (!drainEvents()) {
+            rescan();
+        }
+    } else if (++collects_since_rescan_ >= RESCAN_INTERVAL) {
+        rescan();
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = has_previous_ ? std::chrono::duration<double>(now - previous_time_).count() : 0.0;
+    previous_time_ = now;
+    has_previous_ = true;
+
+    // The root's files describe the whole host, which the other
+    // collectors already cover
+    result.reserve(groups_.size());
+    for (auto& entry : groups_) {
+        if (entry.first.empty()) {
+            continue;
+        }
+        result.emplace_back();
+        sample(entry.second, elapsed, result.back());
+    }
+    return result;
+}
+
+} // namespace platform
+} // namespace resmon
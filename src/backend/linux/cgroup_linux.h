@@ -0,0 +1,126 @@
+#ifndef RESMON_BACKEND_LINUX_CGROUP_LINUX_H
+#define RESMON_BACKEND_LINUX_CGROUP_LINUX_H
+
+#include "../../core/metrics.h"
+#include "cached_file.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace resmon {
+namespace platform {
+
+// Per-cgroup CPU, memory, I/O, pid counts and pressure stalls for every
+// group of the cgroup v2 hierarchy at /sys/fs/cgroup.
+//
+// The tree is walked once. After that, inotify keeps the set of groups
+// current: a watch on each group directory reports child groups being
+// created (mkdir) and removed (rmdir), and a watch on each cgroup.events
+// reports a group becoming empty or populated. An update therefore costs
+// one non-blocking read() of the inotify descriptor plus the stat reads,
+// never a rewalk. If events were lost (queue overflow) or inotify is not
+// available, the tree is walked again to reconcile.
+//
+// A group's files are opened once and re-read with pread(). Empty groups
+// only have memory.current re-read (page cache can stay charged to them).
+// Past the descriptor budget (keptFdLimit(), shared with the process
+// table), files are closed again after each read.
+class CgroupCollector {
+public:
+    // Walks without inotify rescan every this many collects
+    static constexpr int RESCAN_INTERVAL = 10;
+
+    // root: prefix for /sys (empty = the real filesystem)
+    explicit CgroupCollector(const std::string& root = std::string());
+    ~CgroupCollector();
+
+    // Non-copyable (owns file descriptors)
+    CgroupCollector(const CgroupCollector&) = delete;
+    CgroupCollector& operator=(const CgroupCollector&) = delete;
+
+    // Apply pending group changes and sample every group except the root
+    std::vector<CgroupMetrics> collect();
+
+    // True if a cgroup v2 hierarchy was found
+    bool isAvailable() const { return available_; }
+
+    // Whether group changes are tracked through inotify
+    bool watching() const { return inotify_fd_ >= 0; }
+
+    size_t groupCount() const { return groups_.size(); }
+
+private:
+    enum GroupFile {
+        FILE_CPU_STAT,
+        FILE_MEMORY_CURRENT,
+        FILE_MEMORY_MAX,
+        FILE_MEMORY_EVENTS,
+        FILE_IO_STAT,
+        FILE_PIDS_CURRENT,
+        FILE_CGROUP_EVENTS,
+        FILE_CPU_PRESSURE,
+        FILE_MEMORY_PRESSURE,
+        FILE_IO_PRESSURE,
+        GROUP_FILE_COUNT
+    };
+
+    struct Group {
+        std::string path;              // relative to cgroup_root_, "" for the root
+        CachedFile files[GROUP_FILE_COUNT];
+        bool keep_open = false;        // files stay open between reads
+        int dir_watch = -1;
+        int events_watch = -1;
+        bool populated = true;
+        bool seen = false;             // found by the current rescan
+
+        // Counters of the previous read, for rates
+        bool primed = false;
+        uint64_t usage_usec = 0;
+        uint64_t throttled_usec = 0;
+        uint64_t read_bytes = 0;
+        uint64_t write_bytes = 0;
+        uint64_t ios = 0;
+    };
+
+    // Add the group at path (if new) and everything below it
+    void addTree(const std::string& path);
+    void addGroup(const std::string& path);
+    // Remove the group at path and everything below it
+    void removeTree(const std::string& path);
+    void closeGroup(Group& group);
+
+    // Walk the whole tree again and drop groups that are gone
+    void rescan();
+
+    // Drain inotify; returns false if events were lost
+    bool drainEvents();
+
+    void readPopulated(Group& group);
+    void sample(Group& group, double elapsed_seconds, CgroupMetrics& metrics);
+    bool readFile(Group& group, GroupFile file);
+
+    std::string cgroup_root_;          // <root>/sys/fs/cgroup
+    bool available_;
+    int inotify_fd_;
+    std::vector<char> event_buffer_;
+    int collects_since_rescan_;
+
+    size_t open_fds_;                  // taken from the kept-descriptor budget
+
+    // Keyed by path, so a parent comes before its children
+    std::map<std::string, Group> groups_;
+    std::unordered_map<int, Group*> watches_;   // inotify wd -> its group
+
+    bool has_previous_;
+    std::chrono::steady_clock::time_point previous_time_;
+};
+
+} // namespace platform
+} // namespace resmon
+
+#endif // RESMON_BACKEND_LINUX_CGROUP_LINUX_H
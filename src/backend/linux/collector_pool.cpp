@@ -0,0 +1,54 @@
+#include "collector_pool.h"
+
+namespace resmon {
+namespace platform {
+
+CollectorPool::CollectorPool(size_t thread_count)
+    : stopping_(false)
+{
+    threads_.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; ++i) {
+        threads_.emplace_back(&CollectorPool::workerLoop, this);
+    }
+}
+
+CollectorPool::~CollectorPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        // Queued work is dropped; running tasks finish before join returns
+        tasks_.clear();
+    }
+    task_available_.notify_all();
+
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void CollectorPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    task_available_.notify_one();
+}
+
+void CollectorPool::workerLoop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            task_available_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+            if (stopping_) {
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+}
+
+} // namespace platform
+} // namespace resmon
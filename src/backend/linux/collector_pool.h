@@ -0,0 +1,44 @@
+#ifndef RESMON_BACKEND_LINUX_COLLECTOR_POOL_H
+#define RESMON_BACKEND_LINUX_COLLECTOR_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace resmon {
+namespace platform {
+
+// Small fixed-size pool of persistent worker threads used to run
+// collectors concurrently. Threads are created once and reused for every
+// sample, so a tick costs a queue push and a wakeup per collector.
+class CollectorPool {
+public:
+    explicit CollectorPool(size_t thread_count);
+    ~CollectorPool();
+
+    // Non-copyable
+    CollectorPool(const CollectorPool&) = delete;
+    CollectorPool& operator=(const CollectorPool&) = delete;
+
+    // Queue a task; it runs on the next idle worker
+    void submit(std::function<void()> task);
+
+    size_t threadCount() const { return threads_.size(); }
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> threads_;
+    std::deque<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable task_available_;
+    bool stopping_;
+};
+
+} // namespace platform
+} // namespace resmon
+
+#endif // RESMON_BACKEND_LINUX_COLLECTOR_POOL_H
@@ -1,170 +1,215 @@
 #include "cpu_linux.h"
+#include "proc_parse.h"
 
+#include <algorithm>
 #include <fstream>
-#include <sstream>
 #include <string>
 #include <dirent.h>
 #include <thread>
+#include <unistd.h>
+#include <utility>
 
 namespace resmon {
 namespace platform {
 
-CpuCollector::CpuCollector()
-    : prev_idle_time_(0)
-    , prev_total_time_(0)
+CpuCollector::CpuCollector(const std::string& root)
+    : root_(root)
+    , stat_file_(root + "/proc/stat")
     , has_previous_sample_(false)
+    , temp_sensor_(findTemperatureSensor())
+    , next_sensor_scan_(std::chrono::steady_clock::now() + SENSOR_RESCAN_INTERVAL)
 {
 }
 
+// Busy share of a line: everything but idle and iowait
+static float usageOf(const CpuModes& modes) {
+    float usage = modes.user + modes.nice + modes.system + modes.irq + modes.softirq +
+                  modes.steal + modes.guest;
+    return usage < 0.0f ? 0.0f : (usage > 100.0f ? 100.0f : usage);
+}
+
 CpuMetrics CpuCollector::collect() {
     CpuMetrics metrics;
     metrics.usage_percent = 0.0f;
     metrics.temperature_celsius = -1.0f;
-    metrics.core_count = getCoreCount();
-
-    uint64_t idle_time = 0;
-    uint64_t total_time = 0;
-
-    if (readCpuTimes(idle_time, total_time)) {
-        if (has_previous_sample_ && total_time > prev_total_time_) {
-            uint64_t idle_delta = idle_time - prev_idle_time_;
-            uint64_t total_delta = total_time - prev_total_time_;
-
-            if (total_delta > 0) {
-                // usage = 100 * (1 - (idle_delta / total_delta))
-                double idle_fraction = static_cast<double>(idle_delta) / static_cast<double>(total_delta);
-                metrics.usage_percent = static_cast<float>(100.0 * (1.0 - idle_fraction));
+    metrics.core_count = 0;
+
+    auto now = std::chrono::steady_clock::now();
+    if (stat_file_.read() && parseProcStat(stat_file_.contents(), current_)) {
+        // The cpuN lines of the (possibly fs_root) /proc/stat, so the count
+        // matches metrics.cores
+        metrics.core_count = static_cast<int>(current_.cpu_ids.size());
+        metrics.procs_running = static_cast<uint32_t>(current_.procs_running);
+        metrics.procs_blocked = static_cast<uint32_t>(current_.procs_blocked);
+
+        // After a CPU hotplug the lines no longer pair up; start over
+        if (has_previous_sample_ && current_.cpu_ids == previous_.cpu_ids) {
+            computeModes();
+            metrics.modes = modesOf(0);
+            metrics.usage_percent = usageOf(metrics.modes);
+
+            size_t cores = current_.cpu_ids.size();
+            metrics.cores.resize(cores);
+            for (size_t i = 0; i < cores; ++i) {
+                CpuCoreMetrics& core = metrics.cores[i];
+                core.id = current_.cpu_ids[i];
+                core.modes = modesOf(i + 1);
+                core.usage_percent = usageOf(core.modes);
+            }
 
-                // Clamp to valid range
-                if (metrics.usage_percent < 0.0f) metrics.usage_percent = 0.0f;
-                if (metrics.usage_percent > 100.0f) metrics.usage_percent = 100.0f;
+            double elapsed = std::chrono::duration<double>(now - previous_time_).count();
+            if (elapsed > 0.0 && current_.context_switches >= previous_.context_switches) {
+                metrics.context_switches_per_second = static_cast<float>(
+                    static_cast<double>(current_.context_switches - previous_.context_switches) / elapsed);
             }
         }
 
-        prev_idle_time_ = idle_time;
-        prev_total_time_ = total_time;
+        std::swap(current_, previous_);
+        previous_time_ = now;
         has_previous_sample_ = true;
     }
 
-    metrics.temperature_celsius = readTemperature();
+    if (metrics.core_count == 0) {
+        metrics.core_count = getCoreCount();
+    }
+    metrics.temperature_celsius = readTemperature(now);
 
     return metrics;
 }
 
-bool CpuCollector::readCpuTimes(uint64_t& idle_time, uint64_t& total_time) {
-    std::ifstream stat_file("/proc/stat");
-    if (!stat_file.is_open()) {
-        return false;
+void CpuCollector::computeModes() {
+    // Each step is a loop over contiguous arrays with no branches the
+    // compiler can't turn into selects, so they vectorize; with 192 CPUs
+    // this is a few hundred vector ops rather than a per-core struct walk
+    size_t lines = current_.lineCount();
+    scale_.assign(lines, 0.0f);
+    float* total = scale_.data();
+
+    for (size_t f = 0; f < CPU_FIELD_COUNT; ++f) {
+        percent_[f].resize(lines);
+        const uint64_t* now = current_.counters[f].data();
+        const uint64_t* before = previous_.counters[f].data();
+        float* delta = percent_[f].data();
+        // iowait can go backwards on some kernels; a decrease counts as 0
+        for (size_t i = 0; i < lines; ++i) {
+            delta[i] = now[i] > before[i] ? static_cast<float>(now[i] - before[i]) : 0.0f;
+        }
+        // Guest time is already part of user and nice
+        if (f < CPU_GUEST) {
+            for (size_t i = 0; i < lines; ++i) {
+                total[i] += delta[i];
+            }
+        }
     }
 
-    std::string line;
-    if (!std::getline(stat_file, line)) {
-        return false;
+    float* user = percent_[CPU_USER].data();
+    float* nice = percent_[CPU_NICE].data();
+    float* guest = percent_[CPU_GUEST].data();
+    float* guest_nice = percent_[CPU_GUEST_NICE].data();
+    for (size_t i = 0; i < lines; ++i) {
+        user[i] = std::max(user[i] - guest[i], 0.0f);
+        nice[i] = std::max(nice[i] - guest_nice[i], 0.0f);
+        guest[i] += guest_nice[i];
+        total[i] = total[i] > 0.0f ? 100.0f / total[i] : 0.0f;
     }
 
-    // /proc/stat first line: cpu user nice system idle iowait irq softirq steal
-    std::istringstream iss(line);
-    std::string cpu_label;
-    iss >> cpu_label;
-
-    if (cpu_label != "cpu") {
-        return false;
+    for (size_t f = 0; f < CPU_GUEST_NICE; ++f) {
+        float* percent = percent_[f].data();
+        for (size_t i = 0; i < lines; ++i) {
+            percent[i] *= total[i];
+        }
     }
+}
 
-    uint64_t user = 0, nice = 0, system = 0, idle = 0;
-    uint64_t iowait = 0, irq = 0, softirq = 0, steal = 0;
-
-    iss >> user >> nice >> system >> idle >> iowait >> irq >> softirq >> steal;
-
-    // idle_time = idle + iowait
-    idle_time = idle + iowait;
-
-    // total_time = user + nice + system + idle + iowait + irq + softirq + steal
-    total_time = user + nice + system + idle + iowait + irq + softirq + steal;
-
-    return true;
+CpuModes CpuCollector::modesOf(size_t line) const {
+    CpuModes modes;
+    modes.user = percent_[CPU_USER][line];
+    modes.nice = percent_[CPU_NICE][line];
+    modes.system = percent_[CPU_SYSTEM][line];
+    modes.iowait = percent_[CPU_IOWAIT][line];
+    modes.irq = percent_[CPU_IRQ][line];
+    modes.softirq = percent_[CPU_SOFTIRQ][line];
+    modes.steal = percent_[CPU_STEAL][line];
+    modes.guest = percent_[CPU_GUEST][line];
+    return modes;
 }
 
-float CpuCollector::readTemperature() {
+std::string CpuCollector::findTemperatureSensor() const {
     // Look for CPU temperature in /sys/class/hwmon
     // Common drivers: coretemp (Intel), k10temp (AMD)
 
-    DIR* hwmon_dir = opendir("/sys/class/hwmon");
-    if (!hwmon_dir) {
-        return -1.0f;
-    }
+    const std::string hwmon_root = root_ + "/sys/class/hwmon/";
+    DIR* hwmon_dir = opendir(hwmon_root.c_str());
+    if (hwmon_dir) {
+        struct dirent* entry;
+        while ((entry = readdir(hwmon_dir)) != nullptr) {
+            if (entry->d_name[0] == '.') {
+                continue;
+            }
 
-    struct dirent* entry;
-    while ((entry = readdir(hwmon_dir)) != nullptr) {
-        if (entry->d_name[0] == '.') {
-            continue;
-        }
+            std::string hwmon_path = hwmon_root;
+            hwmon_path += entry->d_name;
 
-        std::string hwmon_path = "/sys/class/hwmon/";
-        hwmon_path += entry->d_name;
+            // Check the name file to identify the sensor
+            std::string sensor_name = readFileString(hwmon_path + "/name");
 
-        // Check the name file to identify the sensor
-        std::string name_path = hwmon_path + "/name";
-        std::ifstream name_file(name_path);
-        if (!name_file.is_open()) {
-            continue;
-        }
+            // Look for CPU temperature sensors
+            if (sensor_name == "coretemp" || sensor_name == "k10temp" ||
+                sensor_name == "zenpower" || sensor_name == "cpu_thermal") {
 
-        std::string sensor_name;
-        std::getline(name_file, sensor_name);
-        name_file.close();
-
-        // Look for CPU temperature sensors
-        if (sensor_name == "coretemp" || sensor_name == "k10temp" ||
-            sensor_name == "zenpower" || sensor_name == "cpu_thermal") {
-
-            // Try temp1_input first (usually package/die temp)
-            std::string temp_path = hwmon_path + "/temp1_input";
-            std::ifstream temp_file(temp_path);
-            if (temp_file.is_open()) {
-                int temp_millidegrees = 0;
-                temp_file >> temp_millidegrees;
-                temp_file.close();
-                closedir(hwmon_dir);
-
-                // Convert from millidegrees to degrees
-                return static_cast<float>(temp_millidegrees) / 1000.0f;
+                // Try temp1_input first (usually package/die temp)
+                std::string temp_path = hwmon_path + "/temp1_input";
+                if (access(temp_path.c_str(), R_OK) == 0) {
+                    closedir(hwmon_dir);
+                    return temp_path;
+                }
             }
         }
-    }
 
-    closedir(hwmon_dir);
+        closedir(hwmon_dir);
+    }
 
     // Fallback: try thermal zones
     for (int i = 0; i < 10; ++i) {
-        std::string thermal_path = "/sys/class/thermal/thermal_zone" + std::to_string(i) + "/type";
-        std::ifstream type_file(thermal_path);
-        if (!type_file.is_open()) {
+        std::string zone_path = root_ + "/sys/class/thermal/thermal_zone" + std::to_string(i);
+        std::string zone_type = readFileString(zone_path + "/type");
+        if (zone_type.empty()) {
             continue;
         }
 
-        std::string zone_type;
-        std::getline(type_file, zone_type);
-        type_file.close();
-
         // Look for CPU-related thermal zones
         if (zone_type.find("cpu") != std::string::npos ||
             zone_type.find("x86") != std::string::npos ||
             zone_type.find("acpi") != std::string::npos) {
 
-            std::string temp_path = "/sys/class/thermal/thermal_zone" + std::to_string(i) + "/temp";
-            std::ifstream temp_file(temp_path);
-            if (temp_file.is_open()) {
-                int temp_millidegrees = 0;
-                temp_file >> temp_millidegrees;
-                temp_file.close();
-
-                return static_cast<float>(temp_millidegrees) / 1000.0f;
+            std::string temp_path = zone_path + "/temp";
+            if (access(temp_path.c_str(), R_OK) == 0) {
+                return temp_path;
             }
         }
     }
 
-    return -1.0f;
+    return "";
+}
+
+float CpuCollector::readTemperature(std::chrono::steady_clock::time_point now) {
+    int64_t temp_millidegrees = 0;
+    if (temp_sensor_.empty() || !temp_sensor_.readInt(temp_millidegrees)) {
+        // No sensor yet (a hwmon driver loaded later), or it went away or
+        // keeps failing (module reload, EIO from the chip). Discovery walks
+        // all of hwmon, so it is retried only now and then.
+        if (now < next_sensor_scan_) {
+            return -1.0f;
+        }
+        next_sensor_scan_ = now + SENSOR_RESCAN_INTERVAL;
+        temp_sensor_ = CachedFile(findTemperatureSensor());
+        if (temp_sensor_.empty() || !temp_sensor_.readInt(temp_millidegrees)) {
+            return -1.0f;
+        }
+    }
+
+    // Convert from millidegrees to degrees
+    return static_cast<float>(temp_millidegrees) / 1000.0f;
 }
 
 int CpuCollector::getCoreCount() {
@@ -2,29 +2,61 @@
 #define RESMON_BACKEND_LINUX_CPU_LINUX_H
 
 #include "../../core/metrics.h"
+#include "cached_file.h"
+#include "proc_parse.h"
+
+#include <chrono>
+#include <vector>
 
 namespace resmon {
 namespace platform {
 
 class CpuCollector {
 public:
-    CpuCollector();
+    // root: prefix for /proc and /sys (empty = the real filesystem)
+    explicit CpuCollector(const std::string& root = std::string());
+
+    // How often sensor discovery is retried while there is no working
+    // temperature sensor (none found, or reads keep failing)
+    static constexpr std::chrono::seconds SENSOR_RESCAN_INTERVAL{30};
 
     CpuMetrics collect();
 
 private:
-    // Previous sample values for calculating delta
-    uint64_t prev_idle_time_;
-    uint64_t prev_total_time_;
+    std::string root_;
+
+    // /proc/stat, kept open between samples
+    CachedFile stat_file_;
+
+    // Counters of this and the previous sample; swapped after each one
+    ProcStat current_;
+    ProcStat previous_;
     bool has_previous_sample_;
+    std::chrono::steady_clock::time_point previous_time_;
+
+    // Per-mode percentages of each /proc/stat cpu line (0 = aggregate),
+    // one array per CpuField, and each line's 100 / total ticks
+    std::vector<float> percent_[CPU_FIELD_COUNT];
+    std::vector<float> scale_;
+
+    // Resolved CPU temperature sensor; empty if none was found
+    CachedFile temp_sensor_;
+    std::chrono::steady_clock::time_point next_sensor_scan_;
+
+    // Fill percent_ from the counter deltas between previous_ and current_
+    void computeModes();
+
+    // Mode breakdown and usage of one cpu line from percent_
+    CpuModes modesOf(size_t line) const;
 
-    // Read /proc/stat and parse CPU times
-    // Returns false if failed to read
-    bool readCpuTimes(uint64_t& idle_time, uint64_t& total_time);
+    // Find the CPU temperature input in /sys/class/hwmon or thermal zones
+    // Returns an empty path if none was found
+    std::string findTemperatureSensor() const;
 
-    // Read CPU temperature from /sys/class/hwmon
+    // Read CPU temperature from the resolved sensor, rediscovering it at
+    // most once per SENSOR_RESCAN_INTERVAL while it fails
     // Returns -1 if not found
-    float readTemperature();
+    float readTemperature(std::chrono::steady_clock::time_point now);
 
     // Get CPU core count
     int getCoreCount();
@@ -0,0 +1,194 @@
+#include "disk_linux.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unistd.h>
+
+namespace resmon {
+namespace platform {
+
+DiskCollector::DiskCollector(const std::string& root)
+    : diskstats_(root + "/proc/diskstats")
+    , sys_block_(root + "/sys/block/")
+    , available_(false)
+    , has_previous_(false)
+{
+    available_ = diskstats_.read();
+}
+
+bool DiskCollector::isWholeDisk(std::string_view name) const {
+    std::string path = sys_block_;
+    path.append(name.data(), name.size());
+    path += "/device";
+    return access(path.c_str(), F_OK) == 0;
+}
+
+int32_t DiskCollector::lookup(uint32_t major, uint32_t minor, std::string_view name) {
+    // Devices listed before keep their classification, even if they moved
+    for (const Line& line : lines_) {
+        if (line.major == major && line.minor == minor) {
+            if (line.disk < 0) {
+                return -1;
+            }
+            if (disks_[static_cast<size_t>(line.disk)].name == name) {
+                return line.disk;
+            }
+            break;   // the number was reused by another disk
+        }
+    }
+
+    if (!isWholeDisk(name)) {
+        return -1;
+    }
+    int32_t index;
+    if (free_disks_.empty()) {
+        index = static_cast<int32_t>(disks_.size());
+        disks_.emplace_back();
+    } else {
+        index = free_disks_.back();
+        free_disks_.pop_back();
+    }
+    disks_[static_cast<size_t>(index)].name.assign(name.data(), name.size());
+    return index;
+}
+
+void DiskCollector::releaseUnused() {
+    for (Disk& disk : disks_) {
+        disk.referenced = false;
+    }
+    for (const Line& line : lines_) {
+        if (line.disk >= 0) {
+            disks_[static_cast<size_t>(line.disk)].referenced = true;
+        }
+    }
+    for (size_t i = 0; i < disks_.size(); ++i) {
+        if (!disks_[i].referenced && !disks_[i].name.empty()) {
+            disks_[i] = Disk();
+            free_disks_.push_back(static_cast<int32_t>(i));
+        }
+    }
+}
+
+void DiskCollector::sample(Disk& disk, const DiskStatCounters& counters, double elapsed_seconds,
+                           DiskMetrics& metrics) {
+    metrics.name = disk.name;
+    metrics.in_flight = static_cast<uint32_t>(counters.in_flight);
+
+    const DiskStatCounters& before = disk.previous;
+    if (disk.primed && elapsed_seconds > 0.0) {
+        // Counters only grow, except when a device number is reused or a
+        // 32-bit kernel wraps one; that interval reads as idle
+        auto delta = [](uint64_t now, uint64_t previous) { return now >= previous ? now - previous : 0; };
+        auto rate = [elapsed_seconds](uint64_t count) {
+            return static_cast<float>(static_cast<double>(count) / elapsed_seconds);
+        };
+        uint64_t reads = delta(counters.reads, before.reads);
+        uint64_t writes = delta(counters.writes, before.writes);
+        metrics.read_bytes_per_second = rate(delta(counters.read_sectors, before.read_sectors) * SECTOR_SIZE);
+        metrics.write_bytes_per_second = rate(delta(counters.write_sectors, before.write_sectors) * SECTOR_SIZE);
+        metrics.read_ops_per_second = rate(reads);
+        metrics.write_ops_per_second = rate(writes);
+
+        uint64_t requests = reads + writes;
+        if (requests > 0) {
+            uint64_t wait_ms = delta(counters.read_ms, before.read_ms) + delta(counters.write_ms, before.write_ms);
+            metrics.await_ms = static_cast<float>(static_cast<double>(wait_ms) / static_cast<double>(requests));
+        }
+
+        double elapsed_ms = elapsed_seconds * 1000.0;
+        double busy_ms = static_cast<double>(delta(counters.io_ms, before.io_ms));
+        metrics.utilization_percent = static_cast<float>(std::min(100.0, 100.0 * busy_ms / elapsed_ms));
+        metrics.queue_depth = static_cast<float>(
+            static_cast<double>(delta(counters.weighted_io_ms, before.weighted_io_ms)) / elapsed_ms);
+    }
+    disk.previous = counters;
+    disk.primed = true;
+}
+
+std::vector<DiskMetrics> DiskCollector::collect() {
+    std::vector<DiskMetrics> result;
+    if (!available_ || !diskstats_.read()) {
+        return result;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = has_previous_ ? std::chrono::duration<double>(now - previous_time_).count() : 0.0;
+    previous_time_ = now;
+    has_previous_ = true;
+
+    result.reserve(disks_.size() - free_disks_.size());
+    std::string_view contents = diskstats_.contents();
+    const char* p = contents.data();
+    const char* end = p + contents.size();
+    size_t index = 0;
+    bool changed = false;
+    while (p < end) {
+        const char* line_end = nextLine(p, end);
+        const Line* cached = !changed && index < lines_.size() ? &lines_[index] : nullptr;
+        int32_t disk = -1;
+        const char* counters_start = nullptr;
+
+        // Same device as on the previous read: one memcmp instead of
+        // parsing the numbers and the name
+        size_t head_length = cached ? cached->head_length : 0;
+        if (head_length > 0 && static_cast<size_t>(line_end - p) > head_length && p[head_length] == ' ' &&
+            std::memcmp(p, cached->head, head_length) == 0) {
+            disk = cached->disk;
+            counters_start = p + head_length;
+        } else {
+            uint32_t major = 0;
+            uint32_t minor = 0;
+            std::string_view name;
+            counters_start = parseDiskStatsDevice(p, line_end, major, minor, name);
+            if (!counters_start) {
+                p = line_end;
+                continue;
+            }
+            if (cached && head_length == 0 && cached->major == major && cached->minor == minor &&
+                (cached->disk < 0 || disks_[static_cast<size_t>(cached->disk)].name == name)) {
+                disk = cached->disk;   // unchanged, only too long to compare as text
+            } else {
+                // The list changed: keep the matching prefix, look up the rest
+                if (!changed) {
+                    next_lines_.assign(lines_.begin(), lines_.begin() + static_cast<std::ptrdiff_t>(index));
+                    changed = true;
+                }
+                disk = lookup(major, minor, name);
+            }
+            if (changed) {
+                Line line;
+                line.major = major;
+                line.minor = minor;
+                line.disk = disk;
+                size_t length = static_cast<size_t>(counters_start - p);
+                if (length <= MAX_HEAD) {
+                    std::memcpy(line.head, p, length);
+                    line.head_length = static_cast<uint8_t>(length);
+                }
+                next_lines_.push_back(line);
+            }
+        }
+        ++index;
+
+        DiskStatCounters counters;
+        if (disk >= 0 && parseDiskStatsCounters(counters_start, line_end, counters)) {
+            result.emplace_back();
+            sample(disks_[static_cast<size_t>(disk)], counters, elapsed, result.back());
+        }
+        p = line_end;
+    }
+
+    // Devices removed from the end leave the prefix intact
+    if (!changed && index != lines_.size()) {
+        next_lines_.assign(lines_.begin(), lines_.begin() + static_cast<std::ptrdiff_t>(index));
+        changed = true;
+    }
+    if (changed) {
+        lines_.swap(next_lines_);
+        releaseUnused();
+    }
+    return result;
+}
+
+} // namespace platform
+} // namespace resmon
@@ -0,0 +1,92 @@
+#ifndef RESMON_BACKEND_LINUX_DISK_LINUX_H
+#define RESMON_BACKEND_LINUX_DISK_LINUX_H
+
+#include "../../core/metrics.h"
+#include "cached_file.h"
+#include "proc_parse.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace resmon {
+namespace platform {
+
+// Throughput, IOPS, latency, utilization and queue depth of every whole
+// disk, from /proc/diskstats.
+//
+// Only devices in /sys/block with a "device" link are reported. That
+// drops partitions (which /sys/block does not list) and virtual devices
+// (loop, zram, device-mapper, md), whose I/O is counted again on the disks
+// below them. Classifying a device costs a sysfs lookup, so the outcome is
+// cached per line: the kernel lists devices in the same order on every
+// read, and a line that starts with the same text as the cached one (its
+// device number and name) is either parsed (a disk) or skipped to its
+// newline after one memcmp. Lines are parsed in full and new devices
+// classified only when the list changes (hotplug, a new dm target). The
+// file is parsed in place; nothing is allocated besides the returned
+// vector.
+class DiskCollector {
+public:
+    // Bytes per diskstats sector, whatever the device's own sector size
+    static constexpr uint64_t SECTOR_SIZE = 512;
+
+    // root: prefix for /proc and /sys (empty = the real filesystem)
+    explicit DiskCollector(const std::string& root = std::string());
+
+    // Rates cover the time since the previous collect (0 on the first one)
+    std::vector<DiskMetrics> collect();
+
+    // False if /proc/diskstats can't be read
+    bool isAvailable() const { return available_; }
+
+    // Lines of /proc/diskstats in the cached classification
+    size_t lineCount() const { return lines_.size(); }
+
+private:
+    // "major minor name" as printed (at most 4 + 1 + 7 + 1 + 32 characters)
+    static constexpr size_t MAX_HEAD = 48;
+
+    struct Line {
+        uint32_t major = 0;
+        uint32_t minor = 0;
+        int32_t disk = -1;       // index into disks_, -1 = not reported
+        uint8_t head_length = 0; // 0 = too long to cache, compared after parsing
+        char head[MAX_HEAD];     // the line up to the end of the name
+    };
+
+    struct Disk {
+        std::string name;        // empty = free slot
+        bool primed = false;     // previous holds a reading
+        bool referenced = false;
+        DiskStatCounters previous;
+    };
+
+    // Disk index for a device missing from the cached order, classifying
+    // it if it is new
+    int32_t lookup(uint32_t major, uint32_t minor, std::string_view name);
+    bool isWholeDisk(std::string_view name) const;
+    // Free the disks no line refers to any more
+    void releaseUnused();
+    void sample(Disk& disk, const DiskStatCounters& counters, double elapsed_seconds, DiskMetrics& metrics);
+
+    CachedFile diskstats_;
+    std::string sys_block_;      // <root>/sys/block/
+    bool available_;
+
+    std::vector<Line> lines_;
+    std::vector<Line> next_lines_;   // built while the list changes
+    std::vector<Disk> disks_;
+    std::vector<int32_t> free_disks_;
+
+    bool has_previous_;
+    std::chrono::steady_clock::time_point previous_time_;
+};
+
+} // namespace platform
+} // namespace resmon
+
+#endif // RESMON_BACKEND_LINUX_DISK_LINUX_H
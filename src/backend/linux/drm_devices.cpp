@@ -0,0 +1,187 @@
+#include "drm_devices.h"
+#include "cached_file.h"
+#include "proc_parse.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <dirent.h>
+#include <linux/netlink.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <utility>
+
+namespace resmon {
+namespace platform {
+
+// Large enough for any single uevent (the kernel caps them at 2 KiB of
+// environment plus the header)
+static constexpr size_t UEVENT_BUFFER_SIZE = 8192;
+
+static DrmVendor vendorFromId(const std::string& vendor_id) {
+    if (vendor_id == "0x1002") {
+        return DrmVendor::Amd;
+    }
+    if (vendor_id == "0x8086") {
+        return DrmVendor::Intel;
+    }
+    if (vendor_id == "0x10de") {
+        return DrmVendor::Nvidia;
+    }
+    return DrmVendor::Unknown;
+}
+
+// DRIVER and PCI_SLOT_NAME from the device's uevent file
+static void readDeviceUevent(DrmDevice& device) {
+    CachedFile uevent(device.device_path + "/uevent");
+    if (!uevent.read()) {
+        return;
+    }
+    std::string_view contents = uevent.contents();
+    const char* p = contents.data();
+    const char* end = p + contents.size();
+    while (p < end) {
+        const char* line_end = nextLine(p, end);
+        std::string_view line = trimValue(std::string_view(p, static_cast<size_t>(line_end - p)));
+        if (line.compare(0, 7, "DRIVER=") == 0) {
+            device.driver = std::string(line.substr(7));
+        } else if (line.compare(0, 14, "PCI_SLOT_NAME=") == 0) {
+            device.pci_address = std::string(line.substr(14));
+        }
+        p = line_end;
+    }
+}
+
+static uint64_t cardNumber(const std::string& card) {
+    uint64_t number = 0;
+    parseU64(card.data() + 4, card.data() + card.size(), number);
+    return number;
+}
+
+DrmDeviceEnumerator::DrmDeviceEnumerator(const std::string& root)
+    : drm_root_(root + "/sys/class/drm/")
+    , generation_(0)
+    , socket_(-1)
+    , rescan_pending_(false)
+{
+}
+
+DrmDeviceEnumerator::~DrmDeviceEnumerator() {
+    if (socket_ >= 0) {
+        close(socket_);
+    }
+}
+
+bool DrmDeviceEnumerator::scan() {
+    std::vector<DrmDevice> devices;
+
+    DIR* drm_dir = opendir(drm_root_.c_str());
+    if (drm_dir) {
+        struct dirent* entry;
+        while ((entry = readdir(drm_dir)) != nullptr) {
+            // card* entries, but not connectors like card0-HDMI-A-1
+            if (strncmp(entry->d_name, "card", 4) != 0 || strchr(entry->d_name + 4, '-') != nullptr) {
+                continue;
+            }
+
+            DrmDevice device;
+            device.card = entry->d_name;
+            device.device_path = drm_root_ + device.card + "/device";
+            device.vendor_id = readFileString(device.device_path + "/vendor");
+            device.vendor = vendorFromId(device.vendor_id);
+            readDeviceUevent(device);
+            devices.push_back(std::move(device));
+        }
+        closedir(drm_dir);
+    }
+
+    std::sort(devices.begin(), devices.end(), [](const DrmDevice& a, const DrmDevice& b) {
+        return cardNumber(a.card) < cardNumber(b.card);
+    });
+
+    if (devices == devices_) {
+        return false;
+    }
+    devices_ = std::move(devices);
+    ++generation_;
+    return true;
+}
+
+bool DrmDeviceEnumerator::listen() {
+    if (socket_ >= 0) {
+        return true;
+    }
+
+    int fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_KOBJECT_UEVENT);
+    if (fd < 0) {
+        return false;
+    }
+
+    // Group 1: events straight from the kernel (udevd rebroadcasts on 2)
+    struct sockaddr_nl address;
+    std::memset(&address, 0, sizeof(address));
+    address.nl_family = AF_NETLINK;
+    address.nl_groups = 1;
+    if (bind(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        return false;
+    }
+
+    socket_ = fd;
+    buffer_.resize(UEVENT_BUFFER_SIZE);
+    return true;
+}
+
+bool DrmDeviceEnumerator::isDrmUevent(const char* message, size_t length) {
+    // Header "ACTION@DEVPATH", then NUL-separated KEY=VALUE pairs
+    const char* p = static_cast<const char*>(std::memchr(message, '\0', length));
+    const char* end = message + length;
+    while (p && p < end) {
+        ++p;
+        size_t remaining = static_cast<size_t>(end - p);
+        const char* next = static_cast<const char*>(std::memchr(p, '\0', remaining));
+        size_t field = next ? static_cast<size_t>(next - p) : remaining;
+        if (field == 13 && std::memcmp(p, "SUBSYSTEM=drm", 13) == 0) {
+            return true;
+        }
+        p = next;
+    }
+    return false;
+}
+
+void DrmDeviceEnumerator::injectUevent(const char* message, size_t length) {
+    if (isDrmUevent(message, length)) {
+        rescan_pending_ = true;
+    }
+}
+
+bool DrmDeviceEnumerator::poll() {
+    if (socket_ >= 0) {
+        for (;;) {
+            ssize_t length = recv(socket_, buffer_.data(), buffer_.size(), MSG_DONTWAIT);
+            if (length > 0) {
+                if (isDrmUevent(buffer_.data(), static_cast<size_t>(length))) {
+                    rescan_pending_ = true;
+                }
+                continue;
+            }
+            if (length < 0 && errno == ENOBUFS) {
+                // The socket overflowed and events were lost; rescan to be safe
+                rescan_pending_ = true;
+                continue;
+            }
+            break;   // EAGAIN: drained
+        }
+    }
+
+    // A hotplug sends several events (card, render node, connectors), so
+    // they are coalesced into one rescan
+    if (!rescan_pending_) {
+        return false;
+    }
+    rescan_pending_ = false;
+    return scan();
+}
+
+} // namespace platform
+} // namespace resmon
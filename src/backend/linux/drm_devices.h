@@ -0,0 +1,87 @@
+#ifndef RESMON_BACKEND_LINUX_DRM_DEVICES_H
+#define RESMON_BACKEND_LINUX_DRM_DEVICES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace resmon {
+namespace platform {
+
+enum class DrmVendor {
+    Unknown,
+    Amd,
+    Intel,
+    Nvidia,
+};
+
+// A DRM card (/sys/class/drm/cardN) and the PCI device behind it
+struct DrmDevice {
+    std::string card;          // e.g. card0
+    std::string device_path;   // e.g. /sys/class/drm/card0/device
+    DrmVendor vendor = DrmVendor::Unknown;
+    std::string vendor_id;     // PCI vendor, e.g. 0x1002
+    std::string pci_address;   // PCI_SLOT_NAME, e.g. 0000:03:00.0; matches drm-pdev
+    std::string driver;        // DRIVER, e.g. amdgpu, i915, xe
+
+    bool operator==(const DrmDevice& other) const {
+        return card == other.card && vendor_id == other.vendor_id &&
+               pci_address == other.pci_address && driver == other.driver;
+    }
+};
+
+// Enumerates the DRM cards in one pass over /sys/class/drm and keeps the
+// list current: with listen(), kernel uevents for the drm subsystem
+// (NETLINK_KOBJECT_UEVENT) trigger a rescan, so GPUs that appear later
+// (eGPUs, VF passthrough, driver reloads) are picked up. Between events
+// poll() costs one non-blocking recv().
+class DrmDeviceEnumerator {
+public:
+    // root: prefix for /sys (empty = the real filesystem)
+    explicit DrmDeviceEnumerator(const std::string& root = std::string());
+    ~DrmDeviceEnumerator();
+
+    // Non-copyable (owns a socket)
+    DrmDeviceEnumerator(const DrmDeviceEnumerator&) = delete;
+    DrmDeviceEnumerator& operator=(const DrmDeviceEnumerator&) = delete;
+
+    // Walk /sys/class/drm; cards are ordered by number. Returns true if
+    // the device list changed.
+    bool scan();
+
+    // Subscribe to kernel uevents. Returns false if the socket cannot be
+    // opened (e.g. no netlink in a sandbox); the list then stays as last
+    // scanned.
+    bool listen();
+    bool listening() const { return socket_ >= 0; }
+
+    // Drain pending uevents (and injected ones) and rescan once if any was
+    // for the drm subsystem. Returns true if the device list changed.
+    bool poll();
+
+    // Queue a uevent in the kernel's wire format ("ACTION@DEVPATH\0KEY=VALUE\0...")
+    // as if it had arrived on the socket; handled by the next poll()
+    void injectUevent(const char* message, size_t length);
+
+    const std::vector<DrmDevice>& devices() const { return devices_; }
+
+    // Incremented whenever the device list changes
+    uint64_t generation() const { return generation_; }
+
+private:
+    static bool isDrmUevent(const char* message, size_t length);
+
+    std::string drm_root_;     // <root>/sys/class/drm/
+    std::vector<DrmDevice> devices_;
+    uint64_t generation_;
+
+    int socket_;
+    std::vector<char> buffer_;   // receive buffer, allocated by listen()
+    bool rescan_pending_;
+};
+
+} // namespace platform
+} // namespace resmon
+
+#endif // RESMON_BACKEND_LINUX_DRM_DEVICES_H
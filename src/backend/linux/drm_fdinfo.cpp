@@ -0,0 +1,414 @@
+#include "drm_fdinfo.h"
+#include "proc_parse.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <iterator>
+#include <unistd.h>
+#include <utility>
+
+namespace resmon {
+namespace platform {
+
+static bool startsWith(std::string_view s, std::string_view prefix) {
+    return s.size() >= prefix.size() && s.compare(0, prefix.size(), prefix) == 0;
+}
+
+static DrmEngine& engineNamed(DrmClient& client, std::string_view name) {
+    for (auto& engine : client.engines) {
+        if (engine.name == name) {
+            return engine;
+        }
+    }
+    client.engines.emplace_back();
+    client.engines.back().name = std::string(name);
+    return client.engines.back();
+}
+
+// Device-local memory regions: "vram", "vram0" (amdgpu, xe), "local0" (i915)
+static bool isVramRegion(std::string_view region) {
+    return startsWith(region, "vram") || startsWith(region, "local");
+}
+
+// "<n>", "<n> KiB" or "<n> MiB" in bytes
+static bool parseMemoryValue(const char* p, const char* end, uint64_t& bytes) {
+    p = parseU64(p, end, bytes);
+    if (!p) {
+        return false;
+    }
+    p = skipSpaces(p, end);
+    std::string_view unit = trimValue(std::string_view(p, static_cast<size_t>(end - p)));
+    if (unit == "KiB") {
+        bytes <<= 10;
+    } else if (unit == "MiB") {
+        bytes <<= 20;
+    } else if (unit == "GiB") {
+        bytes <<= 30;
+    }
+    return true;
+}
+
+bool parseDrmFdinfo(std::string_view contents, std::chrono::steady_clock::time_point now,
+                    DrmClient& client) {
+    const char* p = contents.data();
+    const char* end = p + contents.size();
+
+    for (auto& engine : client.engines) {
+        engine.seen = false;
+    }
+
+    bool is_drm = false;
+    uint64_t resident_vram = 0;
+    uint64_t legacy_vram = 0;
+    bool has_resident = false;
+
+    while (p < end) {
+        const char* line_end = nextLine(p, end);
+        const void* colon = std::memchr(p, ':', static_cast<size_t>(line_end - p));
+        if (!colon || line_end - p < 4 || std::memcmp(p, "drm-", 4) != 0) {
+            p = line_end;
+            continue;
+        }
+        const char* key_end = static_cast<const char*>(colon);
+        std::string_view key(p + 4, static_cast<size_t>(key_end - p - 4));
+        const char* value = key_end + 1;
+        uint64_t number = 0;
+
+        if (key == "client-id") {
+            if (parseU64(value, line_end, number)) {
+                client.client_id = number;
+                is_drm = true;
+            }
+        } else if (key == "pdev") {
+            const char* start = skipSpaces(value, line_end);
+            std::string_view pdev = trimValue(std::string_view(start, static_cast<size_t>(line_end - start)));
+            if (client.pdev != pdev) {
+                client.pdev = std::string(pdev);
+            }
+        } else if (startsWith(key, "engine-capacity-")) {
+            if (parseU64(value, line_end, number) && number > 0) {
+                engineNamed(client, key.substr(16)).capacity = static_cast<uint32_t>(number);
+            }
+        } else if (startsWith(key, "engine-")) {
+            if (parseU64(value, line_end, number)) {
+                DrmEngine& engine = engineNamed(client, key.substr(7));
+                engine.busy = number;
+                engine.seen = true;
+            }
+        } else if (startsWith(key, "cycles-")) {
+            if (parseU64(value, line_end, number)) {
+                DrmEngine& engine = engineNamed(client, key.substr(7));
+                engine.busy = number;
+                engine.seen = true;
+            }
+        } else if (startsWith(key, "total-cycles-")) {
+            if (parseU64(value, line_end, number)) {
+                engineNamed(client, key.substr(13)).total = number;
+            }
+        } else if (startsWith(key, "resident-")) {
+            if (isVramRegion(key.substr(9)) && parseMemoryValue(value, line_end, number)) {
+                resident_vram += number;
+                has_resident = true;
+            }
+        } else if (startsWith(key, "memory-")) {
+            // Older kernels: drm-memory-<region> is the resident size
+            if (isVramRegion(key.substr(7)) && parseMemoryValue(value, line_end, number)) {
+                legacy_vram += number;
+            }
+        }
+        p = line_end;
+    }
+
+    if (!is_drm) {
+        return false;
+    }
+    client.vram_bytes = has_resident ? resident_vram : legacy_vram;
+
+    // Busy rates: ns-based engines against wall time since the previous
+    // read, cycle-based ones against the GPU's own cycle count
+    double elapsed_ns = client.primed
+        ? static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - client.read_time).count())
+        : 0.0;
+    for (auto& engine : client.engines) {
+        engine.busy_percent = 0.0f;
+        if (!engine.seen) {
+            engine.has_previous = false;
+            continue;
+        }
+        if (engine.has_previous && engine.busy >= engine.previous_busy) {
+            double busy = static_cast<double>(engine.busy - engine.previous_busy);
+            double span = 0.0;
+            if (engine.total > 0) {
+                span = engine.total > engine.previous_total
+                    ? static_cast<double>(engine.total - engine.previous_total)
+                    : 0.0;
+            } else {
+                span = elapsed_ns;
+            }
+            if (span > 0.0) {
+                double percent = busy / span * 100.0 / engine.capacity;
+                engine.busy_percent = static_cast<float>(std::min(percent, 100.0));
+            }
+        }
+        engine.previous_busy = engine.busy;
+        engine.previous_total = engine.total;
+        engine.has_previous = true;
+    }
+    client.read_time = now;
+    client.primed = true;
+    return true;
+}
+
+DrmClientScanner::DrmClientScanner(const std::string& root)
+    : proc_root_(root + "/proc")
+    , recheck_cursor_(0)
+    , listed_once_(false)
+{
+}
+
+void DrmClientScanner::setDevices(std::vector<std::string> pdevs) {
+    devices_ = std::move(pdevs);
+    clients_.erase(std::remove_if(clients_.begin(), clients_.end(),
+                                  [this](const DrmClient& client) { return !tracking(client.pdev); }),
+                   clients_.end());
+}
+
+bool DrmClientScanner::tracking(const std::string& pdev) const {
+    return std::find(devices_.begin(), devices_.end(), pdev) != devices_.end();
+}
+
+bool DrmClientScanner::known(uint32_t pid, int fd) const {
+    for (const auto& client : clients_) {
+        if (client.pid == pid && client.fd == fd) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DrmClientScanner::duplicate(const DrmClient& client) const {
+    for (const auto& other : clients_) {
+        if (other.client_id == client.client_id && other.pdev == client.pdev) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void DrmClientScanner::listPids() {
+    listed_.clear();
+    DIR* dir = opendir(proc_root_.c_str());
+    if (!dir) {
+        return;
+    }
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        uint64_t pid = 0;
+        const char* name = entry->d_name;
+        const char* name_end = name + std::strlen(name);
+        if (parseU64(name, name_end, pid) == name_end) {
+            listed_.push_back(static_cast<uint32_t>(pid));
+        }
+    }
+    closedir(dir);
+
+    // procfs lists pids in order, but fixtures and other filesystems need not
+    if (!std::is_sorted(listed_.begin(), listed_.end())) {
+        std::sort(listed_.begin(), listed_.end());
+    }
+}
+
+void DrmClientScanner::update() {
+    if (devices_.empty()) {
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+
+    // Known clients: one pread each. A closed fd fails to read; a reused
+    // one is no longer DRM or carries another client id.
+    for (size_t i = 0; i < clients_.size();) {
+        DrmClient& client = clients_[i];
+        uint64_t client_id = client.client_id;
+        if (client.fdinfo.read() && parseDrmFdinfo(client.fdinfo.contents(), now, client) &&
+            client.client_id == client_id) {
+            ++i;
+            continue;
+        }
+        if (i + 1 < clients_.size()) {
+            clients_[i] = std::move(clients_.back());
+        }
+        clients_.pop_back();
+    }
+
+    // New pids are inspected right away, older ones a few at a time
+    listPids();
+    new_pids_.clear();
+    std::set_difference(listed_.begin(), listed_.end(), pids_.begin(), pids_.end(),
+                        std::back_inserter(new_pids_));
+    pids_.swap(listed_);
+
+    // Young pids that are still alive get another look until their grace
+    // period ends
+    young_pids_.erase(std::remove_if(young_pids_.begin(), young_pids_.end(),
+                                     [this, now](const YoungPid& young) {
+                                         return now - young.first_seen >= NEW_PID_GRACE ||
+                                                !std::binary_search(pids_.begin(), pids_.end(), young.pid);
+                                     }),
+                      young_pids_.end());
+    for (const YoungPid& young : young_pids_) {
+        inspectPid(young.pid, now);
+    }
+
+    for (uint32_t pid : new_pids_) {
+        inspectPid(pid, now);
+        // Everything running at the first update is old already
+        if (listed_once_) {
+            young_pids_.push_back(YoungPid{pid, now});
+        }
+    }
+    if (young_pids_.size() > MAX_YOUNG_PIDS) {
+        young_pids_.erase(young_pids_.begin(),
+                          young_pids_.end() - static_cast<std::ptrdiff_t>(MAX_YOUNG_PIDS));
+    }
+    listed_once_ = true;
+
+    size_t budget = std::min(RECHECK_PER_UPDATE, pids_.size());
+    for (size_t i = 0; i < budget; ++i) {
+        if (recheck_cursor_ >= pids_.size()) {
+            recheck_cursor_ = 0;
+        }
+        uint32_t pid = pids_[recheck_cursor_++];
+        if (!std::binary_search(new_pids_.begin(), new_pids_.end(), pid)) {
+            inspectPid(pid, now);
+        }
+    }
+}
+
+void DrmClientScanner::inspectPid(uint32_t pid, std::chrono::steady_clock::time_point now) {
+    // Paths are built in a reused buffer, so inspecting a pid with no new
+    // DRM files does not allocate
+    char pid_text[16];
+    char* pid_end = std::to_chars(pid_text, pid_text + sizeof(pid_text), pid).ptr;
+    path_.assign(proc_root_).append("/").append(pid_text, pid_end);
+    const size_t pid_path_length = path_.size();
+    path_.append("/fd");
+
+    DIR* dir = opendir(path_.c_str());
+    if (!dir) {
+        // Gone, or another user's process without CAP_SYS_PTRACE
+        return;
+    }
+
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        if (entry->d_name[0] < '0' || entry->d_name[0] > '9') {
+            continue;
+        }
+        char target[64];
+        ssize_t length = readlinkat(dirfd(dir), entry->d_name, target, sizeof(target) - 1);
+        if (length <= 0) {
+            continue;
+        }
+        target[length] = '\0';
+        if (std::strncmp(target, "/dev/dri/", 9) != 0) {
+            continue;
+        }
+
+        int fd = std::atoi(entry->d_name);
+        if (known(pid, fd)) {
+            continue;
+        }
+
+        DrmClient client;
+        client.pid = pid;
+        client.fd = fd;
+        path_.resize(pid_path_length);
+        client.fdinfo = CachedFile(path_ + "/fdinfo/" + entry->d_name);
+        if (!client.fdinfo.read() || !parseDrmFdinfo(client.fdinfo.contents(), now, client) ||
+            !tracking(client.pdev) || duplicate(client)) {
+            continue;
+        }
+
+        auto same_pid = std::find_if(clients_.begin(), clients_.end(),
+                                     [pid](const DrmClient& c) { return c.pid == pid; });
+        client.name = same_pid != clients_.end() ? same_pid->name : readFileString(path_ + "/comm");
+        clients_.push_back(std::move(client));
+    }
+    closedir(dir);
+}
+
+void DrmClientScanner::summarize(const std::string& pdev, GpuMetrics& metrics) {
+    auto& engines = metrics.engines;
+    auto& processes = metrics.processes;
+    engines.clear();
+    processes.clear();
+
+    auto engineIndex = [&engines](const std::string& name) {
+        for (size_t i = 0; i < engines.size(); ++i) {
+            if (engines[i].name == name) {
+                return i;
+            }
+        }
+        engines.push_back(GpuEngineUsage{name, 0.0f});
+        return engines.size() - 1;
+    };
+    auto processIndex = [&processes](const DrmClient& client) {
+        for (size_t i = 0; i < processes.size(); ++i) {
+            if (processes[i].pid == client.pid) {
+                return i;
+            }
+        }
+        GpuProcess process;
+        process.pid = client.pid;
+        process.name = client.name;
+        processes.push_back(process);
+        return processes.size() - 1;
+    };
+
+    for (const auto& client : clients_) {
+        if (client.pdev != pdev) {
+            continue;
+        }
+        processes[processIndex(client)].vram_bytes += client.vram_bytes;
+        for (const auto& engine : client.engines) {
+            engines[engineIndex(engine.name)].busy_percent += engine.busy_percent;
+        }
+    }
+    for (auto& engine : engines) {
+        engine.busy_percent = std::min(engine.busy_percent, 100.0f);
+    }
+
+    // A process's engines summed over its clients; its usage is the busiest
+    std::lock_guard<std::mutex> lock(summarize_mutex_);
+    const size_t engine_count = engines.size();
+    process_engines_.assign(processes.size() * engine_count, 0.0f);
+    for (const auto& client : clients_) {
+        if (client.pdev != pdev) {
+            continue;
+        }
+        size_t row = processIndex(client) * engine_count;
+        for (const auto& engine : client.engines) {
+            process_engines_[row + engineIndex(engine.name)] += engine.busy_percent;
+        }
+    }
+    for (size_t i = 0; i < processes.size(); ++i) {
+        float busiest = 0.0f;
+        for (size_t e = 0; e < engine_count; ++e) {
+            busiest = std::max(busiest, process_engines_[i * engine_count + e]);
+        }
+        processes[i].usage_percent = std::min(busiest, 100.0f);
+    }
+
+    std::sort(processes.begin(), processes.end(), [](const GpuProcess& a, const GpuProcess& b) {
+        if (a.vram_bytes != b.vram_bytes) {
+            return a.vram_bytes > b.vram_bytes;
+        }
+        return a.usage_percent > b.usage_percent;
+    });
+}
+
+} // namespace platform
+} // namespace resmon
@@ -0,0 +1,131 @@
+#ifndef RESMON_BACKEND_LINUX_DRM_FDINFO_H
+#define RESMON_BACKEND_LINUX_DRM_FDINFO_H
+
+#include "../../core/metrics.h"
+#include "cached_file.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace resmon {
+namespace platform {
+
+// Busy counters of one engine of a DRM client
+struct DrmEngine {
+    std::string name;           // as the driver calls it: render, video, gfx, rcs, ...
+    uint64_t busy = 0;          // drm-engine-<name> (ns) or drm-cycles-<name>
+    uint64_t total = 0;         // drm-total-cycles-<name>; 0 for ns-based engines
+    uint64_t previous_busy = 0;
+    uint64_t previous_total = 0;
+    uint32_t capacity = 1;      // drm-engine-capacity-<name>
+    float busy_percent = 0.0f;  // since the previous read, over all instances
+    bool seen = false;          // present in the latest read
+    bool has_previous = false;
+};
+
+// An open DRM file description of a process, as reported by
+// /proc/<pid>/fdinfo/<fd> (Documentation/gpu/drm-usage-stats.rst)
+struct DrmClient {
+    uint32_t pid = 0;
+    int fd = -1;
+    uint64_t client_id = 0;     // drm-client-id, unique per device
+    std::string pdev;           // drm-pdev, the device's PCI address
+    std::string name;           // command name of pid
+    CachedFile fdinfo;
+    std::vector<DrmEngine> engines;
+    uint64_t vram_bytes = 0;    // resident device-local memory
+    std::chrono::steady_clock::time_point read_time;
+    bool primed = false;        // engines hold counters from a previous read
+};
+
+// Parse a DRM fdinfo file into client: client id, pdev, engine counters
+// (updating busy_percent from the previous counters) and VRAM. Returns
+// false if it is not a DRM fdinfo.
+bool parseDrmFdinfo(std::string_view contents, std::chrono::steady_clock::time_point now,
+                    DrmClient& client);
+
+// Finds the DRM clients of a set of GPUs by scanning /proc/<pid>/fd and
+// tracks their engine usage and memory through fdinfo.
+//
+// The scan is incremental: pids already looked at are remembered, known
+// client fdinfo files stay open and are re-read with one pread() each, and
+// every update only lists /proc, inspects new pids, and re-inspects
+// RECHECK_PER_UPDATE older ones (round robin) for DRM files they opened
+// since. A program opens its GPU device a while after it starts (once its
+// runtime has loaded), so a new pid is also re-inspected on every update
+// for NEW_PID_GRACE; at most MAX_YOUNG_PIDS of the newest are, so a burst
+// of short-lived processes stays cheap. A client whose fd is closed or
+// reused is dropped on its next read. Clients are deduplicated by (pdev,
+// drm-client-id), so a file shared across fork() or dup() counts once.
+//
+// One scanner serves every DRM vendor collector (LinuxBackend owns it), so
+// /proc is walked once per sample however many GPUs of which vendors the
+// host has.
+//
+// Without CAP_SYS_PTRACE only the caller's own processes are visible.
+class DrmClientScanner {
+public:
+    static constexpr size_t RECHECK_PER_UPDATE = 32;
+    static constexpr std::chrono::seconds NEW_PID_GRACE{10};
+    static constexpr size_t MAX_YOUNG_PIDS = 128;
+
+    // root: prefix for /proc (empty = the real filesystem)
+    explicit DrmClientScanner(const std::string& root = std::string());
+
+    // Non-copyable
+    DrmClientScanner(const DrmClientScanner&) = delete;
+    DrmClientScanner& operator=(const DrmClientScanner&) = delete;
+
+    // Only clients of these PCI addresses are tracked; clients of other
+    // devices are dropped. With none, update() does nothing.
+    void setDevices(std::vector<std::string> pdevs);
+
+    // Rescan and re-read every client; once per sample
+    void update();
+
+    // Per-engine busy rates and the process table of one device. Engine
+    // rates are summed over clients; a process's usage_percent is its
+    // busiest engine. Several collectors may summarize at once, but not
+    // while setDevices() or update() runs.
+    void summarize(const std::string& pdev, GpuMetrics& metrics);
+
+    const std::vector<DrmClient>& clients() const { return clients_; }
+
+private:
+    // A pid that appeared after the first update, still in its grace period
+    struct YoungPid {
+        uint32_t pid;
+        std::chrono::steady_clock::time_point first_seen;
+    };
+
+    void listPids();
+    void inspectPid(uint32_t pid, std::chrono::steady_clock::time_point now);
+    bool tracking(const std::string& pdev) const;
+    bool known(uint32_t pid, int fd) const;
+    bool duplicate(const DrmClient& client) const;
+
+    std::string proc_root_;             // <root>/proc
+    std::string path_;                  // scratch, reused for per-pid paths
+    std::vector<std::string> devices_;
+
+    std::vector<uint32_t> pids_;        // sorted: live pids already inspected
+    std::vector<uint32_t> listed_;      // scratch: pids in /proc this update
+    std::vector<uint32_t> new_pids_;    // scratch
+    std::vector<YoungPid> young_pids_;  // oldest first
+    size_t recheck_cursor_;
+    bool listed_once_;
+
+    std::vector<DrmClient> clients_;
+    std::mutex summarize_mutex_;
+    std::vector<float> process_engines_;   // scratch for summarize(), under summarize_mutex_
+};
+
+} // namespace platform
+} // namespace resmon
+
+#endif // RESMON_BACKEND_LINUX_DRM_FDINFO_H
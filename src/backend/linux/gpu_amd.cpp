@@ -1,75 +1,48 @@
 #include "gpu_amd.h"
 
 #include <dirent.h>
-#include <fstream>
-#include <sstream>
 #include <cstring>
+#include <unistd.h>
+#include <utility>
 
 namespace resmon {
 namespace platform {
 
-// AMD vendor ID
-static constexpr const char* AMD_VENDOR_ID = "0x1002";
-
-AmdGpuCollector::AmdGpuCollector() {
-    scanForGpus();
+AmdGpuCollector::AmdGpuCollector(DrmClientScanner& clients)
+    : clients_(clients)
+{
 }
 
-void AmdGpuCollector::scanForGpus() {
+void AmdGpuCollector::setDevices(const std::vector<DrmDevice>& devices) {
     gpus_.clear();
 
-    DIR* drm_dir = opendir("/sys/class/drm");
-    if (!drm_dir) {
-        return;
-    }
-
-    struct dirent* entry;
-    while ((entry = readdir(drm_dir)) != nullptr) {
-        // Look for card* entries (not card*-*)
-        if (strncmp(entry->d_name, "card", 4) != 0) {
+    for (const auto& device : devices) {
+        if (device.vendor != DrmVendor::Amd) {
             continue;
         }
-        // Skip entries like card0-HDMI-A-1
-        if (strchr(entry->d_name + 4, '-') != nullptr) {
-            continue;
-        }
-
-        std::string card_path = "/sys/class/drm/";
-        card_path += entry->d_name;
-        std::string device_path = card_path + "/device";
 
-        // Check vendor ID
-        std::string vendor_path = device_path + "/vendor";
-        std::string vendor = readSysfsString(vendor_path);
-        if (vendor != AMD_VENDOR_ID) {
-            continue;
-        }
-
-        // Found an AMD GPU
         AmdGpuInfo info;
-        info.card_path = device_path;
+        info.card_path = device.device_path;
+        info.pdev = device.pci_address;
 
         // Try to get GPU name
-        std::string product_name = readSysfsString(device_path + "/product_name");
+        std::string product_name = readFileString(device.device_path + "/product_name");
         if (!product_name.empty()) {
             info.name = product_name;
         } else {
-            // Try device name from uevent or use default
             info.name = "AMD GPU";
         }
 
         // Set up paths for metrics
-        info.gpu_busy_path = device_path + "/gpu_busy_percent";
-        info.vram_used_path = device_path + "/mem_info_vram_used";
-        info.vram_total_path = device_path + "/mem_info_vram_total";
+        info.gpu_busy = CachedFile(device.device_path + "/gpu_busy_percent");
+        info.vram_used = CachedFile(device.device_path + "/mem_info_vram_used");
+        info.vram_total = CachedFile(device.device_path + "/mem_info_vram_total");
 
         // Find temperature path in hwmon
-        info.temp_path = findHwmonTempPath(device_path);
+        info.temp = CachedFile(findHwmonTempPath(device.device_path));
 
-        gpus_.push_back(info);
+        gpus_.push_back(std::move(info));
     }
-
-    closedir(drm_dir);
 }
 
 std::string AmdGpuCollector::findHwmonTempPath(const std::string& device_path) {
@@ -86,8 +59,7 @@ std::string AmdGpuCollector::findHwmonTempPath(const std::string& device_path) {
         if (strncmp(entry->d_name, "hwmon", 5) == 0) {
             temp_path = hwmon_dir + "/" + entry->d_name + "/temp1_input";
             // Check if file exists
-            std::ifstream test(temp_path);
-            if (test.good()) {
+            if (access(temp_path.c_str(), R_OK) == 0) {
                 closedir(dir);
                 return temp_path;
             }
@@ -98,46 +70,16 @@ std::string AmdGpuCollector::findHwmonTempPath(const std::string& device_path) {
     return "";
 }
 
-std::string AmdGpuCollector::readSysfsString(const std::string& path) {
-    std::ifstream file(path);
-    if (!file.is_open()) {
-        return "";
-    }
-
-    std::string value;
-    std::getline(file, value);
-
-    // Trim trailing whitespace/newlines
-    while (!value.empty() && (value.back() == '\n' || value.back() == '\r' || value.back() == ' ')) {
-        value.pop_back();
-    }
-
-    return value;
-}
-
-int64_t AmdGpuCollector::readSysfsInt(const std::string& path) {
-    std::string str = readSysfsString(path);
-    if (str.empty()) {
-        return -1;
-    }
-
-    try {
-        return std::stoll(str);
-    } catch (...) {
-        return -1;
-    }
-}
-
 std::vector<GpuMetrics> AmdGpuCollector::collect() {
     std::vector<GpuMetrics> results;
 
-    for (const auto& gpu : gpus_) {
+    for (auto& gpu : gpus_) {
         GpuMetrics metrics;
         metrics.name = gpu.name;
         metrics.vendor = "AMD";
 
         // Read GPU utilization (0-100)
-        int64_t busy = readSysfsInt(gpu.gpu_busy_path);
+        int64_t busy = gpu.gpu_busy.readInt();
         if (busy >= 0 && busy <= 100) {
             metrics.usage_percent = static_cast<float>(busy);
         } else {
@@ -145,8 +87,8 @@ std::vector<GpuMetrics> AmdGpuCollector::collect() {
         }
 
         // Read temperature (in millidegrees, divide by 1000)
-        if (!gpu.temp_path.empty()) {
-            int64_t temp = readSysfsInt(gpu.temp_path);
+        if (!gpu.temp.empty()) {
+            int64_t temp = gpu.temp.readInt();
             if (temp > 0) {
                 metrics.temperature_celsius = static_cast<float>(temp) / 1000.0f;
             } else {
@@ -157,8 +99,8 @@ std::vector<GpuMetrics> AmdGpuCollector::collect() {
         }
 
         // Read VRAM usage
-        int64_t vram_used = readSysfsInt(gpu.vram_used_path);
-        int64_t vram_total = readSysfsInt(gpu.vram_total_path);
+        int64_t vram_used = gpu.vram_used.readInt();
+        int64_t vram_total = gpu.vram_total.readInt();
 
         if (vram_used >= 0) {
             metrics.vram_used_bytes = static_cast<uint64_t>(vram_used);
@@ -172,7 +114,13 @@ std::vector<GpuMetrics> AmdGpuCollector::collect() {
             metrics.vram_total_bytes = 0;
         }
 
-        results.push_back(metrics);
+        // Per-engine and per-process usage from DRM fdinfo; the device-wide
+        // gpu_busy_percent above stays the utilization
+        if (!gpu.pdev.empty()) {
+            clients_.summarize(gpu.pdev, metrics);
+        }
+
+        results.push_back(std::move(metrics));
     }
 
     return results;
@@ -2,6 +2,9 @@
 #define RESMON_BACKEND_LINUX_GPU_AMD_H
 
 #include "../../core/metrics.h"
+#include "cached_file.h"
+#include "drm_devices.h"
+#include "drm_fdinfo.h"
 
 #include <string>
 #include <vector>
@@ -13,15 +16,19 @@ namespace platform {
 struct AmdGpuInfo {
     std::string card_path;           // e.g., /sys/class/drm/card0/device
     std::string name;
-    std::string gpu_busy_path;       // gpu_busy_percent
-    std::string temp_path;           // hwmon temperature
-    std::string vram_used_path;      // mem_info_vram_used
-    std::string vram_total_path;     // mem_info_vram_total
+    std::string pdev;                // PCI address, matches drm-pdev in fdinfo
+    CachedFile gpu_busy;             // gpu_busy_percent
+    CachedFile temp;                 // hwmon temperature
+    CachedFile vram_used;            // mem_info_vram_used
+    CachedFile vram_total;           // mem_info_vram_total
 };
 
 class AmdGpuCollector {
 public:
-    AmdGpuCollector();
+    // clients: the DRM client scanner shared with the other vendor
+    // collectors; the owner updates it before each collect(). GPUs are
+    // handed in by setDevices().
+    explicit AmdGpuCollector(DrmClientScanner& clients);
     ~AmdGpuCollector() = default;
 
     // Non-copyable
@@ -32,15 +39,17 @@ public:
     // Returns empty vector if no AMD GPUs found
     std::vector<GpuMetrics> collect();
 
+    // Take the AMD cards from an enumeration, replacing the current set.
+    // Not thread-safe against collect().
+    void setDevices(const std::vector<DrmDevice>& devices);
+
     // Check if any AMD GPUs were detected
     bool hasGpus() const { return !gpus_.empty(); }
 
 private:
-    void scanForGpus();
     std::string findHwmonTempPath(const std::string& device_path);
-    std::string readSysfsString(const std::string& path);
-    int64_t readSysfsInt(const std::string& path);
 
+    DrmClientScanner& clients_;
     std::vector<AmdGpuInfo> gpus_;
 };
 
@@ -1,62 +1,38 @@
 #include "gpu_intel.h"
 
+#include <algorithm>
 #include <dirent.h>
-#include <fstream>
-#include <sstream>
 #include <cstring>
+#include <unistd.h>
+#include <utility>
 
 namespace resmon {
 namespace platform {
 
-// Intel vendor ID
-static constexpr const char* INTEL_VENDOR_ID = "0x8086";
-
-IntelGpuCollector::IntelGpuCollector() {
-    scanForGpus();
+IntelGpuCollector::IntelGpuCollector(DrmClientScanner& clients)
+    : clients_(clients)
+{
 }
 
-void IntelGpuCollector::scanForGpus() {
+void IntelGpuCollector::setDevices(const std::vector<DrmDevice>& devices) {
     gpus_.clear();
 
-    DIR* drm_dir = opendir("/sys/class/drm");
-    if (!drm_dir) {
-        return;
-    }
-
-    struct dirent* entry;
-    while ((entry = readdir(drm_dir)) != nullptr) {
-        // Look for card* entries (not card*-*)
-        if (strncmp(entry->d_name, "card", 4) != 0) {
+    for (const auto& device : devices) {
+        if (device.vendor != DrmVendor::Intel) {
             continue;
         }
-        // Skip entries like card0-HDMI-A-1
-        if (strchr(entry->d_name + 4, '-') != nullptr) {
-            continue;
-        }
-
-        std::string card_path = "/sys/class/drm/";
-        card_path += entry->d_name;
-        std::string device_path = card_path + "/device";
 
-        // Check vendor ID
-        std::string vendor_path = device_path + "/vendor";
-        std::string vendor = readSysfsString(vendor_path);
-        if (vendor != INTEL_VENDOR_ID) {
-            continue;
-        }
-
-        // Found an Intel GPU
         IntelGpuInfo info;
-        info.card_path = device_path;
-        info.name = "Intel Graphics";
+        info.card_path = device.device_path;
+        info.pdev = device.pci_address;
+        // i915 and xe expose no marketing name in sysfs
+        info.name = device.driver == "xe" ? "Intel Graphics (xe)" : "Intel Graphics";
 
         // Find temperature path in hwmon if available
-        info.temp_path = findHwmonTempPath(device_path);
+        info.temp = CachedFile(findHwmonTempPath(device.device_path));
 
-        gpus_.push_back(info);
+        gpus_.push_back(std::move(info));
     }
-
-    closedir(drm_dir);
 }
 
 std::string IntelGpuCollector::findHwmonTempPath(const std::string& device_path) {
@@ -73,8 +49,7 @@ std::string IntelGpuCollector::findHwmonTempPath(const std::string& device_path)
         if (strncmp(entry->d_name, "hwmon", 5) == 0) {
             temp_path = hwmon_dir + "/" + entry->d_name + "/temp1_input";
             // Check if file exists
-            std::ifstream test(temp_path);
-            if (test.good()) {
+            if (access(temp_path.c_str(), R_OK) == 0) {
                 closedir(dir);
                 return temp_path;
             }
@@ -85,51 +60,27 @@ std::string IntelGpuCollector::findHwmonTempPath(const std::string& device_path)
     return "";
 }
 
-std::string IntelGpuCollector::readSysfsString(const std::string& path) {
-    std::ifstream file(path);
-    if (!file.is_open()) {
-        return "";
-    }
-
-    std::string value;
-    std::getline(file, value);
-
-    // Trim trailing whitespace/newlines
-    while (!value.empty() && (value.back() == '\n' || value.back() == '\r' || value.back() == ' ')) {
-        value.pop_back();
-    }
-
-    return value;
-}
-
-int64_t IntelGpuCollector::readSysfsInt(const std::string& path) {
-    std::string str = readSysfsString(path);
-    if (str.empty()) {
-        return -1;
-    }
-
-    try {
-        return std::stoll(str);
-    } catch (...) {
-        return -1;
-    }
-}
-
 std::vector<GpuMetrics> IntelGpuCollector::collect() {
     std::vector<GpuMetrics> results;
 
-    for (const auto& gpu : gpus_) {
+    for (auto& gpu : gpus_) {
         GpuMetrics metrics;
         metrics.name = gpu.name;
         metrics.vendor = "Intel";
 
-        // Intel iGPU utilization not easily available without perf counters
-        // Set to 0 as a placeholder
+        // Utilization is the busiest engine, summed over the DRM clients
+        // that are visible (all of them only with CAP_SYS_PTRACE)
         metrics.usage_percent = 0.0f;
+        if (!gpu.pdev.empty()) {
+            clients_.summarize(gpu.pdev, metrics);
+            for (const auto& engine : metrics.engines) {
+                metrics.usage_percent = std::max(metrics.usage_percent, engine.busy_percent);
+            }
+        }
 
         // Read temperature if hwmon is available (in millidegrees, divide by 1000)
-        if (!gpu.temp_path.empty()) {
-            int64_t temp = readSysfsInt(gpu.temp_path);
+        if (!gpu.temp.empty()) {
+            int64_t temp = gpu.temp.readInt();
             if (temp > 0) {
                 metrics.temperature_celsius = static_cast<float>(temp) / 1000.0f;
             } else {
@@ -143,7 +94,7 @@ std::vector<GpuMetrics> IntelGpuCollector::collect() {
         metrics.vram_used_bytes = 0;
         metrics.vram_total_bytes = 0;
 
-        results.push_back(metrics);
+        results.push_back(std::move(metrics));
     }
 
     return results;
@@ -2,6 +2,9 @@
 #define RESMON_BACKEND_LINUX_GPU_INTEL_H
 
 #include "../../core/metrics.h"
+#include "cached_file.h"
+#include "drm_devices.h"
+#include "drm_fdinfo.h"
 
 #include <string>
 #include <vector>
@@ -13,12 +16,16 @@ namespace platform {
 struct IntelGpuInfo {
     std::string card_path;     // e.g., /sys/class/drm/card0/device
     std::string name;
-    std::string temp_path;     // hwmon temperature if available
+    std::string pdev;                // PCI address, matches drm-pdev in fdinfo
+    CachedFile temp;           // hwmon temperature if available
 };
 
 class IntelGpuCollector {
 public:
-    IntelGpuCollector();
+    // clients: the DRM client scanner shared with the other vendor
+    // collectors; the owner updates it before each collect(). GPUs are
+    // handed in by setDevices().
+    explicit IntelGpuCollector(DrmClientScanner& clients);
     ~IntelGpuCollector() = default;
 
     // Non-copyable
@@ -29,15 +36,17 @@ public:
     // Returns empty vector if no Intel GPUs found
     std::vector<GpuMetrics> collect();
 
+    // Take the Intel cards from an enumeration, replacing the current set.
+    // Not thread-safe against collect().
+    void setDevices(const std::vector<DrmDevice>& devices);
+
     // Check if any Intel GPUs were detected
     bool hasGpus() const { return !gpus_.empty(); }
 
 private:
-    void scanForGpus();
     std::string findHwmonTempPath(const std::string& device_path);
-    std::string readSysfsString(const std::string& path);
-    int64_t readSysfsInt(const std::string& path);
 
+    DrmClientScanner& clients_;
     std::vector<IntelGpuInfo> gpus_;
 };
 
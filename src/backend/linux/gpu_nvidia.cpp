@@ -1,12 +1,19 @@
 #include "gpu_nvidia.h"
+#include "cached_file.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <dlfcn.h>
 #include <cstring>
+#include <utility>
 
 namespace resmon {
 namespace platform {
 
-NvidiaGpuCollector::NvidiaGpuCollector()
+// usedGpuMemory when the driver cannot attribute memory (e.g. under WDDM)
+static const unsigned long long NVML_VALUE_NOT_AVAILABLE = ~0ull;
+
+NvidiaGpuCollector::NvidiaGpuCollector(const std::string& library, const std::string& root)
     : nvml_handle_(nullptr)
     , nvml_available_(false)
     , nvml_initialized_(false)
@@ -15,23 +22,37 @@ NvidiaGpuCollector::NvidiaGpuCollector()
     , nvmlDeviceGetCount_v2_(nullptr)
     , nvmlDeviceGetHandleByIndex_v2_(nullptr)
     , nvmlDeviceGetName_(nullptr)
+    , nvmlDeviceGetUUID_(nullptr)
     , nvmlDeviceGetUtilizationRates_(nullptr)
     , nvmlDeviceGetTemperature_(nullptr)
     , nvmlDeviceGetMemoryInfo_(nullptr)
+    , nvmlDeviceGetComputeRunningProcesses_(nullptr)
+    , nvmlDeviceGetGraphicsRunningProcesses_(nullptr)
+    , process_info_size_(sizeof(nvmlProcessInfo_t))
+    , nvmlDeviceGetProcessUtilization_(nullptr)
+    , nvmlDeviceGetSamples_(nullptr)
+    , root_(root)
 {
-    nvml_available_ = loadNvml();
+    nvml_available_ = loadNvml(library);
+    if (nvml_available_) {
+        enumerateDevices();
+    }
 }
 
 NvidiaGpuCollector::~NvidiaGpuCollector() {
     unloadNvml();
 }
 
-bool NvidiaGpuCollector::loadNvml() {
+bool NvidiaGpuCollector::loadNvml(const std::string& library) {
     // Try to load NVML library
     // Try versioned library first, then unversioned
-    nvml_handle_ = dlopen("libnvidia-ml.so.1", RTLD_LAZY);
-    if (!nvml_handle_) {
-        nvml_handle_ = dlopen("libnvidia-ml.so", RTLD_LAZY);
+    if (!library.empty()) {
+        nvml_handle_ = dlopen(library.c_str(), RTLD_LAZY);
+    } else {
+        nvml_handle_ = dlopen("libnvidia-ml.so.1", RTLD_LAZY);
+        if (!nvml_handle_) {
+            nvml_handle_ = dlopen("libnvidia-ml.so", RTLD_LAZY);
+        }
     }
 
     if (!nvml_handle_) {
@@ -48,6 +69,23 @@ bool NvidiaGpuCollector::loadNvml() {
     nvmlDeviceGetUtilizationRates_ = reinterpret_cast<nvmlDeviceGetUtilizationRates_t>(dlsym(nvml_handle_, "nvmlDeviceGetUtilizationRates"));
     nvmlDeviceGetTemperature_ = reinterpret_cast<nvmlDeviceGetTemperature_t>(dlsym(nvml_handle_, "nvmlDeviceGetTemperature"));
     nvmlDeviceGetMemoryInfo_ = reinterpret_cast<nvmlDeviceGetMemoryInfo_t>(dlsym(nvml_handle_, "nvmlDeviceGetMemoryInfo"));
+    nvmlDeviceGetUUID_ = reinterpret_cast<nvmlDeviceGetUUID_t>(dlsym(nvml_handle_, "nvmlDeviceGetUUID"));
+
+    // Process table: _v3 (R510+) and _v2 share the extended entry layout,
+    // older drivers only have the original calls
+    static const char* const versions[] = {"_v3", "_v2", ""};
+    for (const char* version : versions) {
+        std::string compute = std::string("nvmlDeviceGetComputeRunningProcesses") + version;
+        std::string graphics = std::string("nvmlDeviceGetGraphicsRunningProcesses") + version;
+        nvmlDeviceGetComputeRunningProcesses_ = reinterpret_cast<nvmlDeviceGetRunningProcesses_t>(dlsym(nvml_handle_, compute.c_str()));
+        nvmlDeviceGetGraphicsRunningProcesses_ = reinterpret_cast<nvmlDeviceGetRunningProcesses_t>(dlsym(nvml_handle_, graphics.c_str()));
+        if (nvmlDeviceGetComputeRunningProcesses_ || nvmlDeviceGetGraphicsRunningProcesses_) {
+            process_info_size_ = version[0] ? sizeof(nvmlProcessInfo_t) : NVML_PROCESS_INFO_V1_SIZE;
+            break;
+        }
+    }
+    nvmlDeviceGetProcessUtilization_ = reinterpret_cast<nvmlDeviceGetProcessUtilization_t>(dlsym(nvml_handle_, "nvmlDeviceGetProcessUtilization"));
+    nvmlDeviceGetSamples_ = reinterpret_cast<nvmlDeviceGetSamples_t>(dlsym(nvml_handle_, "nvmlDeviceGetSamples"));
 
     // Check that all required functions were loaded
     if (!nvmlInit_v2_ || !nvmlShutdown_ || !nvmlDeviceGetCount_v2_ ||
@@ -83,74 +121,314 @@ void NvidiaGpuCollector::unloadNvml() {
     }
 
     nvml_available_ = false;
+    devices_.clear();
 }
 
-std::vector<GpuMetrics> NvidiaGpuCollector::collect() {
-    std::vector<GpuMetrics> gpus;
-
-    if (!nvml_available_ || !nvml_initialized_) {
-        return gpus;
-    }
+void NvidiaGpuCollector::enumerateDevices() {
+    devices_.clear();
 
-    // Get device count
     unsigned int device_count = 0;
-    nvmlReturn_t result = nvmlDeviceGetCount_v2_(&device_count);
-    if (result != NVML_SUCCESS || device_count == 0) {
-        return gpus;
+    if (nvmlDeviceGetCount_v2_(&device_count) != NVML_SUCCESS) {
+        return;
     }
 
-    // Collect metrics for each device
     for (unsigned int i = 0; i < device_count; ++i) {
-        nvmlDevice_t device;
-        result = nvmlDeviceGetHandleByIndex_v2_(i, &device);
-        if (result != NVML_SUCCESS) {
+        NvidiaDevice device;
+        if (nvmlDeviceGetHandleByIndex_v2_(i, &device.handle) != NVML_SUCCESS) {
             continue;
         }
 
+        char buffer[256];
+        std::memset(buffer, 0, sizeof(buffer));
+        if (nvmlDeviceGetName_(device.handle, buffer, sizeof(buffer) - 1) == NVML_SUCCESS) {
+            device.name = buffer;
+        } else {
+            device.name = "NVIDIA GPU";
+        }
+
+        std::memset(buffer, 0, sizeof(buffer));
+        if (nvmlDeviceGetUUID_ &&
+            nvmlDeviceGetUUID_(device.handle, buffer, NVML_DEVICE_UUID_BUFFER_SIZE) == NVML_SUCCESS) {
+            device.uuid = buffer;
+        }
+
+        // Total VRAM never changes; used VRAM is re-read every sample
+        nvmlMemory_t memory;
+        device.vram_total_bytes = 0;
+        if (nvmlDeviceGetMemoryInfo_(device.handle, &memory) == NVML_SUCCESS) {
+            device.vram_total_bytes = static_cast<uint64_t>(memory.total);
+        }
+
+        sizeSampleBuffer(device, NVML_GPU_UTILIZATION_SAMPLES, device.utilization_buffer);
+        sizeSampleBuffer(device, NVML_TOTAL_POWER_SAMPLES, device.power_buffer);
+
+        devices_.push_back(std::move(device));
+    }
+}
+
+std::vector<GpuMetrics> NvidiaGpuCollector::collect() {
+    std::vector<GpuMetrics> gpus;
+
+    if (!nvml_available_ || !nvml_initialized_) {
+        return gpus;
+    }
+
+    // Names of pids that left every GPU are dropped after this sample
+    previous_names_.swap(process_names_);
+    process_names_.clear();
+
+    gpus.reserve(devices_.size());
+    for (auto& device : devices_) {
         GpuMetrics metrics;
+        metrics.name = device.name;
         metrics.vendor = "NVIDIA";
         metrics.usage_percent = 0.0f;
         metrics.temperature_celsius = -1.0f;
         metrics.vram_used_bytes = 0;
-        metrics.vram_total_bytes = 0;
+        metrics.vram_total_bytes = device.vram_total_bytes;
 
-        // Get device name
-        char name_buffer[256];
-        std::memset(name_buffer, 0, sizeof(name_buffer));
-        result = nvmlDeviceGetName_(device, name_buffer, sizeof(name_buffer) - 1);
-        if (result == NVML_SUCCESS) {
-            metrics.name = name_buffer;
+        // Utilization: the mean of the driver's samples since the last call,
+        // or its own averaged reading if there are none
+        nvmlReturn_t result = NVML_SUCCESS;
+        if (readSamples(device, NVML_GPU_UTILIZATION_SAMPLES, device.utilization_buffer, 1.0f,
+                        metrics.utilization_samples)) {
+            float sum = 0.0f;
+            for (const auto& sample : metrics.utilization_samples) {
+                sum += sample.value;
+            }
+            metrics.usage_percent = sum / static_cast<float>(metrics.utilization_samples.size());
         } else {
-            metrics.name = "NVIDIA GPU";
+            nvmlUtilization_t utilization;
+            result = nvmlDeviceGetUtilizationRates_(device.handle, &utilization);
+            if (result == NVML_SUCCESS) {
+                metrics.usage_percent = static_cast<float>(utilization.gpu);
+            }
         }
 
-        // Get utilization rates
-        nvmlUtilization_t utilization;
-        result = nvmlDeviceGetUtilizationRates_(device, &utilization);
-        if (result == NVML_SUCCESS) {
-            metrics.usage_percent = static_cast<float>(utilization.gpu);
+        // Power samples are in milliwatts
+        if (readSamples(device, NVML_TOTAL_POWER_SAMPLES, device.power_buffer, 0.001f,
+                        metrics.power_samples)) {
+            device.power_watts = metrics.power_samples.back().value;
         }
+        metrics.power_watts = device.power_watts;
 
         // Get temperature
         unsigned int temp = 0;
-        result = nvmlDeviceGetTemperature_(device, NVML_TEMPERATURE_GPU, &temp);
+        result = nvmlDeviceGetTemperature_(device.handle, NVML_TEMPERATURE_GPU, &temp);
         if (result == NVML_SUCCESS) {
             metrics.temperature_celsius = static_cast<float>(temp);
         }
 
         // Get memory info
         nvmlMemory_t memory;
-        result = nvmlDeviceGetMemoryInfo_(device, &memory);
+        result = nvmlDeviceGetMemoryInfo_(device.handle, &memory);
         if (result == NVML_SUCCESS) {
             metrics.vram_used_bytes = static_cast<uint64_t>(memory.used);
-            metrics.vram_total_bytes = static_cast<uint64_t>(memory.total);
         }
 
-        gpus.push_back(metrics);
+        collectProcesses(device, metrics.processes);
+
+        gpus.push_back(std::move(metrics));
     }
 
     return gpus;
 }
 
+static float sampleValue(int type, const nvmlValue_t& value) {
+    switch (type) {
+        case NVML_VALUE_TYPE_DOUBLE:             return static_cast<float>(value.dVal);
+        case NVML_VALUE_TYPE_UNSIGNED_INT:       return static_cast<float>(value.uiVal);
+        case NVML_VALUE_TYPE_UNSIGNED_LONG:      return static_cast<float>(value.ulVal);
+        case NVML_VALUE_TYPE_UNSIGNED_LONG_LONG: return static_cast<float>(value.ullVal);
+        case NVML_VALUE_TYPE_SIGNED_LONG_LONG:   return static_cast<float>(value.sllVal);
+        case NVML_VALUE_TYPE_SIGNED_INT:         return static_cast<float>(value.siVal);
+        default:                                 return 0.0f;
+    }
+}
+
+void NvidiaGpuCollector::sizeSampleBuffer(const NvidiaDevice& device, int type, NvidiaSampleBuffer& buffer) {
+    if (!nvmlDeviceGetSamples_) {
+        return;
+    }
+    // With no buffer, the call reports how many samples the driver keeps
+    int value_type = 0;
+    unsigned int count = 0;
+    nvmlReturn_t result = nvmlDeviceGetSamples_(device.handle, type, 0, &value_type, &count, nullptr);
+    if ((result == NVML_SUCCESS || result == NVML_ERROR_INSUFFICIENT_SIZE) && count > 0) {
+        buffer.samples.resize(count);
+    }
+}
+
+bool NvidiaGpuCollector::readSamples(const NvidiaDevice& device, int type, NvidiaSampleBuffer& buffer,
+                                     float scale, std::vector<GpuSample>& out) {
+    if (!nvmlDeviceGetSamples_ || buffer.samples.empty()) {
+        return false;
+    }
+
+    // NVML_ERROR_NOT_FOUND means no samples newer than last_timestamp
+    int value_type = 0;
+    unsigned int count = static_cast<unsigned int>(buffer.samples.size());
+    nvmlReturn_t result = nvmlDeviceGetSamples_(device.handle, type, buffer.last_timestamp,
+                                                &value_type, &count, buffer.samples.data());
+    if (result != NVML_SUCCESS) {
+        return false;
+    }
+
+    size_t first = out.size();
+    count = std::min(count, static_cast<unsigned int>(buffer.samples.size()));
+    for (unsigned int i = 0; i < count; ++i) {
+        const nvmlSample_t& sample = buffer.samples[i];
+        if (sample.timeStamp <= buffer.last_timestamp) {
+            continue;
+        }
+        out.push_back(GpuSample{static_cast<uint64_t>(sample.timeStamp),
+                                sampleValue(value_type, sample.sampleValue) * scale});
+    }
+    if (out.size() == first) {
+        return false;
+    }
+
+    // The driver's ring is not documented to come back in order
+    auto by_time = [](const GpuSample& a, const GpuSample& b) { return a.timestamp_us < b.timestamp_us; };
+    if (!std::is_sorted(out.begin() + first, out.end(), by_time)) {
+        std::sort(out.begin() + first, out.end(), by_time);
+    }
+    buffer.last_timestamp = out.back().timestamp_us;
+    return true;
+}
+
+void NvidiaGpuCollector::collectProcesses(NvidiaDevice& device, std::vector<GpuProcess>& processes) {
+    if (nvmlDeviceGetComputeRunningProcesses_) {
+        queryRunningProcesses(device, nvmlDeviceGetComputeRunningProcesses_, false, processes);
+    }
+    if (nvmlDeviceGetGraphicsRunningProcesses_) {
+        queryRunningProcesses(device, nvmlDeviceGetGraphicsRunningProcesses_, true, processes);
+    }
+    if (processes.empty()) {
+        return;
+    }
+
+    queryProcessUtilization(device, processes);
+
+    for (auto& process : processes) {
+        process.name = processName(process.pid);
+    }
+    std::sort(processes.begin(), processes.end(), [](const GpuProcess& a, const GpuProcess& b) {
+        return a.vram_bytes > b.vram_bytes;
+    });
+}
+
+void NvidiaGpuCollector::queryRunningProcesses(NvidiaDevice& device, nvmlDeviceGetRunningProcesses_t query,
+                                               bool graphics, std::vector<GpuProcess>& processes) {
+    auto& buffer = device.process_buffer;
+    unsigned int capacity = static_cast<unsigned int>(buffer.size() / process_info_size_);
+    unsigned int count = capacity;
+    nvmlReturn_t result = query(device.handle, &count, buffer.empty() ? nullptr : buffer.data());
+    // Some drivers answer a query that does not fit (or has no buffer)
+    // with SUCCESS and the count needed rather than INSUFFICIENT_SIZE
+    if (result == NVML_ERROR_INSUFFICIENT_SIZE || (result == NVML_SUCCESS && count > capacity)) {
+        // count is the number needed; leave room for processes starting
+        // between the two calls
+        buffer.resize((count + 8) * process_info_size_);
+        capacity = static_cast<unsigned int>(buffer.size() / process_info_size_);
+        count = capacity;
+        result = query(device.handle, &count, buffer.data());
+    }
+    if (result != NVML_SUCCESS) {
+        return;
+    }
+    count = std::min(count, capacity);
+
+    for (unsigned int i = 0; i < count; ++i) {
+        // pid and usedGpuMemory sit at the same offsets in every version
+        const unsigned char* entry = buffer.data() + i * process_info_size_;
+        unsigned int pid = 0;
+        unsigned long long used = 0;
+        std::memcpy(&pid, entry + offsetof(nvmlProcessInfo_t, pid), sizeof(pid));
+        std::memcpy(&used, entry + offsetof(nvmlProcessInfo_t, usedGpuMemory), sizeof(used));
+
+        auto it = std::find_if(processes.begin(), processes.end(),
+                               [pid](const GpuProcess& p) { return p.pid == pid; });
+        if (it == processes.end()) {
+            GpuProcess process;
+            process.pid = pid;
+            processes.push_back(process);
+            it = processes.end() - 1;
+        }
+        if (used != NVML_VALUE_NOT_AVAILABLE) {
+            it->vram_bytes = std::max(it->vram_bytes, static_cast<uint64_t>(used));
+        }
+        if (graphics) {
+            it->graphics = true;
+        } else {
+            it->compute = true;
+        }
+    }
+}
+
+void NvidiaGpuCollector::queryProcessUtilization(NvidiaDevice& device, std::vector<GpuProcess>& processes) {
+    if (!nvmlDeviceGetProcessUtilization_) {
+        return;
+    }
+
+    // Only samples newer than the last one seen are returned, so each
+    // process's SM% covers exactly the time since the previous sample
+    auto& samples = device.utilization_samples;
+    unsigned int count = static_cast<unsigned int>(samples.size());
+    nvmlReturn_t result = nvmlDeviceGetProcessUtilization_(
+        device.handle, samples.empty() ? nullptr : samples.data(), &count, device.last_utilization_timestamp);
+    // As for the process lists, a size answer can come back as SUCCESS
+    if (result == NVML_ERROR_INSUFFICIENT_SIZE || (result == NVML_SUCCESS && count > samples.size())) {
+        samples.resize(count + 8);
+        count = static_cast<unsigned int>(samples.size());
+        result = nvmlDeviceGetProcessUtilization_(
+            device.handle, samples.data(), &count, device.last_utilization_timestamp);
+    }
+
+    if (result == NVML_ERROR_NOT_FOUND) {
+        // No new samples: nothing ran on the SMs since the last call
+        for (auto& process : processes) {
+            process.usage_percent = 0.0f;
+        }
+        return;
+    }
+    if (result != NVML_SUCCESS) {
+        return;
+    }
+    count = std::min(count, static_cast<unsigned int>(samples.size()));
+
+    for (auto& process : processes) {
+        unsigned int sum = 0;
+        unsigned int n = 0;
+        for (unsigned int i = 0; i < count; ++i) {
+            if (samples[i].pid == process.pid) {
+                sum += samples[i].smUtil;
+                ++n;
+            }
+        }
+        process.usage_percent = n > 0 ? std::min(100.0f, static_cast<float>(sum) / n) : 0.0f;
+    }
+    for (unsigned int i = 0; i < count; ++i) {
+        device.last_utilization_timestamp = std::max(device.last_utilization_timestamp, samples[i].timeStamp);
+    }
+}
+
+const std::string& NvidiaGpuCollector::processName(uint32_t pid) {
+    auto it = process_names_.find(pid);
+    if (it != process_names_.end()) {
+        return it->second;
+    }
+
+    // Carry the name over from the previous sample without re-reading it
+    auto node = previous_names_.extract(pid);
+    if (!node.empty()) {
+        return process_names_.insert(std::move(node)).position->second;
+    }
+
+    // Empty for pids in another pid namespace (e.g. a container)
+    std::string name = readFileString(root_ + "/proc/" + std::to_string(pid) + "/comm");
+    return process_names_.emplace(pid, std::move(name)).first->second;
+}
+
 } // namespace platform
 } // namespace resmon
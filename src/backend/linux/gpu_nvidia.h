@@ -3,7 +3,9 @@
 
 #include "../../core/metrics.h"
 
+#include <cstddef>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace resmon {
@@ -15,6 +17,21 @@ typedef int nvmlReturn_t;
 
 #define NVML_SUCCESS 0
 #define NVML_TEMPERATURE_GPU 0
+#define NVML_ERROR_NOT_FOUND 6
+#define NVML_ERROR_INSUFFICIENT_SIZE 7
+#define NVML_DEVICE_UUID_BUFFER_SIZE 80
+
+// nvmlSamplingType_t
+#define NVML_TOTAL_POWER_SAMPLES 0
+#define NVML_GPU_UTILIZATION_SAMPLES 1
+
+// nvmlValueType_t
+#define NVML_VALUE_TYPE_DOUBLE 0
+#define NVML_VALUE_TYPE_UNSIGNED_INT 1
+#define NVML_VALUE_TYPE_UNSIGNED_LONG 2
+#define NVML_VALUE_TYPE_UNSIGNED_LONG_LONG 3
+#define NVML_VALUE_TYPE_SIGNED_LONG_LONG 4
+#define NVML_VALUE_TYPE_SIGNED_INT 5
 
 struct nvmlUtilization_t {
     unsigned int gpu;
@@ -27,36 +44,133 @@ struct nvmlMemory_t {
     unsigned long long used;
 };
 
+// Running-process entry. The v2/v3 calls fill this layout; the original
+// (v1) calls fill only pid and usedGpuMemory, 16 bytes per entry. Both
+// layouts put those two fields at the same offsets.
+struct nvmlProcessInfo_t {
+    unsigned int pid;
+    unsigned long long usedGpuMemory;
+    unsigned int gpuInstanceId;
+    unsigned int computeInstanceId;
+};
+
+#define NVML_PROCESS_INFO_V1_SIZE 16
+
+struct nvmlProcessUtilizationSample_t {
+    unsigned int pid;
+    unsigned long long timeStamp;   // CPU timestamp in microseconds
+    unsigned int smUtil;
+    unsigned int memUtil;
+    unsigned int encUtil;
+    unsigned int decUtil;
+};
+
+union nvmlValue_t {
+    double dVal;
+    int siVal;
+    unsigned int uiVal;
+    unsigned long ulVal;
+    unsigned long long ullVal;
+    signed long long sllVal;
+};
+
+struct nvmlSample_t {
+    unsigned long long timeStamp;   // CPU timestamp in microseconds
+    nvmlValue_t sampleValue;
+};
+
 // Function pointer types for NVML functions
 typedef nvmlReturn_t (*nvmlInit_v2_t)(void);
 typedef nvmlReturn_t (*nvmlShutdown_t)(void);
 typedef nvmlReturn_t (*nvmlDeviceGetCount_v2_t)(unsigned int* deviceCount);
 typedef nvmlReturn_t (*nvmlDeviceGetHandleByIndex_v2_t)(unsigned int index, nvmlDevice_t* device);
 typedef nvmlReturn_t (*nvmlDeviceGetName_t)(nvmlDevice_t device, char* name, unsigned int length);
+typedef nvmlReturn_t (*nvmlDeviceGetUUID_t)(nvmlDevice_t device, char* uuid, unsigned int length);
 typedef nvmlReturn_t (*nvmlDeviceGetUtilizationRates_t)(nvmlDevice_t device, nvmlUtilization_t* utilization);
 typedef nvmlReturn_t (*nvmlDeviceGetTemperature_t)(nvmlDevice_t device, int sensorType, unsigned int* temp);
 typedef nvmlReturn_t (*nvmlDeviceGetMemoryInfo_t)(nvmlDevice_t device, nvmlMemory_t* memory);
+typedef nvmlReturn_t (*nvmlDeviceGetRunningProcesses_t)(nvmlDevice_t device, unsigned int* infoCount, void* infos);
+typedef nvmlReturn_t (*nvmlDeviceGetProcessUtilization_t)(nvmlDevice_t device,
+    nvmlProcessUtilizationSample_t* utilization, unsigned int* processSamplesCount,
+    unsigned long long lastSeenTimeStamp);
+typedef nvmlReturn_t (*nvmlDeviceGetSamples_t)(nvmlDevice_t device, int type,
+    unsigned long long lastSeenTimeStamp, int* sampleValType, unsigned int* sampleCount,
+    nvmlSample_t* samples);
+
+// One of the driver's sample buffers, read incrementally
+struct NvidiaSampleBuffer {
+    std::vector<nvmlSample_t> samples;        // sized to the driver's buffer; empty = unsupported
+    unsigned long long last_timestamp = 0;    // newest sample already returned
+};
+
+// A device and its static properties, resolved once when NVML is loaded
+struct NvidiaDevice {
+    nvmlDevice_t handle;
+    std::string name;
+    std::string uuid;
+    uint64_t vram_total_bytes;
+
+    // Per-process state, reused between samples
+    std::vector<unsigned char> process_buffer;    // running-process entries
+    std::vector<nvmlProcessUtilizationSample_t> utilization_samples;
+    unsigned long long last_utilization_timestamp = 0;
+
+    // Driver sample buffers (utilization ~6/s, power up to ~50/s)
+    NvidiaSampleBuffer utilization_buffer;
+    NvidiaSampleBuffer power_buffer;
+    float power_watts = -1.0f;                // newest power sample
+};
 
 class NvidiaGpuCollector {
 public:
-    NvidiaGpuCollector();
+    // library: NVML to load (e.g. a stub); empty = libnvidia-ml.so.1
+    // root: prefix for /proc, where process names are looked up
+    explicit NvidiaGpuCollector(const std::string& library = std::string(),
+                                const std::string& root = std::string());
     ~NvidiaGpuCollector();
 
     // Non-copyable
     NvidiaGpuCollector(const NvidiaGpuCollector&) = delete;
     NvidiaGpuCollector& operator=(const NvidiaGpuCollector&) = delete;
 
-    // Collect metrics from all NVIDIA GPUs
-    // Returns empty vector if NVML is not available
+    // Collect metrics from all NVIDIA GPUs: per device, the utilization
+    // and power samples the driver took since the previous call, plus
+    // temperature and memory, plus up to three calls for the process table
+    // (compute and graphics processes, per-process utilization). Usage is
+    // the mean of the new utilization samples, or a single reading where
+    // sample buffers are unsupported or empty.
+    // Devices are enumerated once in the constructor. Returns empty vector
+    // if NVML is not available.
     std::vector<GpuMetrics> collect();
 
     // Check if NVML is available
     bool isAvailable() const { return nvml_available_; }
 
 private:
-    bool loadNvml();
+    bool loadNvml(const std::string& library);
     void unloadNvml();
 
+    // Resolve handles, names, UUIDs and total VRAM of every device
+    void enumerateDevices();
+
+    // Size a sample buffer to what the driver keeps, or leave it empty if
+    // the sampling type is unsupported
+    void sizeSampleBuffer(const NvidiaDevice& device, int type, NvidiaSampleBuffer& buffer);
+
+    // Append the samples newer than buffer.last_timestamp to out, with
+    // values multiplied by scale. Returns false if there were none.
+    bool readSamples(const NvidiaDevice& device, int type, NvidiaSampleBuffer& buffer,
+                     float scale, std::vector<GpuSample>& out);
+
+    // Fill the process table of one device
+    void collectProcesses(NvidiaDevice& device, std::vector<GpuProcess>& processes);
+    void queryRunningProcesses(NvidiaDevice& device, nvmlDeviceGetRunningProcesses_t query,
+                               bool graphics, std::vector<GpuProcess>& processes);
+    void queryProcessUtilization(NvidiaDevice& device, std::vector<GpuProcess>& processes);
+
+    // Command name of a pid, cached while the pid stays on a GPU
+    const std::string& processName(uint32_t pid);
+
     void* nvml_handle_;
     bool nvml_available_;
     bool nvml_initialized_;
@@ -67,9 +181,24 @@ private:
     nvmlDeviceGetCount_v2_t nvmlDeviceGetCount_v2_;
     nvmlDeviceGetHandleByIndex_v2_t nvmlDeviceGetHandleByIndex_v2_;
     nvmlDeviceGetName_t nvmlDeviceGetName_;
+    nvmlDeviceGetUUID_t nvmlDeviceGetUUID_;     // optional
     nvmlDeviceGetUtilizationRates_t nvmlDeviceGetUtilizationRates_;
     nvmlDeviceGetTemperature_t nvmlDeviceGetTemperature_;
     nvmlDeviceGetMemoryInfo_t nvmlDeviceGetMemoryInfo_;
+
+    // Optional: process table. The newest available version of the
+    // running-process calls is used; process_info_size_ is its entry size.
+    nvmlDeviceGetRunningProcesses_t nvmlDeviceGetComputeRunningProcesses_;
+    nvmlDeviceGetRunningProcesses_t nvmlDeviceGetGraphicsRunningProcesses_;
+    size_t process_info_size_;
+    nvmlDeviceGetProcessUtilization_t nvmlDeviceGetProcessUtilization_;
+    nvmlDeviceGetSamples_t nvmlDeviceGetSamples_;   // optional
+
+    std::vector<NvidiaDevice> devices_;
+
+    std::string root_;
+    std::unordered_map<uint32_t, std::string> process_names_;
+    std::unordered_map<uint32_t, std::string> previous_names_;
 };
 
 } // namespace platform
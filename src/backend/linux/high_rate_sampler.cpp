@@ -0,0 +1,154 @@
+#include "high_rate_sampler.h"
+#include "proc_parse.h"
+
+#include <algorithm>
+#include <ctime>
+#include <unistd.h>
+
+namespace resmon {
+namespace platform {
+
+static int64_t nowMicros() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void sleepUntilMicros(int64_t deadline_us) {
+    timespec ts;
+    ts.tv_sec = static_cast<time_t>(deadline_us / 1000000);
+    ts.tv_nsec = static_cast<long>((deadline_us % 1000000) * 1000);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) != 0) {
+        // Interrupted by a signal: keep waiting for the same deadline
+    }
+}
+
+static int64_t threadCpuMicros() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+HighRateSampler::HighRateSampler(size_t capacity, const std::string& root)
+    : stat_file_(root + "/proc/stat")
+    , meminfo_file_(root + "/proc/meminfo")
+    , capacity_(capacity)
+    , window_start_(0)
+{
+    samples_.reserve(capacity_);
+}
+
+bool HighRateSampler::readSample(HighRateSample& sample) {
+    CpuTimes times;
+    if (!stat_file_.read() || !parseProcStatCpu(stat_file_.contents(), times)) {
+        return false;
+    }
+    sample.idle_jiffies = times.idleTime();
+    sample.total_jiffies = times.totalTime();
+
+    sample.ram_percent = 0.0f;
+    if (meminfo_file_.read()) {
+        MemInfo info = parseMemInfo(meminfo_file_.contents());
+        uint64_t available_kb = info.has_mem_available
+            ? info.mem_available_kb
+            : info.mem_free_kb + info.buffers_kb + info.cached_kb;
+        if (info.mem_total_kb > available_kb) {
+            sample.ram_percent = static_cast<float>(
+                100.0 * static_cast<double>(info.mem_total_kb - available_kb) /
+                static_cast<double>(info.mem_total_kb));
+        }
+    }
+    return true;
+}
+
+void HighRateSampler::smooth(size_t index) {
+    HighRateSample& current = samples_[index];
+
+    // Advance the window start as far as possible while the window still
+    // holds MIN_WINDOW_JIFFIES; both ends only move forward, so this is
+    // amortized O(1) per sample
+    while (window_start_ + 1 < index &&
+           current.total_jiffies - samples_[window_start_ + 1].total_jiffies >= MIN_WINDOW_JIFFIES) {
+        ++window_start_;
+    }
+
+    const HighRateSample& start = samples_[window_start_];
+    uint64_t total_delta = current.total_jiffies - start.total_jiffies;
+    uint64_t idle_delta = current.idle_jiffies - start.idle_jiffies;
+
+    current.window_ms = static_cast<float>(current.time_us - start.time_us) / 1000.0f;
+    if (index == 0 || total_delta < MIN_WINDOW_JIFFIES) {
+        // Not enough ticks yet to say anything; carry the previous value
+        current.cpu_percent = index > 0 ? samples_[index - 1].cpu_percent : 0.0f;
+        return;
+    }
+
+    double usage = 100.0 * (1.0 - static_cast<double>(idle_delta) / static_cast<double>(total_delta));
+    current.cpu_percent = static_cast<float>(std::min(100.0, std::max(0.0, usage)));
+}
+
+HighRateReport HighRateSampler::capture(double rate_hz, std::chrono::milliseconds duration) {
+    HighRateReport report;
+    rate_hz = std::min(MAX_RATE_HZ, std::max(MIN_RATE_HZ, rate_hz));
+    report.requested_hz = rate_hz;
+    report.clock_ticks_per_sec = sysconf(_SC_CLK_TCK);
+
+    samples_.clear();
+    window_start_ = 0;
+
+    const int64_t period_us = static_cast<int64_t>(1000000.0 / rate_hz);
+    const int64_t start_us = nowMicros();
+    const int64_t end_us = start_us + static_cast<int64_t>(duration.count()) * 1000;
+    const int64_t cpu_start_us = threadCpuMicros();
+
+    int64_t total_read_us = 0;
+    int64_t max_read_us = 0;
+    int64_t max_lateness_us = 0;
+    int64_t next_us = start_us;
+
+    while (samples_.size() < capacity_) {
+        int64_t wake_us = nowMicros();
+        if (wake_us >= end_us) {
+            break;
+        }
+        max_lateness_us = std::max(max_lateness_us, wake_us - next_us);
+
+        HighRateSample sample{};
+        sample.time_us = wake_us - start_us;
+        if (readSample(sample)) {
+            int64_t read_us = nowMicros() - wake_us;
+            total_read_us += read_us;
+            max_read_us = std::max(max_read_us, read_us);
+
+            samples_.push_back(sample);
+            smooth(samples_.size() - 1);
+        }
+
+        // Fixed-rate schedule; after an overrun, skip the missed slots
+        next_us += period_us;
+        int64_t now_us = nowMicros();
+        if (next_us < now_us) {
+            next_us += ((now_us - next_us) / period_us + 1) * period_us;
+        }
+        sleepUntilMicros(next_us);
+    }
+
+    int64_t elapsed_us = nowMicros() - start_us;
+    int64_t cpu_used_us = threadCpuMicros() - cpu_start_us;
+
+    report.samples = samples_.size();
+    if (elapsed_us > 0) {
+        report.achieved_hz = static_cast<double>(report.samples) * 1e6 / static_cast<double>(elapsed_us);
+        report.sampler_cpu_percent = 100.0 * static_cast<double>(cpu_used_us) / static_cast<double>(elapsed_us);
+    }
+    if (report.samples > 0) {
+        report.mean_read_us = static_cast<double>(total_read_us) / static_cast<double>(report.samples);
+    }
+    report.max_read_us = static_cast<double>(max_read_us);
+    report.max_lateness_us = static_cast<double>(max_lateness_us);
+
+    return report;
+}
+
+} // namespace platform
+} // namespace resmon
@@ -0,0 +1,77 @@
+#ifndef RESMON_BACKEND_LINUX_HIGH_RATE_SAMPLER_H
+#define RESMON_BACKEND_LINUX_HIGH_RATE_SAMPLER_H
+
+#include "cached_file.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace resmon {
+namespace platform {
+
+// One high-rate CPU/RAM sample
+struct HighRateSample {
+    int64_t time_us;          // since capture start (steady clock)
+    float cpu_percent;        // usage over the smoothing window ending here
+    float window_ms;          // length of that window
+    float ram_percent;
+
+    // Raw /proc/stat counters, kept for the smoothing window
+    uint64_t idle_jiffies;
+    uint64_t total_jiffies;
+};
+
+// What the capture cost and how well it kept up
+struct HighRateReport {
+    double requested_hz = 0.0;
+    double achieved_hz = 0.0;
+    size_t samples = 0;
+    long clock_ticks_per_sec = 0;       // USER_HZ, resolution of /proc/stat
+    double mean_read_us = 0.0;          // /proc/stat + /proc/meminfo read and parse
+    double max_read_us = 0.0;
+    double max_lateness_us = 0.0;       // worst wakeup delay past the schedule
+    double sampler_cpu_percent = 0.0;   // CPU time of the capture thread / wall time
+};
+
+// Samples aggregate CPU and RAM usage at 10-1000 Hz into a buffer that is
+// allocated up front, so the capture loop itself never allocates.
+//
+// /proc/stat only advances in whole jiffies (USER_HZ, usually 100/s), so a
+// 1 ms delta is almost always 0 or 1 tick and reads as 0% or 100%. Each
+// sample's usage is therefore computed over the shortest trailing window
+// that has accumulated at least MIN_WINDOW_JIFFIES of CPU time, which
+// bounds the quantization error to 1/MIN_WINDOW_JIFFIES.
+class HighRateSampler {
+public:
+    static constexpr uint64_t MIN_WINDOW_JIFFIES = 20;
+
+    static constexpr double MIN_RATE_HZ = 10.0;
+    static constexpr double MAX_RATE_HZ = 1000.0;
+
+    // root: prefix for /proc (empty = the real filesystem)
+    explicit HighRateSampler(size_t capacity, const std::string& root = std::string());
+
+    // Sample at rate_hz until duration elapses or the buffer is full.
+    // Blocks the calling thread for the whole capture.
+    HighRateReport capture(double rate_hz, std::chrono::milliseconds duration);
+
+    const std::vector<HighRateSample>& samples() const { return samples_; }
+
+private:
+    bool readSample(HighRateSample& sample);
+    void smooth(size_t index);
+
+    CachedFile stat_file_;
+    CachedFile meminfo_file_;
+
+    std::vector<HighRateSample> samples_;
+    size_t capacity_;
+    size_t window_start_;
+};
+
+} // namespace platform
+} // namespace resmon
+
+#endif // RESMON_BACKEND_LINUX_HIGH_RATE_SAMPLER_H
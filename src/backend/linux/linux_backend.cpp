@@ -3,47 +3,351 @@
 namespace resmon {
 namespace platform {
 
-LinuxBackend::LinuxBackend()
-    : cpu_collector_()
-    , ram_collector_()
-    , nvidia_gpu_collector_()
-    , amd_gpu_collector_()
-    , intel_gpu_collector_()
+static const char* const COLLECTOR_NAMES[] = {"cpu", "ram", "nvidia", "amd", "intel", "processes", "cgroups", "pressure", "disks"};
+
+static uint64_t nanosSince(std::chrono::steady_clock::time_point start) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+}
+
+static float toMicros(double ns) {
+    return static_cast<float>(ns / 1000.0);
+}
+
+static CollectorTiming timingOf(const char* name, const LatencyHistogram& histogram) {
+    CollectorTiming timing;
+    timing.name = name;
+    timing.calls = histogram.count();
+    timing.last_us = toMicros(static_cast<double>(histogram.lastNs()));
+    timing.mean_us = toMicros(histogram.meanNs());
+    timing.p50_us = toMicros(static_cast<double>(histogram.percentileNs(0.50)));
+    timing.p99_us = toMicros(static_cast<double>(histogram.percentileNs(0.99)));
+    timing.max_us = toMicros(static_cast<double>(histogram.maxNs()));
+    return timing;
+}
+
+LinuxBackend::LinuxBackend(const BackendOptions& options)
+    : options_(options)
+    , drm_devices_(options.fs_root)
+    , drm_clients_(options.fs_root)
+    , cpu_collector_(options.fs_root)
+    , ram_collector_(options.fs_root)
+    , nvidia_gpu_collector_(options.nvml_library, options.fs_root)
+    , amd_gpu_collector_(drm_clients_)
+    , intel_gpu_collector_(drm_clients_)
+    , process_collector_(options.fs_root)
+    , cgroup_collector_(options.fs_root)
+    , pressure_collector_(options.fs_root)
+    , disk_collector_(options.fs_root)
 {
+    latest_cpu_.temperature_celsius = -1.0f;
+
+    // A fixture tree (fs_root) is not affected by the host's hotplug events
+    drm_devices_.scan();
+    if (options_.fs_root.empty()) {
+        drm_devices_.listen();
+    }
+    applyDrmDevices(COLLECTOR_AMD);
+    applyDrmDevices(COLLECTOR_INTEL);
+
+    // GPUs hotplugged later share the workers of the collectors active now
+    if (options_.parallel_collection) {
+        // One worker per active collector, so total latency is that of the
+        // slowest collector rather than the sum
+        size_t active = 0;
+        for (int id = 0; id < COLLECTOR_COUNT; ++id) {
+            if (isActive(static_cast<CollectorId>(id))) {
+                ++active;
+            }
+        }
+        pool_ = std::make_unique<CollectorPool>(active);
+    }
+}
+
+void LinuxBackend::watchThresholds(const AlertConfig& config, std::function<void()> wake) {
+    // A trigger is written into the file; fixture trees only hold plain text
+    if (options_.fs_root.empty()) {
+        pressure_collector_.watch(config, std::move(wake));
+    }
 }
 
 SystemMetrics LinuxBackend::collect() {
+    uint64_t timestamp_ms = wallClockMillis();
+    auto start = std::chrono::steady_clock::now();
+
+    // One non-blocking recv() unless a drm uevent arrived; collectors pick
+    // up a new device list before their next run
+    drm_devices_.poll();
+
+    SystemMetrics metrics = pool_ ? collectParallel() : collectSerial();
+    metrics.timestamp_ms = timestamp_ms;
+    fillOverhead(metrics.overhead, nanosSince(start));
+    return metrics;
+}
+
+SystemMetrics LinuxBackend::collectSerial() {
     SystemMetrics metrics;
 
     // Collect CPU metrics
+    auto start = std::chrono::steady_clock::now();
     metrics.cpu = cpu_collector_.collect();
+    recordTiming(COLLECTOR_CPU, start);
 
     // Collect RAM metrics
+    start = std::chrono::steady_clock::now();
     metrics.ram = ram_collector_.collect();
+    recordTiming(COLLECTOR_RAM, start);
 
     // Collect GPU metrics from all GPU vendors
     // Each collector returns empty vector if no GPUs of that type found
 
     // NVIDIA GPUs (via NVML)
+    start = std::chrono::steady_clock::now();
     auto nvidia_gpus = nvidia_gpu_collector_.collect();
+    recordTiming(COLLECTOR_NVIDIA, start);
     metrics.gpus.insert(metrics.gpus.end(), nvidia_gpus.begin(), nvidia_gpus.end());
 
+    // AMD and Intel per-process usage, from one scan of /proc
+    applyDrmDevices(COLLECTOR_AMD);
+    applyDrmDevices(COLLECTOR_INTEL);
+    start = std::chrono::steady_clock::now();
+    updateDrmClients();
+    drm_clients_timing_.record(nanosSince(start));
+
     // AMD GPUs (via sysfs/amdgpu driver)
+    start = std::chrono::steady_clock::now();
     auto amd_gpus = amd_gpu_collector_.collect();
+    recordTiming(COLLECTOR_AMD, start);
     metrics.gpus.insert(metrics.gpus.end(), amd_gpus.begin(), amd_gpus.end());
 
     // Intel GPUs (via sysfs)
+    start = std::chrono::steady_clock::now();
     auto intel_gpus = intel_gpu_collector_.collect();
+    recordTiming(COLLECTOR_INTEL, start);
     metrics.gpus.insert(metrics.gpus.end(), intel_gpus.begin(), intel_gpus.end());
 
+    // Per-process CPU and memory (top N)
+    start = std::chrono::steady_clock::now();
+    metrics.processes = process_collector_.collect();
+    recordTiming(COLLECTOR_PROCESSES, start);
+
+    // Per-cgroup usage (cgroup v2)
+    start = std::chrono::steady_clock::now();
+    metrics.cgroups = cgroup_collector_.collect();
+    recordTiming(COLLECTOR_CGROUPS, start);
+
+    // Pressure stalls (PSI), plus any trigger fired since the last sample
+    start = std::chrono::steady_clock::now();
+    metrics.pressure = pressure_collector_.collect();
+    recordTiming(COLLECTOR_PRESSURE, start);
+
+    // Block devices (whole disks)
+    start = std::chrono::steady_clock::now();
+    metrics.disks = disk_collector_.collect();
+    recordTiming(COLLECTOR_DISKS, start);
+
+    return metrics;
+}
+
+bool LinuxBackend::isActive(CollectorId id) const {
+    switch (id) {
+        case COLLECTOR_CPU:
+        case COLLECTOR_RAM:
+            return true;
+        case COLLECTOR_NVIDIA:
+            return nvidia_gpu_collector_.isAvailable();
+        case COLLECTOR_AMD:
+            return amd_gpu_collector_.hasGpus();
+        case COLLECTOR_INTEL:
+            return intel_gpu_collector_.hasGpus();
+        case COLLECTOR_PROCESSES:
+            return process_collector_.isAvailable();
+        case COLLECTOR_CGROUPS:
+            return cgroup_collector_.isAvailable();
+        case COLLECTOR_PRESSURE:
+            return pressure_collector_.isAvailable();
+        case COLLECTOR_DISKS:
+            return disk_collector_.isAvailable();
+        default:
+            return false;
+    }
+}
+
+void LinuxBackend::applyDrmDevices(CollectorId id) {
+    if (drm_generation_[id] == drm_devices_.generation()) {
+        return;
+    }
+    if (id == COLLECTOR_AMD) {
+        amd_gpu_collector_.setDevices(drm_devices_.devices());
+    } else if (id == COLLECTOR_INTEL) {
+        intel_gpu_collector_.setDevices(drm_devices_.devices());
+    } else {
+        return;
+    }
+    drm_generation_[id] = drm_devices_.generation();
+    // Don't keep reporting GPUs that went away until the next run
+    latest_gpus_[id].clear();
+}
+
+void LinuxBackend::updateDrmClients() {
+    if (drm_clients_generation_ != drm_devices_.generation()) {
+        std::vector<std::string> pdevs;
+        for (const DrmDevice& device : drm_devices_.devices()) {
+            if ((device.vendor == DrmVendor::Amd || device.vendor == DrmVendor::Intel) &&
+                !device.pci_address.empty()) {
+                pdevs.push_back(device.pci_address);
+            }
+        }
+        drm_clients_.setDevices(std::move(pdevs));
+        drm_clients_generation_ = drm_devices_.generation();
+    }
+    drm_clients_.update();
+}
+
+void LinuxBackend::recordTiming(CollectorId id, std::chrono::steady_clock::time_point start) {
+    timings_[id].record(nanosSince(start));
+}
+
+void LinuxBackend::fillOverhead(OverheadMetrics& overhead, uint64_t collect_ns) {
+    collect_timing_.record(collect_ns);
+    overhead.collect_us = toMicros(static_cast<double>(collect_ns));
+    overhead.collect_p50_us = toMicros(static_cast<double>(collect_timing_.percentileNs(0.50)));
+    overhead.collect_p99_us = toMicros(static_cast<double>(collect_timing_.percentileNs(0.99)));
+    overhead.collect_max_us = toMicros(static_cast<double>(collect_timing_.maxNs()));
+    self_monitor_.sample(overhead.cpu_percent, overhead.rss_bytes);
+
+    std::lock_guard<std::mutex> lock(results_mutex_);
+    overhead.collectors.clear();
+    for (int i = 0; i < COLLECTOR_COUNT; ++i) {
+        CollectorId id = static_cast<CollectorId>(i);
+        const LatencyHistogram& histogram = timings_[id];
+        if (!isActive(id) || histogram.count() == 0) {
+            continue;
+        }
+        overhead.collectors.push_back(timingOf(COLLECTOR_NAMES[id], histogram));
+    }
+    // The DRM client scan shared by the AMD and Intel collectors
+    if (drm_clients_timing_.count() > 0) {
+        overhead.collectors.push_back(timingOf("drm clients", drm_clients_timing_));
+    }
+}
+
+void LinuxBackend::runCollector(CollectorId id) {
+    // Only this task touches the collector while in_flight_[id] is set,
+    // so the collection itself runs without holding the lock
+    CpuMetrics cpu{};
+    RamMetrics ram{};
+    std::vector<GpuMetrics> gpus;
+    ProcessMetrics processes;
+    std::vector<CgroupMetrics> cgroups;
+    PressureMetrics pressure;
+    std::vector<DiskMetrics> disks;
+
+    auto start = std::chrono::steady_clock::now();
+    switch (id) {
+        case COLLECTOR_CPU:    cpu = cpu_collector_.collect(); break;
+        case COLLECTOR_RAM:    ram = ram_collector_.collect(); break;
+        case COLLECTOR_NVIDIA: gpus = nvidia_gpu_collector_.collect(); break;
+        case COLLECTOR_AMD:    gpus = amd_gpu_collector_.collect(); break;
+        case COLLECTOR_INTEL:  gpus = intel_gpu_collector_.collect(); break;
+        case COLLECTOR_PROCESSES: processes = process_collector_.collect(); break;
+        case COLLECTOR_CGROUPS: cgroups = cgroup_collector_.collect(); break;
+        case COLLECTOR_PRESSURE: pressure = pressure_collector_.collect(); break;
+        case COLLECTOR_DISKS:  disks = disk_collector_.collect(); break;
+        default: break;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(results_mutex_);
+        recordTiming(id, start);
+        if (id == COLLECTOR_CPU) {
+            latest_cpu_ = cpu;
+        } else if (id == COLLECTOR_RAM) {
+            latest_ram_ = ram;
+        } else if (id == COLLECTOR_PROCESSES) {
+            latest_processes_ = std::move(processes);
+        } else if (id == COLLECTOR_CGROUPS) {
+            latest_cgroups_ = std::move(cgroups);
+        } else if (id == COLLECTOR_PRESSURE) {
+            latest_pressure_ = pressure;
+        } else if (id == COLLECTOR_DISKS) {
+            latest_disks_ = std::move(disks);
+        } else {
+            latest_gpus_[id] = std::move(gpus);
+        }
+        in_flight_[id] = false;
+    }
+    results_ready_.notify_all();
+}
+
+SystemMetrics LinuxBackend::collectParallel() {
+    std::unique_lock<std::mutex> lock(results_mutex_);
+
+    // Only the collectors submitted now are waited for; one still running
+    // from an earlier tick (a hung driver call) keeps its last result
+    // instead of holding every later sample to the deadline
+    bool submitted[COLLECTOR_COUNT] = {};
+
+    // The AMD and Intel collectors summarize the same DRM client scan, so
+    // it runs here, once, before either is submitted. If one of them is
+    // still running from an earlier tick the scan waits for the next one.
+    if (!in_flight_[COLLECTOR_AMD] && !in_flight_[COLLECTOR_INTEL]) {
+        applyDrmDevices(COLLECTOR_AMD);
+        applyDrmDevices(COLLECTOR_INTEL);
+        if (isActive(COLLECTOR_AMD) || isActive(COLLECTOR_INTEL)) {
+            // Only this thread submits them, so neither can start meanwhile
+            lock.unlock();
+            auto start = std::chrono::steady_clock::now();
+            updateDrmClients();
+            uint64_t ns = nanosSince(start);
+            lock.lock();
+            drm_clients_timing_.record(ns);
+        }
+    }
+
+    for (int i = 0; i < COLLECTOR_COUNT; ++i) {
+        CollectorId id = static_cast<CollectorId>(i);
+        if (in_flight_[id]) {
+            continue;
+        }
+        applyDrmDevices(id);
+        if (!isActive(id)) {
+            continue;
+        }
+        in_flight_[id] = true;
+        submitted[id] = true;
+        pool_->submit([this, id] { runCollector(id); });
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + options_.collect_deadline;
+    results_ready_.wait_until(lock, deadline, [this, &submitted] {
+        for (int id = 0; id < COLLECTOR_COUNT; ++id) {
+            if (submitted[id] && in_flight_[id]) {
+                return false;
+            }
+        }
+        return true;
+    });
+
+    SystemMetrics metrics;
+    metrics.cpu = latest_cpu_;
+    metrics.ram = latest_ram_;
+    metrics.processes = latest_processes_;
+    metrics.cgroups = latest_cgroups_;
+    metrics.pressure = latest_pressure_;
+    metrics.disks = latest_disks_;
+    for (int id = COLLECTOR_NVIDIA; id <= COLLECTOR_INTEL; ++id) {
+        metrics.gpus.insert(metrics.gpus.end(), latest_gpus_[id].begin(), latest_gpus_[id].end());
+    }
+
     return metrics;
 }
 
 } // namespace platform
 
 // Factory function implementation for Linux
-std::unique_ptr<IMetricsBackend> createPlatformBackend() {
-    return std::make_unique<platform::LinuxBackend>();
+std::unique_ptr<IMetricsBackend> createPlatformBackend(const BackendOptions& options) {
+    return std::make_unique<platform::LinuxBackend>(options);
 }
 
 } // namespace resmon
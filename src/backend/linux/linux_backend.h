@@ -2,28 +2,124 @@
 #define RESMON_BACKEND_LINUX_LINUX_BACKEND_H
 
 #include "../../core/backend.h"
+#include "../../core/latency_histogram.h"
+#include "collector_pool.h"
+#include "cgroup_linux.h"
 #include "cpu_linux.h"
+#include "disk_linux.h"
+#include "drm_devices.h"
+#include "drm_fdinfo.h"
 #include "ram_linux.h"
 #include "gpu_nvidia.h"
 #include "gpu_amd.h"
 #include "gpu_intel.h"
+#include "pressure_linux.h"
+#include "process_linux.h"
+#include "self_monitor.h"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 
 namespace resmon {
 namespace platform {
 
 class LinuxBackend : public IMetricsBackend {
 public:
-    LinuxBackend();
+    explicit LinuxBackend(const BackendOptions& options = BackendOptions());
     ~LinuxBackend() override = default;
 
     SystemMetrics collect() override;
 
+    // Register the pressure thresholds as kernel PSI triggers
+    void watchThresholds(const AlertConfig& config, std::function<void()> wake) override;
+
 private:
+    // Collectors that can run as independent tasks in parallel mode
+    enum CollectorId {
+        COLLECTOR_CPU,
+        COLLECTOR_RAM,
+        COLLECTOR_NVIDIA,
+        COLLECTOR_AMD,
+        COLLECTOR_INTEL,
+        COLLECTOR_PROCESSES,
+        COLLECTOR_CGROUPS,
+        COLLECTOR_PRESSURE,
+        COLLECTOR_DISKS,
+        COLLECTOR_COUNT
+    };
+
+    // Run every collector in turn on the calling thread
+    SystemMetrics collectSerial();
+
+    // Fan the collectors out on the pool and join them under the deadline
+    SystemMetrics collectParallel();
+
+    // Worker side of collectParallel(): run one collector, publish its result
+    void runCollector(CollectorId id);
+
+    // Whether a collector has anything to do on this host
+    bool isActive(CollectorId id) const;
+
+    // Hand the current DRM device list to a vendor collector if it has not
+    // seen it yet. The collector must not be running; in parallel mode the
+    // caller holds results_mutex_.
+    void applyDrmDevices(CollectorId id);
+
+    // Rescan the DRM clients shared by the AMD and Intel collectors, for
+    // the current device list. Neither collector may be running.
+    void updateDrmClients();
+
+    // Add the time since start to a collector's histogram. In parallel
+    // mode the caller holds results_mutex_.
+    void recordTiming(CollectorId id, std::chrono::steady_clock::time_point start);
+
+    // Fill in resmon's own cost for this sample
+    void fillOverhead(OverheadMetrics& overhead, uint64_t collect_ns);
+
+    BackendOptions options_;
+
+    // Shared by the AMD and Intel collectors; rescans on drm uevents
+    DrmDeviceEnumerator drm_devices_;
+    uint64_t drm_generation_[COLLECTOR_COUNT] = {};
+
+    // Per-process DRM usage, scanned once per sample for both vendors
+    DrmClientScanner drm_clients_;
+    uint64_t drm_clients_generation_ = 0;
+
     CpuCollector cpu_collector_;
     RamCollector ram_collector_;
     NvidiaGpuCollector nvidia_gpu_collector_;
     AmdGpuCollector amd_gpu_collector_;
     IntelGpuCollector intel_gpu_collector_;
+    ProcessCollector process_collector_;
+    CgroupCollector cgroup_collector_;
+    PressureCollector pressure_collector_;
+    DiskCollector disk_collector_;
+
+    // Parallel mode: latest result of each collector, guarded by results_mutex_.
+    // A collector still running from an earlier tick is not resubmitted; its
+    // last completed result is reused until it finishes.
+    std::mutex results_mutex_;
+    std::condition_variable results_ready_;
+    bool in_flight_[COLLECTOR_COUNT] = {};
+    CpuMetrics latest_cpu_{};
+    RamMetrics latest_ram_{};
+    ProcessMetrics latest_processes_;
+    std::vector<CgroupMetrics> latest_cgroups_;
+    PressureMetrics latest_pressure_;
+    std::vector<DiskMetrics> latest_disks_;
+    std::vector<GpuMetrics> latest_gpus_[COLLECTOR_COUNT];
+
+    // Self-instrumentation; timings_ and drm_clients_timing_ are guarded by
+    // results_mutex_ too
+    LatencyHistogram timings_[COLLECTOR_COUNT];
+    LatencyHistogram collect_timing_;
+    LatencyHistogram drm_clients_timing_;
+    SelfMonitor self_monitor_;
+
+    // Declared last so workers are joined before the collectors are destroyed
+    std::unique_ptr<CollectorPool> pool_;
 };
 
 } // namespace platform
@@ -0,0 +1,252 @@
+#include "pressure_linux.h"
+#include "proc_parse.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <vector>
+
+namespace resmon {
+namespace platform {
+
+static const char* const RESOURCE_NAMES[] = {"cpu", "memory", "io"};
+
+// Unprivileged triggers (Linux 6.5+) need a window that is a multiple of this
+static constexpr uint64_t UNPRIVILEGED_WINDOW_STEP_US = 2000000;
+
+static void copyStall(const PressureLine& line, PressureStall& stall) {
+    stall.avg10 = line.avg10;
+    stall.avg60 = line.avg60;
+    stall.total_us = line.total_us;
+}
+
+bool parseResourcePressure(std::string_view contents, ResourcePressure& pressure) {
+    PressureStat stat;
+    if (!parsePressure(contents, stat)) {
+        return false;
+    }
+    copyStall(stat.some, pressure.some);
+    copyStall(stat.full, pressure.full);
+    return true;
+}
+
+PressureCollector::PressureCollector(const std::string& root)
+    : available_(false)
+    , trigger_count_(0)
+    , window_us_(0)
+    , stop_fd_(-1)
+{
+    for (int r = 0; r < RESOURCE_COUNT; ++r) {
+        files_[r] = CachedFile(root + "/proc/pressure/" + RESOURCE_NAMES[r]);
+    }
+    available_ = files_[RESOURCE_CPU].read();
+}
+
+PressureCollector::~PressureCollector() {
+    if (thread_.joinable()) {
+        uint64_t one = 1;
+        ssize_t written = write(stop_fd_, &one, sizeof(one));
+        (void)written;
+        thread_.join();
+    }
+    if (stop_fd_ >= 0) {
+        close(stop_fd_);
+    }
+    // Closing a trigger's descriptor unregisters it
+    for (size_t i = 0; i < trigger_count_; ++i) {
+        close(triggers_[i].fd);
+    }
+}
+
+PressureMetrics PressureCollector::collect() {
+    PressureMetrics metrics;
+    if (!available_) {
+        return metrics;
+    }
+    metrics.available = true;
+
+    ResourcePressure* resources[RESOURCE_COUNT] = {&metrics.cpu, &metrics.memory, &metrics.io};
+    bool read[RESOURCE_COUNT] = {};
+    for (int r = 0; r < RESOURCE_COUNT; ++r) {
+        read[r] = files_[r].read() && parseResourcePressure(files_[r].contents(), *resources[r]);
+    }
+    auto now = std::chrono::steady_clock::now();
+
+    // Triggers that fired since the previous collect, even if the stall
+    // was too short to show in avg10 yet
+    for (size_t i = 0; i < trigger_count_; ++i) {
+        Trigger& trigger = triggers_[i];
+        ResourcePressure& pressure = *resources[trigger.resource];
+        if (trigger.fired.exchange(false) && read[trigger.resource] &&
+            confirmed(trigger, pressure.some.total_us, now) && trigger.percent > pressure.triggered_percent) {
+            pressure.triggered_percent = trigger.percent;
+        }
+    }
+
+    if (trigger_count_ > 0) {
+        for (int r = 0; r < RESOURCE_COUNT; ++r) {
+            if (read[r]) {
+                recordReading(static_cast<Resource>(r), resources[r]->some.total_us, now);
+            }
+        }
+    }
+    return metrics;
+}
+
+bool PressureCollector::confirmed(const Trigger& trigger, uint64_t total_us,
+                                  std::chrono::steady_clock::time_point now) const {
+    const StallReading& newer = newer_[trigger.resource];
+    const StallReading& older = older_[trigger.resource];
+    // Until a reading is a window old, the one taken at registration
+    // (where the kernel starts the first window too)
+    const StallReading* baseline = &older;
+    if (!older.valid || now - newer.time >= std::chrono::microseconds(trigger.window_us)) {
+        baseline = &newer;
+    }
+    if (!baseline->valid) {
+        return true;
+    }
+    return total_us >= baseline->total_us && total_us - baseline->total_us >= trigger.stall_us;
+}
+
+void PressureCollector::recordReading(Resource resource, uint64_t total_us, std::chrono::steady_clock::time_point now) {
+    // newer_ is replaced once it is a window old, so older_ always is
+    StallReading& newer = newer_[resource];
+    if (!newer.valid || now - newer.time >= std::chrono::microseconds(window_us_)) {
+        older_[resource] = newer;
+        newer.time = now;
+        newer.total_us = total_us;
+        newer.valid = true;
+    }
+}
+
+bool PressureCollector::addTrigger(Resource resource, const std::string& path, float percent) {
+    if (trigger_count_ == MAX_TRIGGERS || percent <= 0.0f || percent > 100.0f) {
+        return false;
+    }
+    int fd = open(path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    // Try the configured window first; if it is refused, the rounded-up
+    // one that unprivileged processes may use
+    uint64_t window_us = static_cast<uint64_t>(PRESSURE_WINDOW_MS) * 1000;
+    uint64_t rounded_us = (window_us + UNPRIVILEGED_WINDOW_STEP_US - 1) /
+                          UNPRIVILEGED_WINDOW_STEP_US * UNPRIVILEGED_WINDOW_STEP_US;
+    bool registered = false;
+    uint64_t window = window_us;
+    uint64_t stall_us = 0;
+    for (uint64_t candidate : {window_us, rounded_us}) {
+        window = candidate;
+        stall_us = static_cast<uint64_t>(static_cast<double>(percent) / 100.0 * static_cast<double>(window));
+        if (stall_us == 0) {
+            stall_us = 1;
+        }
+        char line[64];
+        int length = std::snprintf(line, sizeof(line), "some %llu %llu",
+                                   static_cast<unsigned long long>(stall_us),
+                                   static_cast<unsigned long long>(window));
+        // The kernel takes the terminating NUL as part of the write
+        if (write(fd, line, static_cast<size_t>(length) + 1) == length + 1) {
+            registered = true;
+            break;
+        }
+        if (errno != EINVAL || window == rounded_us) {
+            break;
+        }
+    }
+    if (!registered) {
+        close(fd);
+        return false;
+    }
+
+    Trigger& trigger = triggers_[trigger_count_++];
+    trigger.resource = resource;
+    trigger.percent = percent;
+    trigger.stall_us = stall_us;
+    trigger.window_us = window;
+    trigger.fd = fd;
+    if (window > window_us_) {
+        window_us_ = window;
+    }
+    return true;
+}
+
+bool PressureCollector::watch(const AlertConfig& config, std::function<void()> wake) {
+    if (!available_ || thread_.joinable()) {
+        return false;
+    }
+
+    const AlertThreshold* thresholds[RESOURCE_COUNT] = {
+        &config.cpu_pressure, &config.memory_pressure, &config.io_pressure,
+    };
+    for (int r = 0; r < RESOURCE_COUNT; ++r) {
+        const AlertThreshold& threshold = *thresholds[r];
+        if (!threshold.enabled) {
+            continue;
+        }
+        Resource resource = static_cast<Resource>(r);
+        addTrigger(resource, files_[r].path(), threshold.warning);
+        if (threshold.critical != threshold.warning) {
+            addTrigger(resource, files_[r].path(), threshold.critical);
+        }
+    }
+    if (trigger_count_ == 0) {
+        return false;
+    }
+    // Baseline for confirming the first events
+    collect();
+
+    stop_fd_ = eventfd(0, EFD_CLOEXEC);
+    if (stop_fd_ < 0) {
+        return false;
+    }
+    wake_ = std::move(wake);
+    thread_ = std::thread(&PressureCollector::pollTriggers, this);
+    return true;
+}
+
+void PressureCollector::pollTriggers() {
+    std::vector<pollfd> fds(trigger_count_ + 1);
+    for (size_t i = 0; i < trigger_count_; ++i) {
+        fds[i].fd = triggers_[i].fd;
+        fds[i].events = POLLPRI;
+    }
+    fds[trigger_count_].fd = stop_fd_;
+    fds[trigger_count_].events = POLLIN;
+
+    for (;;) {
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        if (fds[trigger_count_].revents != 0) {
+            return;
+        }
+
+        bool fired = false;
+        for (size_t i = 0; i < trigger_count_; ++i) {
+            short revents = fds[i].revents;
+            if (revents & (POLLERR | POLLNVAL)) {
+                // The trigger is gone; poll() skips negative descriptors
+                fds[i].fd = -1;
+            } else if (revents & POLLPRI) {
+                triggers_[i].fired.store(true);
+                fired = true;
+            }
+        }
+        if (fired && wake_) {
+            wake_();
+        }
+    }
+}
+
+} // namespace platform
+} // namespace resmon
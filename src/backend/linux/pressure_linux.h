@@ -0,0 +1,121 @@
+#ifndef RESMON_BACKEND_LINUX_PRESSURE_LINUX_H
+#define RESMON_BACKEND_LINUX_PRESSURE_LINUX_H
+
+#include "../../core/alerts.h"
+#include "../../core/metrics.h"
+#include "cached_file.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace resmon {
+namespace platform {
+
+// Fill pressure from the contents of a PSI file (/proc/pressure/* or a
+// cgroup's *.pressure). Returns false if they hold no "some" line.
+bool parseResourcePressure(std::string_view contents, ResourcePressure& pressure);
+
+// Host-wide pressure stall information from /proc/pressure/{cpu,memory,io}.
+//
+// collect() re-reads the three files with pread(). watch() also registers
+// kernel PSI triggers: for each resource and alert threshold it writes
+// "some <stall us> <window us>" to a descriptor of its own (the kernel
+// takes one trigger per open file), and a thread blocks in poll() on all of
+// them. The kernel raises POLLPRI as soon as the stall time within the
+// window crosses the threshold, at most once per window, so the thread
+// costs nothing while the host is not stalling. It marks the trigger as
+// fired and calls the wake callback; the next collect() reports the
+// highest threshold crossed in ResourcePressure::triggered_percent.
+//
+// Some kernels raise POLLPRI for windows measured from totals that went
+// stale while nothing was watching, i.e. for stalls that never happened.
+// collect() therefore checks each fired trigger against the "some" total:
+// it must have grown by the trigger's stall time since a reading taken at
+// least a window earlier. Growth since an older point bounds the growth
+// within the window, so no real crossing is dropped.
+// Without CAP_SYS_RESOURCE the kernel only takes windows in multiples of
+// 2 s, and the window is rounded up to one.
+class PressureCollector {
+public:
+    enum Resource {
+        RESOURCE_CPU,
+        RESOURCE_MEMORY,
+        RESOURCE_IO,
+        RESOURCE_COUNT
+    };
+
+    // A warning and a critical trigger per resource
+    static constexpr size_t MAX_TRIGGERS = RESOURCE_COUNT * 2;
+
+    // root: prefix for /proc (empty = the real filesystem)
+    explicit PressureCollector(const std::string& root = std::string());
+    ~PressureCollector();
+
+    // Non-copyable (owns file descriptors and a thread)
+    PressureCollector(const PressureCollector&) = delete;
+    PressureCollector& operator=(const PressureCollector&) = delete;
+
+    PressureMetrics collect();
+
+    // True if the kernel reports PSI (CONFIG_PSI, not booted with psi=0)
+    bool isAvailable() const { return available_; }
+
+    // Register triggers for the enabled pressure thresholds of config and
+    // start the poll thread, which calls wake after a trigger fires.
+    // Returns false if no trigger could be registered (no PSI, or no write
+    // access to /proc/pressure). Only the first call has an effect.
+    bool watch(const AlertConfig& config, std::function<void()> wake);
+
+    size_t triggerCount() const { return trigger_count_; }
+
+private:
+    struct Trigger {
+        Resource resource = RESOURCE_CPU;
+        float percent = 0.0f;              // threshold, % of the window
+        uint64_t stall_us = 0;
+        uint64_t window_us = 0;
+        int fd = -1;
+        std::atomic<bool> fired{false};
+    };
+
+    // A reading of a resource's "some" total
+    struct StallReading {
+        std::chrono::steady_clock::time_point time;
+        uint64_t total_us = 0;
+        bool valid = false;
+    };
+
+    // Open path and write a "some" trigger at percent of PRESSURE_WINDOW_MS
+    bool addTrigger(Resource resource, const std::string& path, float percent);
+    void pollTriggers();
+
+    // Whether the "some" total grew by at least the trigger's stall time
+    // since a reading older than its window
+    bool confirmed(const Trigger& trigger, uint64_t total_us, std::chrono::steady_clock::time_point now) const;
+    void recordReading(Resource resource, uint64_t total_us, std::chrono::steady_clock::time_point now);
+
+    CachedFile files_[RESOURCE_COUNT];
+    bool available_;
+
+    Trigger triggers_[MAX_TRIGGERS];
+    size_t trigger_count_;
+    uint64_t window_us_;                   // longest trigger window
+    // Per resource: the latest reading at least a window older than the
+    // current one, and the one after it
+    StallReading older_[RESOURCE_COUNT];
+    StallReading newer_[RESOURCE_COUNT];
+    std::function<void()> wake_;
+    int stop_fd_;                          // eventfd that ends the poll thread
+    std::thread thread_;
+};
+
+} // namespace platform
+} // namespace resmon
+
+#endif // RESMON_BACKEND_LINUX_PRESSURE_LINUX_H
@@ -0,0 +1,479 @@
+#ifndef RESMON_BACKEND_LINUX_PROC_PARSE_H
+#define RESMON_BACKEND_LINUX_PROC_PARSE_H
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+// Allocation-free parsers for procfs text. They work directly on the
+// buffer of a CachedFile: no streams, no locale, no temporary strings.
+
+namespace resmon {
+namespace platform {
+
+// Skip spaces and tabs, returns the first other character (or end)
+inline const char* skipSpaces(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t')) {
+        ++p;
+    }
+    return p;
+}
+
+// Returns the start of the next line (or end)
+inline const char* nextLine(const char* p, const char* end) {
+    const void* newline = std::memchr(p, '\n', static_cast<size_t>(end - p));
+    return newline ? static_cast<const char*>(newline) + 1 : end;
+}
+
+// Parse an unsigned decimal after optional leading blanks.
+// Returns the position after the digits, or nullptr if there is no number.
+inline const char* parseU64(const char* p, const char* end, uint64_t& value) {
+    p = skipSpaces(p, end);
+    auto result = std::from_chars(p, end, value);
+    if (result.ec != std::errc()) {
+        return nullptr;
+    }
+    return result.ptr;
+}
+
+// Parse a decimal such as "13.92" after optional leading blanks.
+// Returns the position after it, or nullptr if there is no number.
+inline const char* parseDecimal(const char* p, const char* end, float& value) {
+    uint64_t whole = 0;
+    p = parseU64(p, end, whole);
+    if (!p) {
+        return nullptr;
+    }
+    uint64_t fraction = 0;
+    uint64_t scale = 1;
+    if (p < end && *p == '.') {
+        for (++p; p < end && *p >= '0' && *p <= '9' && scale < 1000000000u; ++p) {
+            fraction = fraction * 10 + static_cast<uint64_t>(*p - '0');
+            scale *= 10;
+        }
+    }
+    value = static_cast<float>(static_cast<double>(whole) + static_cast<double>(fraction) / static_cast<double>(scale));
+    return p;
+}
+
+// Jiffy counters from a "cpu" line of /proc/stat
+struct CpuTimes {
+    uint64_t user = 0;
+    uint64_t nice = 0;
+    uint64_t system = 0;
+    uint64_t idle = 0;
+    uint64_t iowait = 0;
+    uint64_t irq = 0;
+    uint64_t softirq = 0;
+    uint64_t steal = 0;
+
+    uint64_t idleTime() const { return idle + iowait; }
+    uint64_t totalTime() const {
+        return user + nice + system + idle + iowait + irq + softirq + steal;
+    }
+};
+
+// Parse the aggregate "cpu " line at the start of /proc/stat.
+// Older kernels omit trailing fields; those are left at 0.
+inline bool parseProcStatCpu(std::string_view contents, CpuTimes& times) {
+    const char* p = contents.data();
+    const char* end = p + contents.size();
+
+    if (contents.size() < 4 || std::memcmp(p, "cpu ", 4) != 0) {
+        return false;
+    }
+    p += 4;
+
+    uint64_t* fields[] = {
+        &times.user, &times.nice, &times.system, &times.idle,
+        &times.iowait, &times.irq, &times.softirq, &times.steal,
+    };
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); ++i) {
+        p = parseU64(p, end, *fields[i]);
+        if (!p) {
+            // user..idle are always present
+            return i >= 4;
+        }
+    }
+    return true;
+}
+
+// Columns of a "cpu" line of /proc/stat, in file order
+enum CpuField {
+    CPU_USER,
+    CPU_NICE,
+    CPU_SYSTEM,
+    CPU_IDLE,
+    CPU_IOWAIT,
+    CPU_IRQ,
+    CPU_SOFTIRQ,
+    CPU_STEAL,
+    CPU_GUEST,          // already counted in user
+    CPU_GUEST_NICE,     // already counted in nice
+    CPU_FIELD_COUNT
+};
+
+// The whole of /proc/stat that CpuCollector uses, with the cpu lines as a
+// struct of arrays: counters[f][i] is field f of line i, where line 0 is
+// the aggregate "cpu" line and line i > 0 is the (i-1)-th cpuN line. Each
+// field is contiguous across CPUs, so per-CPU deltas are simple loops.
+struct ProcStat {
+    std::vector<uint64_t> counters[CPU_FIELD_COUNT];
+    std::vector<uint32_t> cpu_ids;      // N of each cpuN line (offline CPUs are absent)
+    uint64_t context_switches = 0;      // ctxt
+    uint64_t procs_running = 0;
+    uint64_t procs_blocked = 0;
+
+    size_t lineCount() const { return counters[0].size(); }
+};
+
+// Parse /proc/stat into stat, reusing its arrays: after the first call on
+// a host no memory is allocated. Fields older kernels omit are 0. Lines
+// other than cpu*, ctxt and procs_* (intr can be tens of kB on large
+// hosts) are skipped with one memchr each, and parsing stops after
+// procs_blocked.
+inline bool parseProcStat(std::string_view contents, ProcStat& stat) {
+    const char* p = contents.data();
+    const char* end = p + contents.size();
+    size_t lines = 0;
+    stat.cpu_ids.clear();
+
+    while (p < end) {
+        const char* line_end = nextLine(p, end);
+        size_t length = static_cast<size_t>(line_end - p);
+
+        if (length > 3 && std::memcmp(p, "cpu", 3) == 0) {
+            const char* q = p + 3;
+            if (*q != ' ') {
+                uint64_t id = 0;
+                q = parseU64(q, line_end, id);
+                if (!q || lines == 0) {
+                    return false;   // no aggregate line first: not /proc/stat
+                }
+                stat.cpu_ids.push_back(static_cast<uint32_t>(id));
+            } else if (lines != 0) {
+                return false;
+            }
+
+            for (size_t f = 0; f < CPU_FIELD_COUNT; ++f) {
+                uint64_t value = 0;
+                if (q) {
+                    q = parseU64(q, line_end, value);
+                }
+                if (stat.counters[f].size() <= lines) {
+                    stat.counters[f].resize(lines + 1);
+                }
+                stat.counters[f][lines] = q ? value : 0;
+            }
+            ++lines;
+        } else if (length > 5 && std::memcmp(p, "ctxt ", 5) == 0) {
+            parseU64(p + 5, line_end, stat.context_switches);
+        } else if (length > 14 && std::memcmp(p, "procs_running ", 14) == 0) {
+            parseU64(p + 14, line_end, stat.procs_running);
+        } else if (length > 14 && std::memcmp(p, "procs_blocked ", 14) == 0) {
+            parseU64(p + 14, line_end, stat.procs_blocked);
+            break;
+        }
+        p = line_end;
+    }
+
+    for (size_t f = 0; f < CPU_FIELD_COUNT; ++f) {
+        stat.counters[f].resize(lines);
+    }
+    return lines > 0;
+}
+
+// The /proc/meminfo fields RamCollector needs, in kB
+struct MemInfo {
+    uint64_t mem_total_kb = 0;
+    uint64_t mem_free_kb = 0;
+    uint64_t mem_available_kb = 0;
+    uint64_t buffers_kb = 0;
+    uint64_t cached_kb = 0;
+    bool has_mem_available = false;
+};
+
+// Parse /proc/meminfo. Keys are matched on length first, so most of the
+// ~50 lines are rejected with a single compare, and parsing stops once
+// "Cached:" (the last wanted field, 5th line) has been seen.
+inline MemInfo parseMemInfo(std::string_view contents) {
+    MemInfo info;
+    const char* p = contents.data();
+    const char* end = p + contents.size();
+
+    while (p < end) {
+        const char* line_end = nextLine(p, end);
+        const void* colon = std::memchr(p, ':', static_cast<size_t>(line_end - p));
+        if (!colon) {
+            p = line_end;
+            continue;
+        }
+
+        const char* key_end = static_cast<const char*>(colon);
+        std::string_view key(p, static_cast<size_t>(key_end - p));
+        uint64_t* target = nullptr;
+        bool done = false;
+
+        switch (key.size()) {
+            case 6:
+                if (key == "Cached") {
+                    target = &info.cached_kb;
+                    done = true;
+                }
+                break;
+            case 7:
+                if (key == "MemFree") {
+                    target = &info.mem_free_kb;
+                } else if (key == "Buffers") {
+                    target = &info.buffers_kb;
+                }
+                break;
+            case 8:
+                if (key == "MemTotal") {
+                    target = &info.mem_total_kb;
+                }
+                break;
+            case 12:
+                if (key == "MemAvailable") {
+                    target = &info.mem_available_kb;
+                    info.has_mem_available = true;
+                }
+                break;
+            default:
+                break;
+        }
+
+        if (target && !parseU64(key_end + 1, line_end, *target)) {
+            *target = 0;
+        }
+        if (done) {
+            break;
+        }
+        p = line_end;
+    }
+
+    return info;
+}
+
+// The fields of /proc/<pid>/stat resmon uses
+struct ProcPidStat {
+    std::string_view comm;     // field 2 without the parentheses; points into the contents
+    uint64_t utime = 0;        // clock ticks
+    uint64_t stime = 0;        // clock ticks
+    uint64_t rss_pages = 0;
+};
+
+// Parse /proc/<pid>/stat. The command name (field 2) is in parentheses and
+// may itself contain spaces and parentheses, so fields are counted from
+// the last ')'.
+inline bool parseProcPidStat(std::string_view contents, ProcPidStat& stat) {
+    size_t open_paren = contents.find('(');
+    size_t paren = contents.rfind(')');
+    if (open_paren == std::string_view::npos || paren == std::string_view::npos || paren < open_paren) {
+        return false;
+    }
+    stat.comm = contents.substr(open_paren + 1, paren - open_paren - 1);
+    const char* p = contents.data() + paren + 1;
+    const char* end = contents.data() + contents.size();
+
+    // Field 3 (state) is a letter; numeric fields follow from field 4
+    p = skipSpaces(p, end);
+    if (p == end) {
+        return false;
+    }
+    ++p;
+
+    uint64_t value = 0;
+    for (int field = 4; field <= 24; ++field) {
+        // Some fields (e.g. nice, priority) can be negative; their
+        // values are not needed, so just skip the sign
+        p = skipSpaces(p, end);
+        if (p < end && *p == '-') {
+            ++p;
+        }
+        p = parseU64(p, end, value);
+        if (!p) {
+            return false;
+        }
+        if (field == 14) {
+            stat.utime = value;
+        } else if (field == 15) {
+            stat.stime = value;
+        } else if (field == 24) {
+            stat.rss_pages = value;
+        }
+    }
+    return true;
+}
+
+// Value of the "key value" line for key in a flat-keyed file such as
+// cgroup v2's cpu.stat, memory.events or cgroup.events. Returns false if
+// the key is absent.
+inline bool findKeyedValue(std::string_view contents, std::string_view key, uint64_t& value) {
+    const char* p = contents.data();
+    const char* end = p + contents.size();
+    while (p < end) {
+        const char* line_end = nextLine(p, end);
+        size_t length = static_cast<size_t>(line_end - p);
+        if (length > key.size() && p[key.size()] == ' ' && std::memcmp(p, key.data(), key.size()) == 0) {
+            return parseU64(p + key.size() + 1, line_end, value) != nullptr;
+        }
+        p = line_end;
+    }
+    return false;
+}
+
+// Totals over all devices of a cgroup v2 io.stat file, whose lines look
+// like "259:0 rbytes=1 wbytes=2 rios=3 wios=4 dbytes=0 dios=0"
+struct CgroupIoStat {
+    uint64_t read_bytes = 0;
+    uint64_t write_bytes = 0;
+    uint64_t read_ios = 0;
+    uint64_t write_ios = 0;
+};
+
+inline void parseCgroupIoStat(std::string_view contents, CgroupIoStat& io) {
+    io = CgroupIoStat();
+    const char* p = contents.data();
+    const char* end = p + contents.size();
+    while (p < end) {
+        const char* line_end = nextLine(p, end);
+        // Skip the device number, then walk the key=value pairs
+        const char* q = static_cast<const char*>(std::memchr(p, ' ', static_cast<size_t>(line_end - p)));
+        while (q && q < line_end) {
+            q = skipSpaces(q, line_end);
+            const char* equals = static_cast<const char*>(std::memchr(q, '=', static_cast<size_t>(line_end - q)));
+            if (!equals) {
+                break;
+            }
+            std::string_view key(q, static_cast<size_t>(equals - q));
+            uint64_t value = 0;
+            q = parseU64(equals + 1, line_end, value);
+            if (key == "rbytes") {
+                io.read_bytes += value;
+            } else if (key == "wbytes") {
+                io.write_bytes += value;
+            } else if (key == "rios") {
+                io.read_ios += value;
+            } else if (key == "wios") {
+                io.write_ios += value;
+            }
+        }
+        p = line_end;
+    }
+}
+
+// The head of a /proc/diskstats line:
+//   " 259       0 nvme0n1 63241 27204 2082322 12409 12461 ..."
+// Returns the position after the name, or nullptr if the line is malformed.
+inline const char* parseDiskStatsDevice(const char* p, const char* end, uint32_t& major, uint32_t& minor,
+                                        std::string_view& name) {
+    uint64_t value = 0;
+    if (!(p = parseU64(p, end, value))) {
+        return nullptr;
+    }
+    major = static_cast<uint32_t>(value);
+    if (!(p = parseU64(p, end, value))) {
+        return nullptr;
+    }
+    minor = static_cast<uint32_t>(value);
+    p = skipSpaces(p, end);
+    const char* name_end = p;
+    while (name_end < end && *name_end != ' ' && *name_end != '\n') {
+        ++name_end;
+    }
+    name = std::string_view(p, static_cast<size_t>(name_end - p));
+    return name.empty() ? nullptr : name_end;
+}
+
+// The counters after the name. Kernels before 4.18 have the first 11
+// fields; discard (4.18) and flush (5.5) counters follow but are not used.
+struct DiskStatCounters {
+    uint64_t reads = 0;
+    uint64_t reads_merged = 0;
+    uint64_t read_sectors = 0;      // 512-byte units, whatever the device's sector size
+    uint64_t read_ms = 0;
+    uint64_t writes = 0;
+    uint64_t writes_merged = 0;
+    uint64_t write_sectors = 0;
+    uint64_t write_ms = 0;
+    uint64_t in_flight = 0;
+    uint64_t io_ms = 0;             // time with requests in flight
+    uint64_t weighted_io_ms = 0;    // the same, weighted by the number in flight
+};
+
+inline bool parseDiskStatsCounters(const char* p, const char* end, DiskStatCounters& counters) {
+    uint64_t* fields[] = {
+        &counters.reads, &counters.reads_merged, &counters.read_sectors, &counters.read_ms,
+        &counters.writes, &counters.writes_merged, &counters.write_sectors, &counters.write_ms,
+        &counters.in_flight, &counters.io_ms, &counters.weighted_io_ms,
+    };
+    for (uint64_t* field : fields) {
+        if (!(p = parseU64(p, end, *field))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// A pressure stall file (/proc/pressure/* or a cgroup's *.pressure):
+//   some avg10=0.78 avg60=13.92 avg300=18.02 total=413457471
+//   full avg10=0.00 avg60=0.00 avg300=0.00 total=0
+// Kernels before 5.13 have no "full" line for cpu; it stays zero.
+struct PressureLine {
+    float avg10 = 0.0f;
+    float avg60 = 0.0f;
+    float avg300 = 0.0f;
+    uint64_t total_us = 0;
+};
+
+struct PressureStat {
+    PressureLine some;
+    PressureLine full;
+};
+
+// Returns false if there is no "some" line
+inline bool parsePressure(std::string_view contents, PressureStat& stat) {
+    stat = PressureStat();
+    bool found = false;
+    const char* p = contents.data();
+    const char* end = p + contents.size();
+    while (p < end) {
+        const char* line_end = nextLine(p, end);
+        PressureLine* line = nullptr;
+        if (line_end - p > 5 && std::memcmp(p, "some ", 5) == 0) {
+            line = &stat.some;
+            found = true;
+        } else if (line_end - p > 5 && std::memcmp(p, "full ", 5) == 0) {
+            line = &stat.full;
+        }
+        for (const char* q = p + 5; line && q && q < line_end;) {
+            q = skipSpaces(q, line_end);
+            const char* equals = static_cast<const char*>(std::memchr(q, '=', static_cast<size_t>(line_end - q)));
+            if (!equals) {
+                break;
+            }
+            std::string_view key(q, static_cast<size_t>(equals - q));
+            if (key == "avg10") {
+                q = parseDecimal(equals + 1, line_end, line->avg10);
+            } else if (key == "avg60") {
+                q = parseDecimal(equals + 1, line_end, line->avg60);
+            } else if (key == "avg300") {
+                q = parseDecimal(equals + 1, line_end, line->avg300);
+            } else if (key == "total") {
+                q = parseU64(equals + 1, line_end, line->total_us);
+            } else {
+                q = static_cast<const char*>(std::memchr(equals, ' ', static_cast<size_t>(line_end - equals)));
+            }
+        }
+        p = line_end;
+    }
+    return found;
+}
+
+} // namespace platform
+} // namespace resmon
+
+#endif // RESMON_BACKEND_LINUX_PROC_PARSE_H
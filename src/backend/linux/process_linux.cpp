@@ -0,0 +1,329 @@
+#include "process_linux.h"
+#include "cached_file.h"
+#include "proc_parse.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace resmon {
+namespace platform {
+
+// One getdents64() call returns a few hundred /proc entries
+static constexpr size_t DIRENT_BUFFER_SIZE = 32768;
+// /proc/<pid>/stat is ~300 bytes; comm is at most 64 bytes for kthreads
+static constexpr size_t STAT_BUFFER_SIZE = 1024;
+
+static constexpr size_t INITIAL_MAP_CAPACITY = 1024;
+
+// Layout of the records getdents64() fills in
+struct LinuxDirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[1];
+};
+
+// ============================================================================
+// PidSlotMap
+// ============================================================================
+
+PidSlotMap::PidSlotMap()
+    : keys_(INITIAL_MAP_CAPACITY, 0)
+    , slots_(INITIAL_MAP_CAPACITY, 0)
+    , mask_(INITIAL_MAP_CAPACITY - 1)
+    , size_(0)
+{
+}
+
+size_t PidSlotMap::home(uint32_t pid) const {
+    // Fibonacci hashing spreads consecutive pids over the table
+    return static_cast<size_t>((pid * 11400714819323198485ull) >> 32) & mask_;
+}
+
+uint32_t PidSlotMap::find(uint32_t pid) const {
+    for (size_t i = home(pid);; i = (i + 1) & mask_) {
+        if (keys_[i] == pid) {
+            return slots_[i];
+        }
+        if (keys_[i] == 0) {
+            return NOT_FOUND;
+        }
+    }
+}
+
+void PidSlotMap::insert(uint32_t pid, uint32_t slot) {
+    // Keep the load factor under 1/2 so probe runs stay short
+    if ((size_ + 1) * 2 > keys_.size()) {
+        grow();
+    }
+    size_t i = home(pid);
+    while (keys_[i] != 0 && keys_[i] != pid) {
+        i = (i + 1) & mask_;
+    }
+    if (keys_[i] == 0) {
+        ++size_;
+    }
+    keys_[i] = pid;
+    slots_[i] = slot;
+}
+
+void PidSlotMap::erase(uint32_t pid) {
+    size_t i = home(pid);
+    while (keys_[i] != pid) {
+        if (keys_[i] == 0) {
+            return;
+        }
+        i = (i + 1) & mask_;
+    }
+
+    // Backward-shift deletion: pull later entries of the probe run into
+    // the hole unless that would move them before their home bucket
+    size_t hole = i;
+    for (size_t j = (hole + 1) & mask_; keys_[j] != 0; j = (j + 1) & mask_) {
+        size_t wanted = home(keys_[j]);
+        if (((j - wanted) & mask_) >= ((j - hole) & mask_)) {
+            keys_[hole] = keys_[j];
+            slots_[hole] = slots_[j];
+            hole = j;
+        }
+    }
+    keys_[hole] = 0;
+    --size_;
+}
+
+void PidSlotMap::grow() {
+    std::vector<uint32_t> keys(keys_.size() * 2, 0);
+    std::vector<uint32_t> slots(keys.size(), 0);
+    keys.swap(keys_);
+    slots.swap(slots_);
+    mask_ = keys_.size() - 1;
+    size_ = 0;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (keys[i] != 0) {
+            insert(keys[i], slots[i]);
+        }
+    }
+}
+
+// ============================================================================
+// ProcessCollector
+// ============================================================================
+
+static bool parsePid(const char* name, uint32_t& pid) {
+    uint64_t value = 0;
+    const char* end = name + std::strlen(name);
+    auto result = std::from_chars(name, end, value);
+    if (result.ec != std::errc() || result.ptr != end || value == 0 || value > UINT32_MAX) {
+        return false;
+    }
+    pid = static_cast<uint32_t>(value);
+    return true;
+}
+
+ProcessCollector::ProcessCollector(const std::string& root, size_t top_n)
+    : proc_fd_(::open((root + "/proc").c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC))
+    , top_n_(top_n)
+    , fd_budget_(keptFdLimit() / 2)
+    , cached_fds_(0)
+    , ticks_per_second_(sysconf(_SC_CLK_TCK))
+    , page_size_(sysconf(_SC_PAGESIZE))
+    , dirents_(DIRENT_BUFFER_SIZE)
+    , stat_buffer_(STAT_BUFFER_SIZE)
+    , path_()
+    , scan_(0)
+    , has_previous_(false)
+{
+}
+
+ProcessCollector::~ProcessCollector() {
+    for (Slot& slot : slots_) {
+        if (slot.stat_fd >= 0) {
+            ::close(slot.stat_fd);
+        }
+    }
+    releaseKeptFds(cached_fds_);
+    if (proc_fd_ >= 0) {
+        ::close(proc_fd_);
+    }
+}
+
+ProcessMetrics ProcessCollector::collect() {
+    ProcessMetrics metrics;
+    if (proc_fd_ < 0) {
+        return metrics;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = has_previous_ ? std::chrono::duration<double>(now - prev_time_).count() : 0.0;
+    prev_time_ = now;
+    has_previous_ = true;
+    ++scan_;
+
+    // The same directory fd is rewound for every scan
+    if (lseek(proc_fd_, 0, SEEK_SET) != 0) {
+        return metrics;
+    }
+    for (;;) {
+        ssize_t length = getdents64(proc_fd_, dirents_.data(), dirents_.size());
+        if (length <= 0) {
+            break;
+        }
+        for (ssize_t offset = 0; offset < length;) {
+            const LinuxDirent64* entry = reinterpret_cast<const LinuxDirent64*>(dirents_.data() + offset);
+            offset += entry->d_reclen;
+
+            uint32_t pid = 0;
+            if ((entry->d_type != DT_DIR && entry->d_type != DT_UNKNOWN) || !parsePid(entry->d_name, pid)) {
+                continue;
+            }
+
+            uint32_t index = index_.find(pid);
+            if (index == PidSlotMap::NOT_FOUND) {
+                if (free_slots_.empty()) {
+                    index = static_cast<uint32_t>(slots_.size());
+                    slots_.emplace_back();
+                } else {
+                    index = free_slots_.back();
+                    free_slots_.pop_back();
+                }
+                slots_[index].pid = pid;
+                index_.insert(pid, index);
+            }
+
+            if (readSlot(slots_[index], elapsed)) {
+                slots_[index].scan = scan_;
+            } else {
+                release(index);
+            }
+        }
+    }
+
+    // Processes that were not listed this time have exited
+    for (uint32_t i = 0; i < slots_.size(); ++i) {
+        if (slots_[i].pid != 0 && slots_[i].scan != scan_) {
+            release(i);
+        }
+    }
+
+    metrics.count = static_cast<uint32_t>(index_.size());
+    fillTop(metrics.top_cpu, true);
+    fillTop(metrics.top_rss, false);
+    return metrics;
+}
+
+bool ProcessCollector::readSlot(Slot& slot, double elapsed_seconds) {
+    ProcPidStat stat;
+    if (!readStat(slot) || !parseProcPidStat(std::string_view(stat_buffer_.data()), stat)) {
+        return false;
+    }
+
+    uint64_t ticks = stat.utime + stat.stime;
+    slot.cpu_percent = 0.0f;
+    if (slot.primed && elapsed_seconds > 0.0 && ticks_per_second_ > 0 && ticks >= slot.ticks) {
+        double cpu_seconds = static_cast<double>(ticks - slot.ticks) / static_cast<double>(ticks_per_second_);
+        slot.cpu_percent = static_cast<float>(100.0 * cpu_seconds / elapsed_seconds);
+    }
+    slot.ticks = ticks;
+    slot.primed = true;
+    slot.rss_pages = stat.rss_pages;
+
+    // comm can change (prctl, exec), so it is copied on every read
+    size_t name_length = std::min(stat.comm.size(), sizeof(slot.name) - 1);
+    std::memcpy(slot.name, stat.comm.data(), name_length);
+    slot.name[name_length] = '\0';
+    return true;
+}
+
+bool ProcessCollector::readStat(Slot& slot) {
+    ssize_t length = -1;
+    if (slot.stat_fd >= 0) {
+        length = pread(slot.stat_fd, stat_buffer_.data(), stat_buffer_.size() - 1, 0);
+        if (length <= 0) {
+            // The process behind the descriptor exited; if the pid is
+            // listed again it belongs to a new process
+            ::close(slot.stat_fd);
+            slot.stat_fd = -1;
+            --cached_fds_;
+            releaseKeptFds(1);
+            slot.primed = false;
+        }
+    }
+
+    if (slot.stat_fd < 0) {
+        std::snprintf(path_, sizeof(path_), "%u/stat", slot.pid);
+        int fd = openat(proc_fd_, path_, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+        length = pread(fd, stat_buffer_.data(), stat_buffer_.size() - 1, 0);
+        if (length > 0 && cached_fds_ < fd_budget_ && reserveKeptFds(1)) {
+            slot.stat_fd = fd;
+            ++cached_fds_;
+        } else {
+            ::close(fd);
+        }
+    }
+
+    if (length <= 0) {
+        return false;
+    }
+    stat_buffer_[static_cast<size_t>(length)] = '\0';
+    return true;
+}
+
+void ProcessCollector::release(uint32_t index) {
+    Slot& slot = slots_[index];
+    if (slot.stat_fd >= 0) {
+        ::close(slot.stat_fd);
+        --cached_fds_;
+        releaseKeptFds(1);
+    }
+    index_.erase(slot.pid);
+    slot = Slot();
+    free_slots_.push_back(index);
+}
+
+void ProcessCollector::fillTop(std::vector<ProcessInfo>& top, bool by_cpu) {
+    order_.clear();
+    for (uint32_t i = 0; i < slots_.size(); ++i) {
+        if (slots_[i].pid != 0) {
+            order_.push_back(i);
+        }
+    }
+
+    // Only the first N need to be ordered; ties go to the lower pid so
+    // rows don't swap places between scans
+    size_t count = std::min(top_n_, order_.size());
+    std::partial_sort(order_.begin(), order_.begin() + static_cast<std::ptrdiff_t>(count), order_.end(),
+                      [this, by_cpu](uint32_t a, uint32_t b) {
+        const Slot& left = slots_[a];
+        const Slot& right = slots_[b];
+        if (by_cpu && left.cpu_percent != right.cpu_percent) {
+            return left.cpu_percent > right.cpu_percent;
+        }
+        if (left.rss_pages != right.rss_pages) {
+            return left.rss_pages > right.rss_pages;
+        }
+        return left.pid < right.pid;
+    });
+
+    uint64_t page_size = static_cast<uint64_t>(page_size_ > 0 ? page_size_ : 4096);
+    top.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        const Slot& slot = slots_[order_[i]];
+        top[i].pid = slot.pid;
+        top[i].name = slot.name;
+        top[i].cpu_percent = slot.cpu_percent;
+        top[i].rss_bytes = slot.rss_pages * page_size;
+    }
+}
+
+} // namespace platform
+} // namespace resmon
@@ -0,0 +1,122 @@
+#ifndef RESMON_BACKEND_LINUX_PROCESS_LINUX_H
+#define RESMON_BACKEND_LINUX_PROCESS_LINUX_H
+
+#include "../../core/metrics.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace resmon {
+namespace platform {
+
+// Open-addressing hash map from pid to a slot index. Keys and values live
+// in two flat arrays (linear probing, backward-shift deletion), so lookups
+// touch one or two cache lines and nothing is allocated per pid.
+class PidSlotMap {
+public:
+    static constexpr uint32_t NOT_FOUND = UINT32_MAX;
+
+    PidSlotMap();
+
+    uint32_t find(uint32_t pid) const;
+    void insert(uint32_t pid, uint32_t slot);
+    void erase(uint32_t pid);
+    size_t size() const { return size_; }
+
+private:
+    size_t home(uint32_t pid) const;
+    void grow();
+
+    std::vector<uint32_t> keys_;    // 0 = empty (pid 0 never appears in /proc)
+    std::vector<uint32_t> slots_;
+    size_t mask_;
+    size_t size_;
+};
+
+// Per-process CPU usage and resident memory for the whole host, reduced to
+// the top N by CPU and by RSS.
+//
+// A scan lists /proc with getdents64() on a directory fd opened once, and
+// reads each /proc/<pid>/stat through a descriptor opened with openat()
+// relative to it. Those descriptors are kept while the process lives, so a
+// known pid costs one pread() per scan; past the descriptor budget (half of
+// keptFdLimit(), shared with the other collectors that keep files open)
+// the remaining pids are opened, read and closed every scan instead.
+// Previous CPU times are kept per pid in a PidSlotMap. Scans do not
+// allocate once the tables have grown to the host's process count.
+//
+// On large hosts most pids are past the budget, so their open/read/close
+// dominates: resmon_bench measures about 115-130 ms per scan of 20000
+// processes (121 ms typical), well short of the few-milliseconds target.
+//
+// A kept descriptor refers to the process, not the pid number: once the
+// process exits its reads fail with ESRCH even if the pid is reused, and
+// the slot starts over.
+class ProcessCollector {
+public:
+    static constexpr size_t DEFAULT_TOP_N = 20;
+
+    // root: prefix for /proc (empty = the real filesystem)
+    explicit ProcessCollector(const std::string& root = std::string(), size_t top_n = DEFAULT_TOP_N);
+    ~ProcessCollector();
+
+    // Non-copyable (owns file descriptors)
+    ProcessCollector(const ProcessCollector&) = delete;
+    ProcessCollector& operator=(const ProcessCollector&) = delete;
+
+    // Scan /proc. CPU% covers the time since the previous scan (0 for a
+    // process's first one).
+    ProcessMetrics collect();
+
+    // False if <root>/proc could not be opened
+    bool isAvailable() const { return proc_fd_ >= 0; }
+
+    // Descriptors currently held for /proc/<pid>/stat
+    size_t cachedFds() const { return cached_fds_; }
+
+private:
+    struct Slot {
+        uint32_t pid = 0;          // 0 = free
+        int stat_fd = -1;          // kept /proc/<pid>/stat, -1 past the budget
+        uint32_t scan = 0;         // last scan that listed the pid
+        bool primed = false;       // ticks holds a previous reading
+        uint64_t ticks = 0;        // utime + stime
+        uint64_t rss_pages = 0;
+        float cpu_percent = 0.0f;
+        char name[16] = {};        // comm, NUL-terminated
+    };
+
+    // Read and parse one stat file into slot; false if the process is gone
+    bool readSlot(Slot& slot, double elapsed_seconds);
+    bool readStat(Slot& slot);
+    void release(uint32_t index);
+    void fillTop(std::vector<ProcessInfo>& top, bool by_cpu);
+
+    int proc_fd_;
+    size_t top_n_;
+    size_t fd_budget_;
+    size_t cached_fds_;
+    long ticks_per_second_;
+    long page_size_;
+
+    std::vector<char> dirents_;      // getdents64() buffer
+    std::vector<char> stat_buffer_;
+    char path_[32];                  // "<pid>/stat", relative to proc_fd_
+
+    PidSlotMap index_;
+    std::vector<Slot> slots_;
+    std::vector<uint32_t> free_slots_;
+    std::vector<uint32_t> order_;    // scratch for the top-N sorts
+
+    uint32_t scan_;
+    bool has_previous_;
+    std::chrono::steady_clock::time_point prev_time_;
+};
+
+} // namespace platform
+} // namespace resmon
+
+#endif // RESMON_BACKEND_LINUX_PROCESS_LINUX_H
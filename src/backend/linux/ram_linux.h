@@ -2,18 +2,23 @@
 #define RESMON_BACKEND_LINUX_RAM_LINUX_H
 
 #include "../../core/metrics.h"
+#include "cached_file.h"
+
+#include <string>
 
 namespace resmon {
 namespace platform {
 
 class RamCollector {
 public:
+    // root: prefix for /proc (empty = the real filesystem)
+    explicit RamCollector(const std::string& root = std::string());
+
     RamMetrics collect();
 
 private:
-    // Parse a line from /proc/meminfo and extract the value in kB
-    // Returns 0 if parsing fails
-    uint64_t parseMemInfoLine(const std::string& line);
+    // /proc/meminfo, kept open between samples
+    CachedFile meminfo_file_;
 };
 
 } // namespace platform
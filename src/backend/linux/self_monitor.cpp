@@ -0,0 +1,45 @@
+#include "self_monitor.h"
+#include "proc_parse.h"
+
+#include <unistd.h>
+
+namespace resmon {
+namespace platform {
+
+SelfMonitor::SelfMonitor()
+    : stat_file_("/proc/self/stat")
+    , ticks_per_second_(sysconf(_SC_CLK_TCK))
+    , page_size_(sysconf(_SC_PAGESIZE))
+    , has_previous_(false)
+    , prev_ticks_(0)
+{
+}
+
+bool SelfMonitor::sample(float& cpu_percent, uint64_t& rss_bytes) {
+    cpu_percent = 0.0f;
+    rss_bytes = 0;
+
+    ProcPidStat stat;
+    if (!stat_file_.read() || !parseProcPidStat(stat_file_.contents(), stat)) {
+        return false;
+    }
+    auto now = std::chrono::steady_clock::now();
+    uint64_t ticks = stat.utime + stat.stime;
+
+    if (has_previous_ && ticks_per_second_ > 0 && ticks >= prev_ticks_) {
+        double elapsed = std::chrono::duration<double>(now - prev_time_).count();
+        if (elapsed > 0.0) {
+            double cpu_seconds = static_cast<double>(ticks - prev_ticks_) / static_cast<double>(ticks_per_second_);
+            cpu_percent = static_cast<float>(100.0 * cpu_seconds / elapsed);
+        }
+    }
+    prev_ticks_ = ticks;
+    prev_time_ = now;
+    has_previous_ = true;
+
+    rss_bytes = stat.rss_pages * static_cast<uint64_t>(page_size_ > 0 ? page_size_ : 4096);
+    return true;
+}
+
+} // namespace platform
+} // namespace resmon
@@ -0,0 +1,35 @@
+#ifndef RESMON_BACKEND_LINUX_SELF_MONITOR_H
+#define RESMON_BACKEND_LINUX_SELF_MONITOR_H
+
+#include "cached_file.h"
+
+#include <chrono>
+#include <cstdint>
+
+namespace resmon {
+namespace platform {
+
+// resmon's own CPU usage and resident memory, from /proc/self/stat
+class SelfMonitor {
+public:
+    SelfMonitor();
+
+    // CPU time used by the whole process since the previous call, as a
+    // percentage of one core (0 on the first call), and the current RSS.
+    // Returns false if /proc/self/stat could not be read.
+    bool sample(float& cpu_percent, uint64_t& rss_bytes);
+
+private:
+    CachedFile stat_file_;
+    long ticks_per_second_;
+    long page_size_;
+
+    bool has_previous_;
+    uint64_t prev_ticks_;
+    std::chrono::steady_clock::time_point prev_time_;
+};
+
+} // namespace platform
+} // namespace resmon
+
+#endif // RESMON_BACKEND_LINUX_SELF_MONITOR_H
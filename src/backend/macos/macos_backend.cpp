@@ -12,6 +12,7 @@ MacOSBackend::MacOSBackend()
 
 SystemMetrics MacOSBackend::collect() {
     SystemMetrics metrics;
+    metrics.timestamp_ms = wallClockMillis();
 
     // Collect CPU metrics
     metrics.cpu = cpu_collector_.collect();
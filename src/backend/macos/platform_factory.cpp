@@ -3,7 +3,9 @@
 
 namespace resmon {
 
-std::unique_ptr<IMetricsBackend> createPlatformBackend() {
+std::unique_ptr<IMetricsBackend> createPlatformBackend(const BackendOptions& /*options*/) {
+    // The macOS collectors are cheap IOKit/mach calls, so parallel
+    // collection is not implemented here
     return std::make_unique<platform::MacOSBackend>();
 }
 
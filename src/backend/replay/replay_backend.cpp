@@ -0,0 +1,78 @@
+#include "replay_backend.h"
+
+#include <iostream>
+#include <utility>
+
+namespace resmon {
+
+ReplayBackend::ReplayBackend(double speed)
+    : speed_(speed > 0.0 ? speed : 0.0)
+    , next_()
+    , has_next_(false)
+    , started_(false)
+    , base_timestamp_ms_(0)
+    , last_timestamp_ms_(0)
+{
+}
+
+bool ReplayBackend::open(const std::string& path) {
+    if (!reader_.open(path)) {
+        error_ = reader_.error();
+        return false;
+    }
+    has_next_ = reader_.next(next_);
+    if (!has_next_) {
+        error_ = path + " holds no samples";
+        return false;
+    }
+    started_ = false;
+    return true;
+}
+
+SystemMetrics ReplayBackend::collect() {
+    if (!has_next_) {
+        return SystemMetrics{};
+    }
+
+    SystemMetrics metrics = std::move(next_);
+    has_next_ = reader_.next(next_);
+
+    if (!started_) {
+        started_ = true;
+        base_time_ = std::chrono::steady_clock::now();
+        base_timestamp_ms_ = metrics.timestamp_ms;
+    }
+    last_timestamp_ms_ = metrics.timestamp_ms;
+    return metrics;
+}
+
+bool ReplayBackend::nextSampleDue(std::chrono::steady_clock::time_point& due) {
+    auto now = std::chrono::steady_clock::now();
+    if (speed_ == 0.0 || !has_next_ || !started_) {
+        due = now;
+        return true;
+    }
+
+    // Restart the clock across recording gaps and wall-clock steps
+    uint64_t next_ms = next_.timestamp_ms;
+    if (next_ms < last_timestamp_ms_ || next_ms - last_timestamp_ms_ > MAX_GAP_MS) {
+        base_time_ = now;
+        base_timestamp_ms_ = next_ms;
+    }
+
+    std::chrono::duration<double, std::milli> offset(
+        static_cast<double>(next_ms - base_timestamp_ms_) / speed_);
+    due = base_time_ + std::chrono::duration_cast<std::chrono::steady_clock::duration>(offset);
+    return true;
+}
+
+std::unique_ptr<IMetricsBackend> createReplayBackend(const std::string& path, double speed) {
+    auto backend = std::make_unique<ReplayBackend>(speed);
+    if (!backend->open(path)) {
+        std::cerr << "resmon: " << backend->error() << "\n";
+        return nullptr;
+    }
+    return backend;
+}
+
+} // namespace resmon
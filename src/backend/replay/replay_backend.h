@@ -0,0 +1,56 @@
+#ifndef RESMON_BACKEND_REPLAY_REPLAY_BACKEND_H
+#define RESMON_BACKEND_REPLAY_REPLAY_BACKEND_H
+
+#include "../../core/backend.h"
+#include "../../archive/metric_archive.h"
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+namespace resmon {
+
+// Plays back a recorded archive (see MetricArchiveWriter) in place of the
+// live collectors. Samples keep their recorded timestamps. The backend
+// paces itself through nextSampleDue(): at the recorded rate scaled by
+// speed, or back to back when speed is 0.
+class ReplayBackend : public IMetricsBackend {
+public:
+    // speed: 1 = as recorded, 2 = twice as fast, 0 = as fast as possible
+    explicit ReplayBackend(double speed = 1.0);
+    ~ReplayBackend() override = default;
+
+    // Returns false (see error()) if the file is not an archive or holds
+    // no samples
+    bool open(const std::string& path);
+    const std::string& error() const { return error_; }
+
+    SystemMetrics collect() override;
+    bool nextSampleDue(std::chrono::steady_clock::time_point& due) override;
+    bool exhausted() const override { return !has_next_; }
+
+private:
+    // Recorded gaps longer than this (resmon was not running) are skipped
+    // instead of being waited out
+    static constexpr uint64_t MAX_GAP_MS = 60 * 1000;
+
+    MetricArchiveReader reader_;
+    double speed_;
+    std::string error_;
+
+    SystemMetrics next_;     // read ahead so the next due time is known
+    bool has_next_;
+
+    // Wall time at which the sample recorded at base_timestamp_ms_ played
+    bool started_;
+    std::chrono::steady_clock::time_point base_time_;
+    uint64_t base_timestamp_ms_;
+    uint64_t last_timestamp_ms_;
+};
+
+// Open a replay backend, or print why not and return null
+std::unique_ptr<IMetricsBackend> createReplayBackend(const std::string& path, double speed);
+
+} // namespace resmon
+
+#endif // RESMON_BACKEND_REPLAY_REPLAY_BACKEND_H
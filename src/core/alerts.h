@@ -11,12 +11,24 @@ struct AlertThreshold {
     bool enabled = true;
 };
 
+// Window of the kernel pressure triggers
+constexpr unsigned PRESSURE_WINDOW_MS = 1000;
+
 struct AlertConfig {
     AlertThreshold cpu_usage{80.0f, 95.0f};
     AlertThreshold cpu_temp{70.0f, 85.0f};
     AlertThreshold gpu_usage{80.0f, 95.0f};
     AlertThreshold gpu_temp{75.0f, 90.0f};
     AlertThreshold ram_usage{80.0f, 95.0f};
+    AlertThreshold disk_utilization{80.0f, 95.0f};
+    AlertThreshold disk_await_ms{50.0f, 200.0f};
+
+    // Pressure stalls ("some" share of time, %). Backends with PSI triggers
+    // also register these with the kernel, over PRESSURE_WINDOW_MS, to be
+    // woken as soon as one is crossed.
+    AlertThreshold cpu_pressure{25.0f, 60.0f};
+    AlertThreshold memory_pressure{15.0f, 40.0f};
+    AlertThreshold io_pressure{25.0f, 60.0f};
 };
 
 } // namespace resmon
@@ -1,8 +1,12 @@
 #ifndef RESMON_CORE_BACKEND_H
 #define RESMON_CORE_BACKEND_H
 
+#include <chrono>
+#include <functional>
 #include <memory>
+#include <string>
 
+#include "alerts.h"
 #include "metrics.h"
 
 namespace resmon {
@@ -11,9 +15,47 @@ class IMetricsBackend {
 public:
     virtual ~IMetricsBackend() = default;
     virtual SystemMetrics collect() = 0;
+
+    // Backends that replay a recording set their own pace: they store when
+    // the next collect() is due and return true. Live backends return false
+    // and are sampled at the sampler's interval.
+    virtual bool nextSampleDue(std::chrono::steady_clock::time_point& due) {
+        (void)due;
+        return false;
+    }
+
+    // True once a finite source (a replay) has delivered its last sample
+    virtual bool exhausted() const { return false; }
+
+    // Backends the kernel can notify between samples (PSI triggers) register
+    // the thresholds of config and call wake, from any thread, when one is
+    // crossed; the caller then samples right away instead of at the next
+    // interval. Called once, before sampling starts.
+    virtual void watchThresholds(const AlertConfig& config, std::function<void()> wake) {
+        (void)config;
+        (void)wake;
+    }
+};
+
+struct BackendOptions {
+    // Run the CPU, RAM, per-vendor GPU and process collectors concurrently on a
+    // small worker pool instead of one after another (Linux only)
+    bool parallel_collection = false;
+
+    // In parallel mode, how long collect() waits for slow collectors.
+    // A collector that misses the deadline contributes its previous result.
+    std::chrono::milliseconds collect_deadline{250};
+
+    // Prefix for every /proc and /sys path the collectors read, e.g. a
+    // generated fixture tree. Empty = the real filesystem (Linux only).
+    std::string fs_root;
+
+    // NVML library to load instead of libnvidia-ml.so.1, e.g. a stub for
+    // benchmarking (Linux only)
+    std::string nvml_library;
 };
 
-std::unique_ptr<IMetricsBackend> createPlatformBackend();
+std::unique_ptr<IMetricsBackend> createPlatformBackend(const BackendOptions& options = BackendOptions());
 
 } // namespace resmon
 
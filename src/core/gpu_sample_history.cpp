@@ -0,0 +1,142 @@
+#include "core/gpu_sample_history.h"
+
+#include <algorithm>
+
+namespace resmon {
+
+GpuSampleHistory::GpuSampleHistory(size_t capacity, size_t max_gpus)
+    : capacity_(capacity > 0 ? capacity : 1)
+    , max_gpus_(max_gpus)
+    , rings_(GPU_SAMPLE_SERIES_COUNT * max_gpus)
+    , timestamps_(rings_.size() * capacity_, 0)
+    , values_(rings_.size() * capacity_, 0.0f)
+{
+}
+
+size_t GpuSampleHistory::ringIndex(GpuSampleSeries series, size_t gpu) const {
+    return gpu * GPU_SAMPLE_SERIES_COUNT + static_cast<size_t>(series);
+}
+
+size_t GpuSampleHistory::physicalIndex(const Ring& ring, size_t logical) const {
+    size_t oldest = (ring.head + capacity_ - ring.size) % capacity_;
+    return (oldest + logical) % capacity_;
+}
+
+void GpuSampleHistory::append(const SystemMetrics& metrics) {
+    size_t gpus = std::min(metrics.gpus.size(), max_gpus_);
+    for (size_t gpu = 0; gpu < gpus; ++gpu) {
+        const GpuMetrics& g = metrics.gpus[gpu];
+        appendSamples(ringIndex(GpuSampleSeries::Utilization, gpu), g.utilization_samples);
+        appendSamples(ringIndex(GpuSampleSeries::Power, gpu), g.power_samples);
+    }
+}
+
+void GpuSampleHistory::appendSamples(size_t ring_index, const std::vector<GpuSample>& samples) {
+    Ring& ring = rings_[ring_index];
+    uint64_t* timestamps = timestamps_.data() + ring_index * capacity_;
+    float* values = values_.data() + ring_index * capacity_;
+
+    for (const GpuSample& sample : samples) {
+        if (ring.size > 0 && sample.timestamp_us <= timestamps[physicalIndex(ring, ring.size - 1)]) {
+            continue;
+        }
+        timestamps[ring.head] = sample.timestamp_us;
+        values[ring.head] = sample.value;
+        ring.head = (ring.head + 1) % capacity_;
+        if (ring.size < capacity_) {
+            ++ring.size;
+        }
+    }
+}
+
+void GpuSampleHistory::clear() {
+    for (Ring& ring : rings_) {
+        ring = Ring();
+    }
+}
+
+size_t GpuSampleHistory::size(GpuSampleSeries series, size_t gpu) const {
+    return gpu < max_gpus_ ? rings_[ringIndex(series, gpu)].size : 0;
+}
+
+uint64_t GpuSampleHistory::newest(GpuSampleSeries series, size_t gpu) const {
+    if (gpu >= max_gpus_) {
+        return 0;
+    }
+    size_t index = ringIndex(series, gpu);
+    const Ring& ring = rings_[index];
+    return ring.size > 0 ? timestamps_[index * capacity_ + physicalIndex(ring, ring.size - 1)] : 0;
+}
+
+HistoryRange GpuSampleHistory::range(GpuSampleSeries series, size_t gpu, uint64_t from_us, uint64_t to_us) const {
+    if (gpu >= max_gpus_) {
+        return HistoryRange();
+    }
+    size_t index = ringIndex(series, gpu);
+    const Ring& ring = rings_[index];
+    const uint64_t* timestamps = timestamps_.data() + index * capacity_;
+    auto at = [&](size_t logical) { return timestamps[physicalIndex(ring, logical)]; };
+
+    size_t lo = 0;
+    size_t hi = ring.size;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (at(mid) < from_us) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    size_t begin = lo;
+
+    hi = ring.size;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (at(mid) <= to_us) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return HistoryRange{begin, lo - begin};
+}
+
+template <typename T>
+RingView<T> GpuSampleHistory::view(const T* column, const Ring& ring, HistoryRange range) const {
+    RingView<T> result;
+    if (range.begin >= ring.size) {
+        return result;
+    }
+    range.count = std::min(range.count, ring.size - range.begin);
+    if (range.count == 0) {
+        return result;
+    }
+
+    size_t start = physicalIndex(ring, range.begin);
+    size_t until_wrap = capacity_ - start;
+    result.first = column + start;
+    result.first_count = std::min(range.count, until_wrap);
+    if (range.count > until_wrap) {
+        result.second = column;
+        result.second_count = range.count - until_wrap;
+    }
+    return result;
+}
+
+RingView<uint64_t> GpuSampleHistory::timestamps(GpuSampleSeries series, size_t gpu, HistoryRange range) const {
+    if (gpu >= max_gpus_) {
+        return RingView<uint64_t>();
+    }
+    size_t index = ringIndex(series, gpu);
+    return view(timestamps_.data() + index * capacity_, rings_[index], range);
+}
+
+RingView<float> GpuSampleHistory::values(GpuSampleSeries series, size_t gpu, HistoryRange range) const {
+    if (gpu >= max_gpus_) {
+        return RingView<float>();
+    }
+    size_t index = ringIndex(series, gpu);
+    return view(values_.data() + index * capacity_, rings_[index], range);
+}
+
+} // namespace resmon
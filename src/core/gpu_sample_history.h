@@ -0,0 +1,73 @@
+#ifndef RESMON_CORE_GPU_SAMPLE_HISTORY_H
+#define RESMON_CORE_GPU_SAMPLE_HISTORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "history.h"
+#include "metrics.h"
+
+namespace resmon {
+
+enum class GpuSampleSeries {
+    Utilization,
+    Power,
+};
+
+static constexpr size_t GPU_SAMPLE_SERIES_COUNT = 2;
+
+// Sub-second GPU history built from the driver samples carried in
+// GpuMetrics (utilization_samples, power_samples). Unlike HistoryStore,
+// which keeps one row per collected sample, every series here is its own
+// ring of (timestamp, value) pairs, because drivers sample each quantity
+// at its own rate. Samples keep the driver's timestamps; ones at or before
+// the newest already stored are dropped, so overlapping reads are
+// harmless. All memory is allocated in the constructor.
+class GpuSampleHistory {
+public:
+    GpuSampleHistory(size_t capacity, size_t max_gpus);
+
+    // Non-copyable (large)
+    GpuSampleHistory(const GpuSampleHistory&) = delete;
+    GpuSampleHistory& operator=(const GpuSampleHistory&) = delete;
+
+    void append(const SystemMetrics& metrics);
+    void clear();
+
+    size_t size(GpuSampleSeries series, size_t gpu) const;
+    size_t capacity() const { return capacity_; }
+    size_t maxGpus() const { return max_gpus_; }
+
+    // Timestamp of the newest sample, 0 if there is none
+    uint64_t newest(GpuSampleSeries series, size_t gpu) const;
+
+    // Samples with from_us <= timestamp <= to_us (binary search, no copy)
+    HistoryRange range(GpuSampleSeries series, size_t gpu, uint64_t from_us, uint64_t to_us) const;
+
+    RingView<uint64_t> timestamps(GpuSampleSeries series, size_t gpu, HistoryRange range) const;
+    RingView<float> values(GpuSampleSeries series, size_t gpu, HistoryRange range) const;
+
+private:
+    struct Ring {
+        size_t head = 0;   // physical index of the next write
+        size_t size = 0;
+    };
+
+    size_t ringIndex(GpuSampleSeries series, size_t gpu) const;
+    size_t physicalIndex(const Ring& ring, size_t logical) const;
+    void appendSamples(size_t ring_index, const std::vector<GpuSample>& samples);
+
+    template <typename T>
+    RingView<T> view(const T* column, const Ring& ring, HistoryRange range) const;
+
+    size_t capacity_;
+    size_t max_gpus_;
+    std::vector<Ring> rings_;            // GPU_SAMPLE_SERIES_COUNT per GPU slot
+    std::vector<uint64_t> timestamps_;   // ring * capacity_ + slot
+    std::vector<float> values_;
+};
+
+} // namespace resmon
+
+#endif // RESMON_CORE_GPU_SAMPLE_HISTORY_H
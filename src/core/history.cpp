@@ -0,0 +1,161 @@
+#include "core/history.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace resmon {
+
+size_t seriesColumn(HistorySeries series, size_t gpu) {
+    switch (series) {
+        case HistorySeries::CpuUsage:   return 0;
+        case HistorySeries::CpuTemp:    return 1;
+        case HistorySeries::RamUsage:   return 2;
+        case HistorySeries::GpuUsage:   return HOST_SERIES_COUNT + gpu * GPU_SERIES_PER_GPU + 0;
+        case HistorySeries::GpuTemp:    return HOST_SERIES_COUNT + gpu * GPU_SERIES_PER_GPU + 1;
+        case HistorySeries::GpuVramMiB: return HOST_SERIES_COUNT + gpu * GPU_SERIES_PER_GPU + 2;
+    }
+    return 0;
+}
+
+bool isGpuSeries(HistorySeries series) {
+    return series == HistorySeries::GpuUsage ||
+           series == HistorySeries::GpuTemp ||
+           series == HistorySeries::GpuVramMiB;
+}
+
+void extractSeriesValues(const SystemMetrics& metrics, size_t max_gpus, float* out) {
+    const float missing = std::numeric_limits<float>::quiet_NaN();
+
+    out[seriesColumn(HistorySeries::CpuUsage, 0)] = metrics.cpu.usage_percent;
+    out[seriesColumn(HistorySeries::CpuTemp, 0)] =
+        metrics.cpu.temperature_celsius >= 0 ? metrics.cpu.temperature_celsius : missing;
+    out[seriesColumn(HistorySeries::RamUsage, 0)] = metrics.ram.usage_percent;
+
+    for (size_t gpu = 0; gpu < max_gpus; ++gpu) {
+        float usage = missing;
+        float temp = missing;
+        float vram = missing;
+        if (gpu < metrics.gpus.size()) {
+            const GpuMetrics& g = metrics.gpus[gpu];
+            usage = g.usage_percent;
+            temp = g.temperature_celsius >= 0 ? g.temperature_celsius : missing;
+            vram = static_cast<float>(static_cast<double>(g.vram_used_bytes) / (1024.0 * 1024.0));
+        }
+        out[seriesColumn(HistorySeries::GpuUsage, gpu)] = usage;
+        out[seriesColumn(HistorySeries::GpuTemp, gpu)] = temp;
+        out[seriesColumn(HistorySeries::GpuVramMiB, gpu)] = vram;
+    }
+}
+
+HistoryStore::HistoryStore(size_t capacity, size_t max_gpus)
+    : capacity_(capacity > 0 ? capacity : 1)
+    , max_gpus_(max_gpus)
+    , head_(0)
+    , size_(0)
+    , timestamps_(capacity_, 0)
+    , values_(capacity_ * seriesColumnCount(max_gpus_),
+              std::numeric_limits<float>::quiet_NaN())
+    , scratch_(seriesColumnCount(max_gpus_))
+{
+}
+
+size_t HistoryStore::bytesPerSample(size_t max_gpus) {
+    return sizeof(uint64_t) + sizeof(float) * seriesColumnCount(max_gpus);
+}
+
+size_t HistoryStore::capacityForBudget(size_t budget_bytes, size_t max_gpus) {
+    return budget_bytes / bytesPerSample(max_gpus);
+}
+
+size_t HistoryStore::physicalIndex(size_t logical) const {
+    // Oldest retained sample sits just after the newest once the ring is full
+    size_t oldest = (head_ + capacity_ - size_) % capacity_;
+    return (oldest + logical) % capacity_;
+}
+
+void HistoryStore::append(const SystemMetrics& metrics) {
+    const size_t slot = head_;
+    const size_t columns = scratch_.size();
+
+    timestamps_[slot] = metrics.timestamp_ms;
+    extractSeriesValues(metrics, max_gpus_, scratch_.data());
+    for (size_t column = 0; column < columns; ++column) {
+        values_[column * capacity_ + slot] = scratch_[column];
+    }
+
+    head_ = (head_ + 1) % capacity_;
+    if (size_ < capacity_) {
+        ++size_;
+    }
+}
+
+void HistoryStore::clear() {
+    head_ = 0;
+    size_ = 0;
+}
+
+HistoryRange HistoryStore::range(uint64_t from_ms, uint64_t to_ms) const {
+    // Timestamps are appended in order, so both ends are a binary search
+    size_t lo = 0;
+    size_t hi = size_;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (timestampAt(mid) < from_ms) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    size_t begin = lo;
+
+    hi = size_;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (timestampAt(mid) <= to_ms) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return HistoryRange{begin, lo - begin};
+}
+
+HistoryRange HistoryStore::latest(size_t count) const {
+    count = std::min(count, size_);
+    return HistoryRange{size_ - count, count};
+}
+
+template <typename T>
+RingView<T> HistoryStore::view(const T* column, HistoryRange range) const {
+    RingView<T> result;
+    if (range.begin >= size_) {
+        return result;
+    }
+    range.count = std::min(range.count, size_ - range.begin);
+    if (range.count == 0) {
+        return result;
+    }
+
+    size_t start = physicalIndex(range.begin);
+    size_t until_wrap = capacity_ - start;
+    result.first = column + start;
+    result.first_count = std::min(range.count, until_wrap);
+    if (range.count > until_wrap) {
+        result.second = column;
+        result.second_count = range.count - until_wrap;
+    }
+    return result;
+}
+
+RingView<uint64_t> HistoryStore::timestamps(HistoryRange range) const {
+    return view(timestamps_.data(), range);
+}
+
+RingView<float> HistoryStore::series(HistorySeries series, HistoryRange range, size_t gpu) const {
+    if (isGpuSeries(series) && gpu >= max_gpus_) {
+        return RingView<float>();
+    }
+    return view(values_.data() + seriesColumn(series, gpu) * capacity_, range);
+}
+
+} // namespace resmon
@@ -0,0 +1,118 @@
+#ifndef RESMON_CORE_HISTORY_H
+#define RESMON_CORE_HISTORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "metrics.h"
+
+namespace resmon {
+
+// The series kept per sample. GPU series exist once per GPU slot.
+enum class HistorySeries {
+    CpuUsage,
+    CpuTemp,
+    RamUsage,
+    GpuUsage,
+    GpuTemp,
+    GpuVramMiB,
+};
+
+// Series are laid out as columns: the host series first, then
+// GPU_SERIES_PER_GPU columns for each GPU slot
+static constexpr size_t HOST_SERIES_COUNT = 3;
+static constexpr size_t GPU_SERIES_PER_GPU = 3;
+
+inline size_t seriesColumnCount(size_t max_gpus) {
+    return HOST_SERIES_COUNT + GPU_SERIES_PER_GPU * max_gpus;
+}
+
+// Column of a series; gpu is ignored for host series
+size_t seriesColumn(HistorySeries series, size_t gpu);
+
+bool isGpuSeries(HistorySeries series);
+
+// Write every series value of a sample into out[seriesColumnCount(max_gpus)].
+// Missing values (absent GPU, unavailable temperature) become NaN.
+void extractSeriesValues(const SystemMetrics& metrics, size_t max_gpus, float* out);
+
+// Read-only view of a run of ring-buffer elements. The run may wrap around
+// the end of the ring, so it is exposed as up to two contiguous spans.
+// Views point straight into the store and are invalidated by append().
+template <typename T>
+struct RingView {
+    const T* first = nullptr;
+    size_t first_count = 0;
+    const T* second = nullptr;
+    size_t second_count = 0;
+
+    size_t size() const { return first_count + second_count; }
+    bool empty() const { return size() == 0; }
+
+    T operator[](size_t i) const {
+        return i < first_count ? first[i] : second[i - first_count];
+    }
+};
+
+// Logical range of samples, 0 = oldest retained sample
+struct HistoryRange {
+    size_t begin = 0;
+    size_t count = 0;
+};
+
+// Fixed-capacity time-series history of every metric, stored as a struct
+// of arrays: one contiguous ring column per series plus a shared timestamp
+// column. All memory is allocated in the constructor; append() is O(1) and
+// never allocates. Values missing from a sample (e.g. a GPU that vanished,
+// an unavailable temperature) are stored as NaN.
+class HistoryStore {
+public:
+    HistoryStore(size_t capacity, size_t max_gpus);
+
+    // Non-copyable (large)
+    HistoryStore(const HistoryStore&) = delete;
+    HistoryStore& operator=(const HistoryStore&) = delete;
+
+    // Capacity that fits a memory budget with max_gpus GPU slots
+    static size_t capacityForBudget(size_t budget_bytes, size_t max_gpus);
+
+    // Bytes used per retained sample
+    static size_t bytesPerSample(size_t max_gpus);
+
+    void append(const SystemMetrics& metrics);
+    void clear();
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+    size_t maxGpus() const { return max_gpus_; }
+
+    // Samples with from_ms <= timestamp <= to_ms (binary search, no copy)
+    HistoryRange range(uint64_t from_ms, uint64_t to_ms) const;
+
+    // The newest count samples (or fewer if not yet recorded)
+    HistoryRange latest(size_t count) const;
+
+    RingView<uint64_t> timestamps(HistoryRange range) const;
+    RingView<float> series(HistorySeries series, HistoryRange range, size_t gpu = 0) const;
+
+private:
+    size_t physicalIndex(size_t logical) const;
+    uint64_t timestampAt(size_t logical) const { return timestamps_[physicalIndex(logical)]; }
+
+    template <typename T>
+    RingView<T> view(const T* column, HistoryRange range) const;
+
+    size_t capacity_;
+    size_t max_gpus_;
+    size_t head_;     // physical index of the next write
+    size_t size_;
+
+    std::vector<uint64_t> timestamps_;   // capacity_ entries
+    std::vector<float> values_;          // column-major: column * capacity_ + slot
+    std::vector<float> scratch_;         // one row, reused by append()
+};
+
+} // namespace resmon
+
+#endif // RESMON_CORE_HISTORY_H
@@ -0,0 +1,87 @@
+#ifndef RESMON_CORE_LATENCY_HISTOGRAM_H
+#define RESMON_CORE_LATENCY_HISTOGRAM_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace resmon {
+
+// Fixed-size log-linear histogram of durations in nanoseconds. Each power
+// of two is split into 4 sub-buckets, so any reported percentile is within
+// 12.5% of the true value. record() is a few integer ops and never
+// allocates; the histogram is not thread-safe.
+class LatencyHistogram {
+public:
+    static constexpr size_t BUCKETS = 256;
+
+    void record(uint64_t ns) {
+        ++counts_[bucketFor(ns)];
+        ++count_;
+        sum_ns_ += ns;
+        last_ns_ = ns;
+        if (ns > max_ns_) {
+            max_ns_ = ns;
+        }
+    }
+
+    void reset() { *this = LatencyHistogram(); }
+
+    uint64_t count() const { return count_; }
+    uint64_t lastNs() const { return last_ns_; }
+    uint64_t maxNs() const { return max_ns_; }
+    double meanNs() const { return count_ > 0 ? static_cast<double>(sum_ns_) / static_cast<double>(count_) : 0.0; }
+
+    // Duration below which a fraction p (0-1) of the recordings fall,
+    // reported as the midpoint of the bucket it lands in
+    uint64_t percentileNs(double p) const {
+        if (count_ == 0) {
+            return 0;
+        }
+        uint64_t rank = static_cast<uint64_t>(p * static_cast<double>(count_));
+        if (rank >= count_) {
+            rank = count_ - 1;
+        }
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            seen += counts_[i];
+            if (seen > rank) {
+                uint64_t low = bucketLow(i);
+                uint64_t high = i + 1 < BUCKETS ? bucketLow(i + 1) : max_ns_;
+                uint64_t mid = low + (high - low) / 2;
+                return mid < max_ns_ ? mid : max_ns_;
+            }
+        }
+        return max_ns_;
+    }
+
+private:
+    // Values 0-3 map to themselves; above that the bucket is 4 per
+    // power of two, chosen by the two bits after the leading one
+    static size_t bucketFor(uint64_t ns) {
+        if (ns < 4) {
+            return static_cast<size_t>(ns);
+        }
+        unsigned msb = 63 - static_cast<unsigned>(__builtin_clzll(ns));
+        unsigned sub = static_cast<unsigned>(ns >> (msb - 2)) & 3;
+        return (msb - 1) * 4 + sub;
+    }
+
+    static uint64_t bucketLow(size_t bucket) {
+        if (bucket < 4) {
+            return bucket;
+        }
+        unsigned msb = static_cast<unsigned>(bucket / 4) + 1;
+        uint64_t sub = bucket % 4;
+        return (4 + sub) << (msb - 2);
+    }
+
+    uint32_t counts_[BUCKETS] = {};
+    uint64_t count_ = 0;
+    uint64_t sum_ns_ = 0;
+    uint64_t last_ns_ = 0;
+    uint64_t max_ns_ = 0;
+};
+
+} // namespace resmon
+
+#endif // RESMON_CORE_LATENCY_HISTOGRAM_H
@@ -1,16 +1,78 @@
 #ifndef RESMON_CORE_METRICS_H
 #define RESMON_CORE_METRICS_H
 
+#include <chrono>
 #include <cstdint>
 #include <string>
 #include <vector>
 
 namespace resmon {
 
+// Where CPU time went since the previous sample, in percent of it. With
+// idle these add up to 100.
+struct CpuModes {
+    float user = 0.0f;         // excluding guest time
+    float nice = 0.0f;         // excluding guest nice time
+    float system = 0.0f;
+    float iowait = 0.0f;
+    float irq = 0.0f;
+    float softirq = 0.0f;
+    float steal = 0.0f;        // taken by the hypervisor
+    float guest = 0.0f;        // running guest vCPUs (guest + guest_nice)
+};
+
+// One logical CPU
+struct CpuCoreMetrics {
+    uint32_t id = 0;           // N of cpuN
+    float usage_percent = 0.0f;
+    CpuModes modes;
+};
+
 struct CpuMetrics {
     float usage_percent;       // 0-100
     float temperature_celsius; // -1 if unavailable
     int core_count;
+
+    // Linux: breakdown of usage_percent, the online CPUs in id order, and
+    // scheduler counters. Empty/zero if the backend does not report them.
+    CpuModes modes;
+    std::vector<CpuCoreMetrics> cores;
+    float context_switches_per_second = 0.0f;
+    uint32_t procs_running = 0;
+    uint32_t procs_blocked = 0;
+};
+
+// A process with a context on a GPU
+struct GpuProcess {
+    uint32_t pid = 0;
+    std::string name;          // command name, empty if the pid is not visible
+    uint64_t vram_bytes = 0;
+    // NVIDIA: SM utilization; DRM drivers: its busiest engine.
+    // -1 if per-process utilization is unavailable.
+    float usage_percent = -1.0f;
+    bool compute = false;      // NVIDIA context types
+    bool graphics = false;
+};
+
+// "C", "G" or "C+G" for NVIDIA contexts, "-" when the driver has no types
+inline const char* gpuProcessType(const GpuProcess& process) {
+    if (process.compute && process.graphics) {
+        return "C+G";
+    }
+    return process.graphics ? "G" : (process.compute ? "C" : "-");
+}
+
+// Busy rate of one engine (class) of a GPU, from DRM fdinfo
+struct GpuEngineUsage {
+    std::string name;          // as the driver calls it: render, video, copy, gfx, ...
+    float busy_percent;
+};
+
+// A reading from a driver's internal sample buffer, stamped with the time
+// the driver took it
+struct GpuSample {
+    uint64_t timestamp_us;   // wall clock, microseconds since the epoch
+    float value;
 };
 
 struct GpuMetrics {
@@ -20,6 +82,14 @@ struct GpuMetrics {
     float temperature_celsius;
     uint64_t vram_used_bytes;
     uint64_t vram_total_bytes;
+    float power_watts = -1.0f;           // -1 if unavailable
+    std::vector<GpuProcess> processes;   // sorted by VRAM
+    std::vector<GpuEngineUsage> engines; // AMD and Intel (DRM fdinfo)
+
+    // Driver samples taken since the previous collect, oldest first
+    // (NVIDIA only): utilization in percent and power draw in watts
+    std::vector<GpuSample> utilization_samples;
+    std::vector<GpuSample> power_samples;
 };
 
 struct RamMetrics {
@@ -28,12 +98,117 @@ struct RamMetrics {
     float usage_percent;
 };
 
+// A process in the top-N tables
+struct ProcessInfo {
+    uint32_t pid = 0;
+    std::string name;          // command name (comm), at most 15 characters
+    float cpu_percent = 0.0f;  // since the previous scan, % of one core
+    uint64_t rss_bytes = 0;
+};
+
+// The busiest processes of the host. Empty if the backend has no
+// per-process view.
+struct ProcessMetrics {
+    uint32_t count = 0;                 // processes seen in the scan
+    std::vector<ProcessInfo> top_cpu;   // highest CPU% first
+    std::vector<ProcessInfo> top_rss;   // largest RSS first
+};
+
+// One whole disk (partitions and virtual devices such as loop, zram or
+// device-mapper are not reported). Rates cover the time since the previous
+// sample.
+struct DiskMetrics {
+    std::string name;                   // kernel name, e.g. nvme0n1, sda
+    float read_bytes_per_second = 0.0f;
+    float write_bytes_per_second = 0.0f;
+    float read_ops_per_second = 0.0f;
+    float write_ops_per_second = 0.0f;
+    float await_ms = 0.0f;              // mean time per completed request, queueing included
+    float utilization_percent = 0.0f;   // time with at least one request in flight
+    float queue_depth = 0.0f;           // mean requests in flight
+    uint32_t in_flight = 0;             // requests in flight at the sample
+};
+
+// Pressure stall information (PSI) for one resource
+struct PressureStall {
+    float avg10 = 0.0f;        // % of wall time stalled, over the last 10 s
+    float avg60 = 0.0f;        // over the last 60 s
+    uint64_t total_us = 0;     // cumulative stall time
+};
+
+struct ResourcePressure {
+    PressureStall some;        // at least one task stalled on the resource
+    PressureStall full;        // all non-idle tasks stalled at once
+    // Highest threshold a kernel trigger reported crossed since the
+    // previous sample, as % of its window; 0 = none fired
+    float triggered_percent = 0.0f;
+};
+
+// Stall time on CPU, memory and I/O. All zero if the kernel has no PSI.
+struct PressureMetrics {
+    bool available = false;
+    ResourcePressure cpu;
+    ResourcePressure memory;
+    ResourcePressure io;
+};
+
+// One cgroup v2 control group (a service, container or pod). Rates cover
+// the time since the previous sample.
+struct CgroupMetrics {
+    std::string path;               // below the cgroup root, e.g. /system.slice/nginx.service
+    bool populated = false;         // has processes in it or below
+    float cpu_percent = 0.0f;       // % of one core
+    float throttled_percent = 0.0f; // time throttled by cpu.max, % of the interval
+    uint64_t memory_bytes = 0;
+    uint64_t memory_max_bytes = 0;  // 0 = no limit
+    uint64_t oom_kills = 0;         // since the group was created
+    float io_read_bytes_per_second = 0.0f;
+    float io_write_bytes_per_second = 0.0f;
+    float io_ops_per_second = 0.0f;
+    uint64_t pids = 0;
+    PressureMetrics pressure;       // the group's own *.pressure files
+};
+
+// Cost of one collector, from its latency histogram since startup
+struct CollectorTiming {
+    const char* name = "";     // static string, e.g. "cpu", "nvidia"
+    uint64_t calls = 0;
+    float last_us = 0.0f;
+    float mean_us = 0.0f;
+    float p50_us = 0.0f;
+    float p99_us = 0.0f;
+    float max_us = 0.0f;
+};
+
+// What resmon itself costs. All zero if the backend does not measure it.
+struct OverheadMetrics {
+    float cpu_percent = 0.0f;  // resmon's CPU time, % of one core
+    uint64_t rss_bytes = 0;
+    float collect_us = 0.0f;   // wall time of this sample's collect()
+    float collect_p50_us = 0.0f;   // collect() wall time over the whole run
+    float collect_p99_us = 0.0f;
+    float collect_max_us = 0.0f;
+    std::vector<CollectorTiming> collectors;
+};
+
 struct SystemMetrics {
+    uint64_t timestamp_ms;     // Unix time when collection started
     CpuMetrics cpu;
     std::vector<GpuMetrics> gpus;
     RamMetrics ram;
+    ProcessMetrics processes;
+    PressureMetrics pressure;
+    std::vector<DiskMetrics> disks;       // in /proc/diskstats order
+    std::vector<CgroupMetrics> cgroups;   // in path order; empty without cgroup v2
+    OverheadMetrics overhead;
 };
 
+// Current wall-clock time in the units of SystemMetrics::timestamp_ms
+inline uint64_t wallClockMillis() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
 } // namespace resmon
 
 #endif // RESMON_CORE_METRICS_H
@@ -0,0 +1,142 @@
+#include "core/rollup.h"
+
+#include <cmath>
+#include <utility>
+
+namespace resmon {
+
+static const RollupBucket EMPTY_BUCKET{0.0f, 0.0f, 0.0f, 0.0f, 0};
+
+std::vector<RollupTierConfig> RollupStore::defaultTiers() {
+    return {
+        {1000, 600},                // 1 s buckets, 10 minutes
+        {10 * 1000, 1080},          // 10 s buckets, 3 hours
+        {60 * 1000, 7 * 24 * 60},   // 1 min buckets, 1 week
+        {3600 * 1000, 90 * 24},     // 1 h buckets, 90 days
+    };
+}
+
+RollupStore::RollupStore(const std::vector<RollupTierConfig>& tiers, size_t max_gpus)
+    : max_gpus_(max_gpus)
+    , columns_(seriesColumnCount(max_gpus))
+    , scratch_values_(columns_)
+    , scratch_buckets_(columns_)
+{
+    tiers_.reserve(tiers.size());
+    for (const auto& config : tiers) {
+        Tier tier;
+        tier.config = config;
+        if (tier.config.capacity == 0) {
+            tier.config.capacity = 1;
+        }
+        if (tier.config.bucket_ms == 0) {
+            tier.config.bucket_ms = 1;
+        }
+        tier.starts.assign(tier.config.capacity, 0);
+        tier.buckets.assign(tier.config.capacity * columns_, EMPTY_BUCKET);
+        tier.open.assign(columns_, EMPTY_BUCKET);
+        tiers_.push_back(std::move(tier));
+    }
+}
+
+void RollupStore::append(const SystemMetrics& metrics) {
+    if (tiers_.empty()) {
+        return;
+    }
+
+    extractSeriesValues(metrics, max_gpus_, scratch_values_.data());
+    for (size_t column = 0; column < columns_; ++column) {
+        float value = scratch_values_[column];
+        if (std::isnan(value)) {
+            scratch_buckets_[column] = EMPTY_BUCKET;
+        } else {
+            scratch_buckets_[column] = RollupBucket{value, value, value, value, 1};
+        }
+    }
+
+    add(0, metrics.timestamp_ms, scratch_buckets_.data());
+}
+
+void RollupStore::add(size_t tier_index, uint64_t time_ms, const RollupBucket* values) {
+    Tier& tier = tiers_[tier_index];
+    uint64_t start = time_ms - time_ms % tier.config.bucket_ms;
+
+    if (tier.has_open && start != tier.open_start) {
+        close(tier_index);
+    }
+    if (!tier.has_open) {
+        tier.open_start = start;
+        tier.has_open = true;
+        for (auto& bucket : tier.open) {
+            bucket = EMPTY_BUCKET;
+        }
+    }
+
+    for (size_t column = 0; column < columns_; ++column) {
+        const RollupBucket& in = values[column];
+        if (in.count == 0) {
+            continue;
+        }
+        RollupBucket& open = tier.open[column];
+        if (open.count == 0) {
+            open = in;
+            continue;
+        }
+        if (in.min < open.min) open.min = in.min;
+        if (in.max > open.max) open.max = in.max;
+        open.sum += in.sum;
+        open.count += in.count;
+        open.last = in.last;
+    }
+}
+
+void RollupStore::close(size_t tier_index) {
+    Tier& tier = tiers_[tier_index];
+    const size_t capacity = tier.config.capacity;
+    const size_t slot = tier.head;
+
+    tier.starts[slot] = tier.open_start;
+    for (size_t column = 0; column < columns_; ++column) {
+        tier.buckets[column * capacity + slot] = tier.open[column];
+    }
+    tier.head = (tier.head + 1) % capacity;
+    if (tier.size < capacity) {
+        ++tier.size;
+    }
+    tier.has_open = false;
+
+    // The closed bucket becomes one input of the next coarser tier
+    if (tier_index + 1 < tiers_.size()) {
+        add(tier_index + 1, tier.open_start, tier.open.data());
+    }
+}
+
+size_t RollupStore::physicalIndex(const Tier& tier, size_t index) const {
+    const size_t capacity = tier.config.capacity;
+    size_t oldest = (tier.head + capacity - tier.size) % capacity;
+    return (oldest + index) % capacity;
+}
+
+uint64_t RollupStore::bucketStart(size_t tier, size_t index) const {
+    const Tier& t = tiers_[tier];
+    return t.starts[physicalIndex(t, index)];
+}
+
+const RollupBucket& RollupStore::bucket(size_t tier, HistorySeries series, size_t index, size_t gpu) const {
+    const Tier& t = tiers_[tier];
+    if (isGpuSeries(series) && gpu >= max_gpus_) {
+        return EMPTY_BUCKET;
+    }
+    size_t column = seriesColumn(series, gpu);
+    return t.buckets[column * t.config.capacity + physicalIndex(t, index)];
+}
+
+const RollupBucket& RollupStore::openBucket(size_t tier, HistorySeries series, size_t gpu) const {
+    const Tier& t = tiers_[tier];
+    if (!t.has_open || (isGpuSeries(series) && gpu >= max_gpus_)) {
+        return EMPTY_BUCKET;
+    }
+    return t.open[seriesColumn(series, gpu)];
+}
+
+} // namespace resmon
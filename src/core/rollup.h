@@ -0,0 +1,89 @@
+#ifndef RESMON_CORE_ROLLUP_H
+#define RESMON_CORE_ROLLUP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "history.h"
+#include "metrics.h"
+
+namespace resmon {
+
+// Aggregate of the samples that fell into one time bucket
+struct RollupBucket {
+    float min;
+    float max;
+    float last;
+    float sum;
+    uint32_t count;   // 0 = no valid samples in this bucket
+
+    float mean() const { return count > 0 ? sum / static_cast<float>(count) : 0.0f; }
+};
+
+struct RollupTierConfig {
+    uint64_t bucket_ms;    // bucket width
+    size_t capacity;       // buckets retained
+};
+
+// Multi-resolution rollups of every history series. Each sample updates
+// the open bucket of the finest tier; when that bucket closes it is stored
+// and merged into the open bucket of the next tier, and so on. Coarser
+// tiers are therefore maintained incrementally and never recomputed from
+// raw samples, while min/max keep the peaks that averaging would hide.
+// All storage is allocated in the constructor.
+class RollupStore {
+public:
+    // 1s for 10 min, 10s for 3 h, 1 min for a week, 1 h for 90 days
+    static std::vector<RollupTierConfig> defaultTiers();
+
+    RollupStore(const std::vector<RollupTierConfig>& tiers, size_t max_gpus);
+
+    // Non-copyable (large)
+    RollupStore(const RollupStore&) = delete;
+    RollupStore& operator=(const RollupStore&) = delete;
+
+    void append(const SystemMetrics& metrics);
+
+    size_t tierCount() const { return tiers_.size(); }
+    uint64_t bucketMs(size_t tier) const { return tiers_[tier].config.bucket_ms; }
+    size_t maxGpus() const { return max_gpus_; }
+
+    // Closed buckets in a tier, 0 = oldest
+    size_t size(size_t tier) const { return tiers_[tier].size; }
+    uint64_t bucketStart(size_t tier, size_t index) const;
+    const RollupBucket& bucket(size_t tier, HistorySeries series, size_t index, size_t gpu = 0) const;
+
+    // The still-open bucket of a tier (count == 0 if nothing arrived yet)
+    const RollupBucket& openBucket(size_t tier, HistorySeries series, size_t gpu = 0) const;
+
+private:
+    struct Tier {
+        RollupTierConfig config;
+        size_t head = 0;                      // next slot to write
+        size_t size = 0;
+        std::vector<uint64_t> starts;         // capacity entries
+        std::vector<RollupBucket> buckets;    // column-major: column * capacity + slot
+        uint64_t open_start = 0;
+        bool has_open = false;
+        std::vector<RollupBucket> open;       // one per column
+    };
+
+    // Fold a bucket (or a single sample, as a one-count bucket) into the
+    // open bucket of a tier, closing and cascading it first if start has
+    // moved past it
+    void add(size_t tier, uint64_t time_ms, const RollupBucket* values);
+    void close(size_t tier);
+
+    size_t physicalIndex(const Tier& tier, size_t index) const;
+
+    std::vector<Tier> tiers_;
+    size_t max_gpus_;
+    size_t columns_;
+    std::vector<float> scratch_values_;
+    std::vector<RollupBucket> scratch_buckets_;
+};
+
+} // namespace resmon
+
+#endif // RESMON_CORE_ROLLUP_H
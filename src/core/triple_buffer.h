@@ -0,0 +1,59 @@
+#ifndef RESMON_CORE_TRIPLE_BUFFER_H
+#define RESMON_CORE_TRIPLE_BUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace resmon {
+
+// Lock-free single-producer/single-consumer handoff of the latest value.
+//
+// The writer fills its private back slot and publishes it by swapping it
+// with the shared middle slot; the reader swaps the middle slot into its
+// private front slot when something new was published. Neither side ever
+// blocks or copies T, and the reader always sees the newest complete value.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() = default;
+
+    // Non-copyable
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Writer side: slot to fill, then publish() it
+    T& writeBuffer() { return slots_[back_]; }
+
+    void publish() {
+        uint8_t previous = middle_.exchange(static_cast<uint8_t>(back_ | FRESH_BIT),
+                                            std::memory_order_acq_rel);
+        back_ = previous & INDEX_MASK;
+    }
+
+    // Reader side: take the newest published slot, if any.
+    // Returns true if read() now refers to a new value.
+    bool update() {
+        if ((middle_.load(std::memory_order_relaxed) & FRESH_BIT) == 0) {
+            return false;
+        }
+        uint8_t previous = middle_.exchange(front_, std::memory_order_acq_rel);
+        front_ = previous & INDEX_MASK;
+        return true;
+    }
+
+    // Value taken by the last update(); stable until the next update()
+    const T& read() const { return slots_[front_]; }
+
+private:
+    static constexpr uint8_t FRESH_BIT = 0x4;
+    static constexpr uint8_t INDEX_MASK = 0x3;
+
+    T slots_[3]{};
+    uint8_t front_ = 0;                 // owned by the reader
+    uint8_t back_ = 1;                  // owned by the writer
+    std::atomic<uint8_t> middle_{2};    // shared: index | FRESH_BIT
+};
+
+} // namespace resmon
+
+#endif // RESMON_CORE_TRIPLE_BUFFER_H
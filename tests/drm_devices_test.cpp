@@ -0,0 +1,119 @@
+// DrmDeviceEnumerator against a fixture /sys/class/drm: cards are
+// classified by PCI vendor, connectors and render nodes are skipped, cards
+// are ordered by number, and an injected drm uevent (but no other) rescans.
+
+#include <string>
+
+#include "backend/linux/drm_devices.h"
+#include "expect.h"
+#include "fixtures.h"
+
+using namespace resmon::platform;
+
+static void writeCard(const FixtureTree& tree, const std::string& card, const char* vendor,
+                      const char* driver, const char* pci_address) {
+    std::string device = "sys/class/drm/" + card + "/device/";
+    tree.write(device + "vendor", std::string(vendor) + "\n");
+    tree.write(device + "uevent", std::string("DRIVER=") + driver + "\n"
+                                  "PCI_CLASS=30000\n"
+                                  "PCI_ID=" + vendor + ":0000\n"
+                                  "PCI_SLOT_NAME=" + pci_address + "\n"
+                                  "MODALIAS=pci:v0000d0000sv0000sd0000bc03sc00i00\n");
+}
+
+static void testScan() {
+    FixtureTree tree;
+    expect(tree.valid(), "fixture directory");
+    writeCard(tree, "card10", "0x10de", "nvidia", "0000:41:00.0");
+    writeCard(tree, "card2", "0x1002", "amdgpu", "0000:03:00.0");
+    writeCard(tree, "card0", "0x8086", "i915", "0000:00:02.0");
+    writeCard(tree, "card1", "0x1af4", "virtio-pci", "0000:00:05.0");
+    // Connectors and render nodes are not cards
+    tree.write("sys/class/drm/card0-HDMI-A-1/status", "connected\n");
+    tree.write("sys/class/drm/card2-DP-1/status", "disconnected\n");
+    tree.write("sys/class/drm/renderD128/device/vendor", "0x8086\n");
+    tree.write("sys/class/drm/version", "drm 1.1.0 20060810\n");
+
+    DrmDeviceEnumerator enumerator(tree.root());
+    expect(enumerator.generation() == 0, "nothing is scanned before scan()");
+    expect(enumerator.scan(), "the first scan finds devices");
+    expect(enumerator.generation() == 1, "the first scan is a change");
+
+    const auto& devices = enumerator.devices();
+    expect(devices.size() == 4, "only cardN entries are devices");
+    if (devices.size() != 4) {
+        return;
+    }
+    expect(devices[0].card == "card0" && devices[1].card == "card1" &&
+           devices[2].card == "card2" && devices[3].card == "card10",
+           "cards are ordered by number, not by name");
+    expect(devices[0].vendor == DrmVendor::Intel, "0x8086 is Intel");
+    expect(devices[1].vendor == DrmVendor::Unknown, "other vendors are Unknown");
+    expect(devices[2].vendor == DrmVendor::Amd, "0x1002 is AMD");
+    expect(devices[3].vendor == DrmVendor::Nvidia, "0x10de is NVIDIA");
+    expect(devices[2].vendor_id == "0x1002", "the vendor id is kept without its newline");
+    expect(devices[2].pci_address == "0000:03:00.0", "the PCI address comes from PCI_SLOT_NAME");
+    expect(devices[2].driver == "amdgpu", "the driver comes from DRIVER");
+    expect(devices[0].driver == "i915" && devices[0].pci_address == "0000:00:02.0",
+           "every card reads its own device/uevent");
+    expect(devices[2].device_path == tree.root() + "/sys/class/drm/card2/device",
+           "the device path is below the root");
+
+    expect(!enumerator.scan(), "rescanning an unchanged tree is not a change");
+    expect(enumerator.generation() == 1, "an unchanged rescan keeps the generation");
+}
+
+static void testUevents() {
+    FixtureTree tree;
+    expect(tree.valid(), "fixture directory");
+    writeCard(tree, "card0", "0x8086", "i915", "0000:00:02.0");
+
+    DrmDeviceEnumerator enumerator(tree.root());
+    enumerator.scan();
+    expect(enumerator.devices().size() == 1, "one card before the hotplug");
+    uint64_t generation = enumerator.generation();
+
+    // An eGPU is plugged in; until an event arrives it is not seen
+    writeCard(tree, "card1", "0x1002", "amdgpu", "0000:0c:00.0");
+    expect(!enumerator.poll(), "no event, no rescan");
+
+    static const char usb[] = "add@/devices/pci0000:00/0000:00:14.0/usb1/1-2\0"
+                              "ACTION=add\0DEVPATH=/devices/pci0000:00/0000:00:14.0/usb1/1-2\0"
+                              "SUBSYSTEM=usb\0DEVTYPE=usb_device\0SEQNUM=4711";
+    enumerator.injectUevent(usb, sizeof(usb));
+    expect(!enumerator.poll(), "a uevent of another subsystem does not rescan");
+    expect(enumerator.devices().size() == 1 && enumerator.generation() == generation,
+           "the device list is unchanged after a non-drm uevent");
+
+    // SUBSYSTEM=drm as a prefix of another value must not match either
+    static const char drm_dp[] = "change@/devices/virtual/drm_dp_aux_dev/drm_dp_aux0\0"
+                                 "ACTION=change\0SUBSYSTEM=drm_dp_aux_dev\0SEQNUM=4712";
+    enumerator.injectUevent(drm_dp, sizeof(drm_dp));
+    expect(!enumerator.poll(), "SUBSYSTEM=drm_dp_aux_dev is not the drm subsystem");
+
+    static const char drm[] = "add@/devices/pci0000:00/0000:00:1c.0/0000:0c:00.0/drm/card1\0"
+                              "ACTION=add\0DEVPATH=/devices/pci0000:00/0000:00:1c.0/0000:0c:00.0/drm/card1\0"
+                              "SUBSYSTEM=drm\0DEVNAME=dri/card1\0DEVTYPE=drm_minor\0SEQNUM=4713";
+    enumerator.injectUevent(drm, sizeof(drm));
+    expect(enumerator.poll(), "a drm uevent rescans");
+    expect(enumerator.generation() == generation + 1, "a changed device list bumps the generation");
+    expect(enumerator.devices().size() == 2, "the hotplugged card is listed");
+    if (enumerator.devices().size() == 2) {
+        expect(enumerator.devices()[1].vendor == DrmVendor::Amd &&
+               enumerator.devices()[1].pci_address == "0000:0c:00.0",
+               "the hotplugged card is read like the others");
+    }
+
+    // Several events of one hotplug are coalesced; a rescan that finds
+    // nothing new is not a change
+    enumerator.injectUevent(drm, sizeof(drm));
+    enumerator.injectUevent(drm, sizeof(drm));
+    expect(!enumerator.poll(), "a drm uevent without a device change is not a change");
+    expect(enumerator.generation() == generation + 1, "the generation only counts changes");
+}
+
+int main() {
+    testScan();
+    testUevents();
+    return testResult("drm_devices_test");
+}
@@ -0,0 +1,201 @@
+// parseDrmFdinfo() on fdinfo text, and DrmClientScanner against a fixture
+// /proc: clients shared across processes count once, and a process that
+// opens its GPU device some time after it started shows up while it is
+// still young, not once the round robin over all pids gets back to it.
+
+#include <chrono>
+#include <string>
+
+#include "backend/linux/drm_fdinfo.h"
+#include "expect.h"
+#include "fixtures.h"
+
+using namespace resmon::platform;
+
+static const char PDEV[] = "0000:00:01.0";
+
+// More old processes than one update re-inspects, so the round robin
+// does not reach the new one during the test
+static constexpr int OLD_PROCESSES = static_cast<int>(DrmClientScanner::RECHECK_PER_UPDATE) * 8;
+
+static const DrmEngine* engineNamed(const DrmClient& client, const std::string& name) {
+    for (const auto& engine : client.engines) {
+        if (engine.name == name) {
+            return &engine;
+        }
+    }
+    return nullptr;
+}
+
+static void testNotDrm() {
+    DrmClient client;
+    auto now = std::chrono::steady_clock::now();
+    expect(!parseDrmFdinfo("pos:\t0\nflags:\t02\nmnt_id:\t26\nino:\t7\n", now, client),
+           "an fdinfo without drm-client-id is not a DRM client");
+}
+
+static void testCycleEngines() {
+    // amdgpu/xe style: busy cycles against the engine's own total cycles
+    DrmClient client;
+    auto start = std::chrono::steady_clock::now();
+    expect(parseDrmFdinfo("drm-client-id:\t7\ndrm-pdev:\t0000:03:00.0\n"
+                          "drm-cycles-rcs:\t1000\ndrm-total-cycles-rcs:\t10000\n",
+                          start, client),
+           "a cycles fdinfo parses");
+    expect(client.client_id == 7, "drm-client-id is read");
+    expect(client.pdev == "0000:03:00.0", "drm-pdev is read");
+    const DrmEngine* rcs = engineNamed(client, "rcs");
+    expect(rcs && rcs->busy_percent == 0.0f, "the first read has no rate");
+
+    // 2000 of 4000 cycles busy, whatever the wall time
+    parseDrmFdinfo("drm-client-id:\t7\ndrm-pdev:\t0000:03:00.0\n"
+                   "drm-cycles-rcs:\t3000\ndrm-total-cycles-rcs:\t14000\n",
+                   start + std::chrono::seconds(5), client);
+    rcs = engineNamed(client, "rcs");
+    expect(rcs != nullptr, "the cycles engine is kept");
+    if (rcs) {
+        expectNear(rcs->busy_percent, 50.0, 0.01, "busy cycles over total cycles");
+    }
+}
+
+static void testNsEnginesWithCapacity() {
+    // i915 style: busy ns against wall time, spread over the engine's
+    // instances
+    DrmClient client;
+    auto start = std::chrono::steady_clock::now();
+    const char* first = "drm-client-id:\t3\ndrm-pdev:\t0000:00:02.0\n"
+                        "drm-engine-render:\t0 ns\n"
+                        "drm-engine-video:\t0 ns\ndrm-engine-capacity-video:\t2\n";
+    const char* second = "drm-client-id:\t3\ndrm-pdev:\t0000:00:02.0\n"
+                         "drm-engine-render:\t25000000 ns\n"
+                         "drm-engine-video:\t100000000 ns\ndrm-engine-capacity-video:\t2\n";
+    parseDrmFdinfo(first, start, client);
+    parseDrmFdinfo(second, start + std::chrono::milliseconds(100), client);
+
+    const DrmEngine* render = engineNamed(client, "render");
+    const DrmEngine* video = engineNamed(client, "video");
+    expect(render && video, "both ns engines are read");
+    if (render && video) {
+        expectNear(render->busy_percent, 25.0, 0.01, "busy ns over elapsed ns");
+        expect(video->capacity == 2, "drm-engine-capacity-video is read");
+        expectNear(video->busy_percent, 50.0, 0.01, "a full engine of two instances is 50%");
+    }
+}
+
+static void testMemory() {
+    auto now = std::chrono::steady_clock::now();
+
+    DrmClient resident;
+    parseDrmFdinfo("drm-client-id:\t1\ndrm-pdev:\t0000:03:00.0\n"
+                   "drm-memory-vram:\t999 MiB\n"
+                   "drm-resident-vram0:\t2 MiB\ndrm-resident-vram1:\t512 KiB\n"
+                   "drm-resident-system0:\t64 MiB\n",
+                   now, resident);
+    expect(resident.vram_bytes == (2u << 20) + (512u << 10),
+           "drm-resident-vram* is summed and preferred over drm-memory-*; system memory is not VRAM");
+
+    DrmClient legacy;
+    parseDrmFdinfo("drm-client-id:\t2\ndrm-pdev:\t0000:03:00.0\n"
+                   "drm-memory-vram:\t3 MiB\ndrm-memory-gtt:\t8 MiB\n",
+                   now, legacy);
+    expect(legacy.vram_bytes == (3u << 20), "older kernels: drm-memory-vram is the resident size");
+
+    DrmClient local;
+    parseDrmFdinfo("drm-client-id:\t3\ndrm-pdev:\t0000:03:00.0\n"
+                   "drm-resident-local0:\t4096\n",
+                   now, local);
+    expect(local.vram_bytes == 4096, "i915 local0 counts as VRAM; a value without unit is in bytes");
+}
+
+static void writeProcess(const FixtureTree& tree, int pid, const std::string& name) {
+    std::string proc = "proc/" + std::to_string(pid) + "/";
+    tree.write(proc + "comm", name + "\n");
+    tree.link(proc + "fd/0", "/dev/null");
+}
+
+static void openRenderNode(const FixtureTree& tree, int pid, int fd, int client_id) {
+    std::string proc = "proc/" + std::to_string(pid) + "/";
+    tree.link(proc + "fd/" + std::to_string(fd), "/dev/dri/renderD128");
+    tree.write(proc + "fdinfo/" + std::to_string(fd),
+               std::string("pos:\t0\nflags:\t02100002\nmnt_id:\t26\n"
+                           "drm-driver:\ti915\ndrm-client-id:\t") + std::to_string(client_id) + "\n"
+               "drm-pdev:\t" + PDEV + "\n"
+               "drm-engine-render:\t1000000 ns\n");
+}
+
+static size_t clientsOf(const DrmClientScanner& scanner, uint32_t pid) {
+    size_t count = 0;
+    for (const auto& client : scanner.clients()) {
+        if (client.pid == pid) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+static void testSharedClients() {
+    FixtureTree tree;
+    expect(tree.valid(), "fixture directory");
+
+    // A parent and a forked child share one open file (same client id);
+    // the parent also dup()ed it; a second process has a client of its own
+    writeProcess(tree, 100, "server");
+    openRenderNode(tree, 100, 5, 11);
+    openRenderNode(tree, 100, 6, 11);
+    writeProcess(tree, 101, "server");
+    openRenderNode(tree, 101, 5, 11);
+    writeProcess(tree, 200, "game");
+    openRenderNode(tree, 200, 4, 12);
+    // A client of a device that is not tracked
+    writeProcess(tree, 300, "other");
+    tree.link("proc/300/fd/3", "/dev/dri/renderD129");
+    tree.write("proc/300/fdinfo/3", "drm-client-id:\t13\ndrm-pdev:\t0000:05:00.0\n");
+
+    DrmClientScanner scanner(tree.root());
+    scanner.setDevices({PDEV});
+    scanner.update();
+    expect(scanner.clients().size() == 2, "clients are deduplicated by (pdev, client id)");
+    expect(clientsOf(scanner, 100) + clientsOf(scanner, 101) == 1, "a shared file counts once");
+    expect(clientsOf(scanner, 200) == 1, "a separate client counts on its own");
+    expect(clientsOf(scanner, 300) == 0, "clients of other devices are not tracked");
+}
+
+static void testYoungProcess() {
+    FixtureTree tree;
+    expect(tree.valid(), "fixture directory");
+    for (int i = 0; i < OLD_PROCESSES; ++i) {
+        writeProcess(tree, 1000 + i, "worker");
+    }
+
+    DrmClientScanner scanner(tree.root());
+    scanner.setDevices({PDEV});
+    scanner.update();
+    expect(scanner.clients().empty(), "no clients before any process opens the GPU");
+
+    // Started, but has not opened the GPU yet when it is first inspected
+    const int pid = 90000;
+    writeProcess(tree, pid, "python3");
+    scanner.update();
+    expect(clientsOf(scanner, pid) == 0, "a new process without a DRM fd is not a client");
+
+    // A few updates later its runtime has loaded and opened the render node
+    scanner.update();
+    scanner.update();
+    openRenderNode(tree, pid, 5, 42);
+    scanner.update();
+    expect(clientsOf(scanner, pid) == 1, "a young process that opened the GPU is picked up on the next update");
+    expect(scanner.clients().size() == 1, "the client is tracked once");
+    if (!scanner.clients().empty()) {
+        expect(scanner.clients().front().name == "python3", "the client carries its command name");
+    }
+}
+
+int main() {
+    testNotDrm();
+    testCycleEngines();
+    testNsEnginesWithCapacity();
+    testMemory();
+    testSharedClients();
+    testYoungProcess();
+    return testResult("drm_fdinfo_test");
+}
@@ -0,0 +1,40 @@
+// Minimal checks for the fixture tests: each failed expectation is printed
+// and counted, and the test's main() returns testResult().
+
+#ifndef RESMON_TESTS_EXPECT_H
+#define RESMON_TESTS_EXPECT_H
+
+#include <cmath>
+#include <cstdio>
+
+inline int& testFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+inline void expect(bool condition, const char* what) {
+    if (!condition) {
+        std::fprintf(stderr, "FAIL: %s\n", what);
+        ++testFailures();
+    }
+}
+
+// Floating-point results (rates, percentages) to within tolerance
+inline void expectNear(double actual, double expected, double tolerance, const char* what) {
+    if (std::fabs(actual - expected) > tolerance) {
+        std::fprintf(stderr, "FAIL: %s (got %g, expected %g)\n", what, actual, expected);
+        ++testFailures();
+    }
+}
+
+// Exit status for main(): 0 if every expectation held
+inline int testResult(const char* name) {
+    if (testFailures() == 0) {
+        std::printf("%s: ok\n", name);
+        return 0;
+    }
+    std::fprintf(stderr, "%s: %d failed\n", name, testFailures());
+    return 1;
+}
+
+#endif // RESMON_TESTS_EXPECT_H
@@ -0,0 +1,119 @@
+// Synthetic procfs/sysfs contents and fixture trees. Header-only; shared
+// by the tests and the bench executables.
+
+#ifndef RESMON_TESTS_FIXTURES_H
+#define RESMON_TESTS_FIXTURES_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <ftw.h>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+
+inline std::string makeProcStat(int cpu_count) {
+    std::string text = "cpu  4705 356 584 3699176 23060 0 277 0 0 0\n";
+    char line[160];
+    for (int i = 0; i < cpu_count; ++i) {
+        snprintf(line, sizeof(line), "cpu%d 12345%d 67 8901%d 3699176%d 2306 0 27%d 0 0 0\n",
+                 i, i % 10, i % 7, i, i % 3);
+        text += line;
+    }
+    text += "intr 1462898 34 0 0 0 0 0 0 0 1 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0\n";
+    text += "ctxt 115315\nbtime 769041601\nprocesses 86031\n";
+    text += "procs_running 2\nprocs_blocked 0\nsoftirq 5327 0 1462 2 1101 0 0 0 1226 0 1536\n";
+    return text;
+}
+
+inline std::string makeMemInfo() {
+    static const char* const keys[] = {
+        "MemTotal", "MemFree", "MemAvailable", "Buffers", "Cached", "SwapCached",
+        "Active", "Inactive", "Active(anon)", "Inactive(anon)", "Active(file)",
+        "Inactive(file)", "Unevictable", "Mlocked", "SwapTotal", "SwapFree",
+        "Zswap", "Zswapped", "Dirty", "Writeback", "AnonPages", "Mapped", "Shmem",
+        "KReclaimable", "Slab", "SReclaimable", "SUnreclaim", "KernelStack",
+        "PageTables", "SecPageTables", "NFS_Unstable", "Bounce", "WritebackTmp",
+        "CommitLimit", "Committed_AS", "VmallocTotal", "VmallocUsed", "VmallocChunk",
+        "Percpu", "HardwareCorrupted", "AnonHugePages", "ShmemHugePages",
+        "ShmemPmdMapped", "FileHugePages", "FilePmdMapped", "HugePages_Total",
+        "HugePages_Free", "HugePages_Rsvd", "HugePages_Surp", "Hugepagesize",
+        "Hugetlb", "DirectMap4k", "DirectMap2M", "DirectMap1G",
+    };
+    std::string text;
+    char line[96];
+    uint64_t value = 263921152;
+    for (const char* key : keys) {
+        snprintf(line, sizeof(line), "%-16s%10llu kB\n", (std::string(key) + ":").c_str(),
+                 static_cast<unsigned long long>(value));
+        text += line;
+        value = value / 3 + 17;
+    }
+    return text;
+}
+
+// A directory tree under /tmp laid out like / for the collectors'
+// fs_root option. Removed again on destruction.
+class FixtureTree {
+public:
+    FixtureTree() {
+        char path[] = "/tmp/resmon-fixture-XXXXXX";
+        if (mkdtemp(path)) {
+            root_ = path;
+        }
+    }
+
+    ~FixtureTree() {
+        if (!root_.empty()) {
+            nftw(root_.c_str(), removeEntry, 16, FTW_DEPTH | FTW_PHYS);
+        }
+    }
+
+    // Non-copyable (owns the directory)
+    FixtureTree(const FixtureTree&) = delete;
+    FixtureTree& operator=(const FixtureTree&) = delete;
+
+    bool valid() const { return !root_.empty(); }
+    const std::string& root() const { return root_; }
+
+    // Write a file at a path relative to the root, creating its parents
+    bool write(const std::string& relative, const std::string& contents) const {
+        std::string path = root_ + "/" + relative;
+        if (!makeParents(relative)) {
+            return false;
+        }
+        FILE* file = std::fopen(path.c_str(), "w");
+        if (!file) {
+            return false;
+        }
+        bool ok = std::fwrite(contents.data(), 1, contents.size(), file) == contents.size();
+        return std::fclose(file) == 0 && ok;
+    }
+
+    // Create a symlink at a path relative to the root; target is stored as
+    // given (e.g. a /proc/<pid>/fd entry pointing at /dev/dri/renderD128)
+    bool link(const std::string& relative, const std::string& target) const {
+        if (!makeParents(relative)) {
+            return false;
+        }
+        return symlink(target.c_str(), (root_ + "/" + relative).c_str()) == 0;
+    }
+
+private:
+    bool makeParents(const std::string& relative) const {
+        std::string path = root_ + "/" + relative;
+        for (size_t slash = path.find('/', root_.size() + 1); slash != std::string::npos;
+             slash = path.find('/', slash + 1)) {
+            mkdir(path.substr(0, slash).c_str(), 0755);
+        }
+        return true;
+    }
+
+    static int removeEntry(const char* path, const struct stat*, int, struct FTW*) {
+        return ::remove(path);
+    }
+
+    std::string root_;
+};
+
+#endif // RESMON_TESTS_FIXTURES_H
@@ -0,0 +1,414 @@
+// The NVIDIA collector against the NVML stub (tests/nvml_stub.cpp), loaded
+// through BackendOptions::nvml_library: device names, UUIDs and total VRAM
+// are resolved once, a sample costs a fixed number of NVML calls per
+// device, the process table is complete whichever way the driver answers
+// a size query, and the driver's sample buffers are read incrementally, in
+// timestamp order, into GpuMetrics and GpuSampleHistory.
+
+#include <cstdint>
+#include <cstdlib>
+#include <dlfcn.h>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "core/backend.h"
+#include "core/gpu_sample_history.h"
+#include "expect.h"
+#include "fixtures.h"
+
+using namespace resmon;
+
+static constexpr unsigned int GPUS = 2;
+
+// A pinned stub clock, advanced one second per sample so every collect()
+// finds new driver samples
+static constexpr unsigned long long START_US = 1700000000000000ull;
+static constexpr unsigned long long STEP_US = 1000000;
+
+// NVML calls of one sample of one device: utilization and power samples,
+// temperature, memory, compute and graphics processes, per-process
+// utilization
+static constexpr uint64_t CALLS_PER_DEVICE = 7;
+
+// As in nvml.h
+static constexpr int NVML_SUCCESS = 0;
+static constexpr int NVML_ERROR_INSUFFICIENT_SIZE = 7;
+
+// Synthetic pids of the stub (its processPid()); process 0 is this one
+static constexpr unsigned int STUB_MAX_PROCESSES = 64;
+
+typedef uint64_t (*StubCallCount)();
+typedef uint64_t (*StubCalls)(const char* function);
+typedef void (*StubSetClock)(unsigned long long micros);
+typedef void (*StubSetProcesses)(unsigned int processes);
+typedef void (*StubSetSizeAnswer)(int result);
+
+static StubCallCount stubCallCount = nullptr;
+static StubCalls stubCalls = nullptr;
+static StubSetClock stubSetClock = nullptr;
+static StubSetProcesses stubSetProcesses = nullptr;
+static StubSetSizeAnswer stubSetSizeAnswer = nullptr;
+
+static const char* const ENUMERATION_CALLS[] = {
+    "nvmlDeviceGetCount_v2",
+    "nvmlDeviceGetHandleByIndex_v2",
+    "nvmlDeviceGetName",
+    "nvmlDeviceGetUUID",
+};
+
+// Keeps the stub loaded for its counters and controls
+static bool loadStub() {
+    void* stub = dlopen(RESMON_NVML_STUB, RTLD_LAZY);
+    if (!stub) {
+        return false;
+    }
+    stubCallCount = reinterpret_cast<StubCallCount>(dlsym(stub, "resmonStubCallCount"));
+    stubCalls = reinterpret_cast<StubCalls>(dlsym(stub, "resmonStubCalls"));
+    stubSetClock = reinterpret_cast<StubSetClock>(dlsym(stub, "resmonStubSetClock"));
+    stubSetProcesses = reinterpret_cast<StubSetProcesses>(dlsym(stub, "resmonStubSetProcesses"));
+    stubSetSizeAnswer = reinterpret_cast<StubSetSizeAnswer>(dlsym(stub, "resmonStubSetSizeAnswer"));
+    return stubCallCount && stubCalls && stubSetClock && stubSetProcesses && stubSetSizeAnswer;
+}
+
+static uint32_t stubPid(unsigned int gpu, unsigned int k) {
+    return k == 0 ? static_cast<uint32_t>(getpid()) : 5000000 + gpu * STUB_MAX_PROCESSES + k;
+}
+
+// The stub's sample grids (its nvmlDeviceGetSamples()), SAMPLE_BUFFER_SIZE
+// deep
+static constexpr unsigned long long UTILIZATION_PERIOD_US = 166667;
+static constexpr unsigned long long POWER_PERIOD_US = 20000;
+static constexpr size_t STUB_SAMPLE_BUFFER_SIZE = 120;
+
+// Utilization the stub reports for a grid slot (its sampleAt())
+static float stubUtilization(unsigned int gpu, unsigned long long slot) {
+    return (slot + gpu) % 6 == 0 ? 97.0f : static_cast<float>(4 + slot % 5);
+}
+
+// SM% the stub reports for process k once the device's utilization has
+// been read tick times
+static float stubSmPercent(unsigned int gpu, unsigned int k, unsigned int tick) {
+    return static_cast<float>(5 + (tick + k * 7 + gpu * 11) % 36);
+}
+
+// A host with a /proc for the other collectors and the NVML stub
+static std::unique_ptr<IMetricsBackend> makeBackend(const FixtureTree& tree) {
+    tree.write("proc/stat", makeProcStat(4));
+    tree.write("proc/meminfo", makeMemInfo());
+    tree.write("proc/" + std::to_string(getpid()) + "/comm", "nvidia_test\n");
+
+    BackendOptions options;
+    options.fs_root = tree.root();
+    options.nvml_library = RESMON_NVML_STUB;
+    return createPlatformBackend(options);
+}
+
+static void testCallsPerSample() {
+    FixtureTree tree;
+    expect(tree.valid(), "fixture directory");
+
+    uint64_t before[4];
+    for (size_t i = 0; i < 4; ++i) {
+        before[i] = stubCalls(ENUMERATION_CALLS[i]);
+    }
+    uint64_t memory_before = stubCalls("nvmlDeviceGetMemoryInfo");
+    auto backend = makeBackend(tree);
+
+    expect(stubCalls("nvmlDeviceGetCount_v2") - before[0] == 1, "the device count is read once");
+    expect(stubCalls("nvmlDeviceGetHandleByIndex_v2") - before[1] == GPUS, "one handle per device");
+    expect(stubCalls("nvmlDeviceGetName") - before[2] == GPUS, "one name per device");
+    expect(stubCalls("nvmlDeviceGetUUID") - before[3] == GPUS, "one UUID per device");
+    expect(stubCalls("nvmlDeviceGetMemoryInfo") - memory_before == GPUS, "total VRAM is read with the device");
+    for (size_t i = 0; i < 4; ++i) {
+        before[i] = stubCalls(ENUMERATION_CALLS[i]);
+    }
+
+    // The first sample also sizes the process buffers
+    unsigned long long now = START_US;
+    stubSetClock(now);
+    SystemMetrics metrics = backend->collect();
+    expect(metrics.gpus.size() == GPUS, "every stub device is reported");
+    for (unsigned int i = 0; i < metrics.gpus.size() && i < GPUS; ++i) {
+        const GpuMetrics& gpu = metrics.gpus[i];
+        expect(gpu.vendor == "NVIDIA", "the vendor is NVIDIA");
+        expect(gpu.name == "NVIDIA H100 80GB HBM3 (stub " + std::to_string(i) + ")",
+               "the name comes from enumeration");
+        expect(gpu.vram_total_bytes == (80ull << 30), "total VRAM comes from enumeration");
+    }
+
+    for (int sample = 0; sample < 3; ++sample) {
+        now += STEP_US;
+        stubSetClock(now);
+        uint64_t calls = stubCallCount();
+        metrics = backend->collect();
+        expect(stubCallCount() - calls == CALLS_PER_DEVICE * GPUS, "a fixed number of NVML calls per device");
+        expect(metrics.gpus.size() == GPUS, "every stub device is reported on every sample");
+    }
+    for (size_t i = 0; i < 4; ++i) {
+        expect(stubCalls(ENUMERATION_CALLS[i]) == before[i], ENUMERATION_CALLS[i]);
+    }
+    stubSetClock(0);
+}
+
+static const GpuProcess* processWithPid(const GpuMetrics& gpu, uint32_t pid) {
+    for (const auto& process : gpu.processes) {
+        if (process.pid == pid) {
+            return &process;
+        }
+    }
+    return nullptr;
+}
+
+static void testProcessTable() {
+    FixtureTree tree;
+    expect(tree.valid(), "fixture directory");
+    for (unsigned int i = 0; i < GPUS; ++i) {
+        tree.write("proc/" + std::to_string(stubPid(i, 1)) + "/comm", "trainer\n");
+        tree.write("proc/" + std::to_string(stubPid(i, 2)) + "/comm", "Xorg\n");
+    }
+    auto backend = makeBackend(tree);
+
+    unsigned long long now = START_US;
+    stubSetClock(now);
+    SystemMetrics metrics = backend->collect();
+    expect(metrics.gpus.size() == GPUS, "every stub device is reported");
+    for (unsigned int i = 0; i < metrics.gpus.size() && i < GPUS; ++i) {
+        const GpuMetrics& gpu = metrics.gpus[i];
+        expect(gpu.processes.size() == 3, "compute and graphics lists are merged by pid");
+
+        // Process k uses (1 + k + gpu % 4) * 256 MiB, so the table is k = 2, 1, 0
+        static const char* const names[] = {"nvidia_test", "trainer", "Xorg"};
+        static const char* const types[] = {"C", "C+G", "G"};
+        for (unsigned int k = 0; k < 3 && k < gpu.processes.size(); ++k) {
+            const GpuProcess& process = gpu.processes[2 - k];
+            expect(process.pid == stubPid(i, k), "sorted by VRAM, largest first");
+            expect(process.name == names[k], "the command name is read below fs_root");
+            expect(process.vram_bytes == (256ull << 20) * (1 + k + i % 4), "per-process VRAM");
+            expect(std::string(gpuProcessType(process)) == types[k], "compute/graphics type");
+            expectNear(process.usage_percent, stubSmPercent(i, k, 0), 0.001, "SM% of the new sample");
+        }
+    }
+
+    // Nothing newer than the last utilization timestamp: the driver has no
+    // samples for the same instant, so every process is idle
+    metrics = backend->collect();
+    for (const auto& gpu : metrics.gpus) {
+        expect(gpu.processes.size() == 3, "the table stays complete without new samples");
+        for (const auto& process : gpu.processes) {
+            expect(process.usage_percent == 0.0f, "samples already seen are not counted again");
+        }
+    }
+
+    // One second later: new samples, after the utilization fallback above
+    // moved the stub on by one tick
+    now += STEP_US;
+    stubSetClock(now);
+    metrics = backend->collect();
+    for (unsigned int i = 0; i < metrics.gpus.size() && i < GPUS; ++i) {
+        for (unsigned int k = 0; k < 3; ++k) {
+            const GpuProcess* process = processWithPid(metrics.gpus[i], stubPid(i, k));
+            expect(process != nullptr, "every process is still listed");
+            if (process) {
+                expectNear(process->usage_percent, stubSmPercent(i, k, 1), 0.001, "SM% of the next sample");
+            }
+        }
+    }
+    stubSetClock(0);
+}
+
+// The process lists and per-process utilization of every device cost one
+// call each once the buffers fit, and two (size, then read) when they do
+// not, whether the driver answers the size query with
+// NVML_ERROR_INSUFFICIENT_SIZE or with NVML_SUCCESS and the count needed
+static void testSizeQueries(int size_answer) {
+    FixtureTree tree;
+    expect(tree.valid(), "fixture directory");
+    stubSetSizeAnswer(size_answer);
+    stubSetProcesses(3);
+    auto backend = makeBackend(tree);
+
+    struct Step {
+        unsigned int processes;
+        uint64_t compute_calls;
+        uint64_t graphics_calls;
+        uint64_t utilization_calls;
+    };
+    // The first sample sizes the buffers (graphics fits the compute
+    // buffer); 20 processes outgrow them; then they fit again
+    static const Step steps[] = {
+        {3, 2, 1, 2},
+        {3, 1, 1, 1},
+        {20, 2, 1, 2},
+        {20, 1, 1, 1},
+    };
+
+    unsigned long long now = START_US;
+    for (const Step& step : steps) {
+        stubSetProcesses(step.processes);
+        now += STEP_US;
+        stubSetClock(now);
+        uint64_t compute = stubCalls("nvmlDeviceGetComputeRunningProcesses_v3");
+        uint64_t graphics = stubCalls("nvmlDeviceGetGraphicsRunningProcesses_v3");
+        uint64_t utilization = stubCalls("nvmlDeviceGetProcessUtilization");
+        SystemMetrics metrics = backend->collect();
+
+        expect(stubCalls("nvmlDeviceGetComputeRunningProcesses_v3") - compute == step.compute_calls * GPUS,
+               "compute processes: one call, or a size query and a read");
+        expect(stubCalls("nvmlDeviceGetGraphicsRunningProcesses_v3") - graphics == step.graphics_calls * GPUS,
+               "graphics processes: one call, or a size query and a read");
+        expect(stubCalls("nvmlDeviceGetProcessUtilization") - utilization == step.utilization_calls * GPUS,
+               "process utilization: one call, or a size query and a read");
+        for (unsigned int i = 0; i < metrics.gpus.size() && i < GPUS; ++i) {
+            const GpuMetrics& gpu = metrics.gpus[i];
+            expect(gpu.processes.size() == step.processes, "every process is listed after a size query");
+            const GpuProcess* last = processWithPid(gpu, stubPid(i, step.processes - 1));
+            expect(last && last->graphics && !last->compute, "the last graphics entry is read");
+            if (last) {
+                expectNear(last->usage_percent, stubSmPercent(i, step.processes - 1, 0), 0.001,
+                           "the last utilization sample is read");
+            }
+        }
+    }
+
+    stubSetSizeAnswer(NVML_ERROR_INSUFFICIENT_SIZE);
+    stubSetProcesses(3);
+    stubSetClock(0);
+}
+
+// Samples strictly newer than after_us, in timestamp order, each at a
+// point of the stub's grid
+static bool ordered(const std::vector<GpuSample>& samples, uint64_t after_us, unsigned long long period) {
+    for (const auto& sample : samples) {
+        if (sample.timestamp_us <= after_us || sample.timestamp_us % period != 0) {
+            return false;
+        }
+        after_us = sample.timestamp_us;
+    }
+    return true;
+}
+
+static float mean(const std::vector<GpuSample>& samples) {
+    float sum = 0.0f;
+    for (const auto& sample : samples) {
+        sum += sample.value;
+    }
+    return samples.empty() ? 0.0f : sum / static_cast<float>(samples.size());
+}
+
+static void testDriverSamples() {
+    FixtureTree tree;
+    expect(tree.valid(), "fixture directory");
+    auto backend = makeBackend(tree);
+    GpuSampleHistory history(1024, GPUS);
+
+    // Start two utilization slots before the wrap point of the stub's ring,
+    // so the second read comes back unsorted
+    unsigned long long wrap_slot = START_US / UTILIZATION_PERIOD_US / STUB_SAMPLE_BUFFER_SIZE * STUB_SAMPLE_BUFFER_SIZE;
+    unsigned long long now = (wrap_slot - 2) * UTILIZATION_PERIOD_US + 1;
+
+    // The first read returns the driver's whole buffer
+    stubSetClock(now);
+    SystemMetrics metrics = backend->collect();
+    history.append(metrics);
+    expect(metrics.gpus.size() == GPUS, "every stub device is reported");
+    std::vector<uint64_t> newest_utilization(GPUS, 0);
+    std::vector<uint64_t> newest_power(GPUS, 0);
+    for (unsigned int i = 0; i < metrics.gpus.size() && i < GPUS; ++i) {
+        const GpuMetrics& gpu = metrics.gpus[i];
+        expect(gpu.utilization_samples.size() == STUB_SAMPLE_BUFFER_SIZE, "the first read is the whole buffer");
+        expect(gpu.power_samples.size() == STUB_SAMPLE_BUFFER_SIZE, "the first power read is the whole buffer");
+        expect(ordered(gpu.utilization_samples, 0, UTILIZATION_PERIOD_US), "utilization samples in order");
+        expect(ordered(gpu.power_samples, 0, POWER_PERIOD_US), "power samples in order");
+        expectNear(gpu.usage_percent, mean(gpu.utilization_samples), 0.001, "usage is the mean of the samples");
+        if (!gpu.utilization_samples.empty() && !gpu.power_samples.empty()) {
+            expect(gpu.utilization_samples.back().timestamp_us == now / UTILIZATION_PERIOD_US * UTILIZATION_PERIOD_US,
+                   "the newest utilization sample is the driver's newest");
+            expectNear(gpu.power_watts, gpu.power_samples.back().value, 0.001, "power is the newest sample");
+            newest_utilization[i] = gpu.utilization_samples.back().timestamp_us;
+            newest_power[i] = gpu.power_samples.back().timestamp_us;
+        }
+    }
+
+    // One second later: only the samples taken since, across the ring's
+    // wrap point
+    now += STEP_US;
+    stubSetClock(now);
+    metrics = backend->collect();
+    history.append(metrics);
+    for (unsigned int i = 0; i < metrics.gpus.size() && i < GPUS; ++i) {
+        const GpuMetrics& gpu = metrics.gpus[i];
+        expect(gpu.utilization_samples.size() == STEP_US / UTILIZATION_PERIOD_US, "only new utilization samples");
+        expect(gpu.power_samples.size() == STEP_US / POWER_PERIOD_US, "only new power samples");
+        expect(ordered(gpu.utilization_samples, newest_utilization[i], UTILIZATION_PERIOD_US),
+               "a read across the ring's wrap point is sorted and does not repeat samples");
+        expect(ordered(gpu.power_samples, newest_power[i], POWER_PERIOD_US), "power samples do not repeat");
+        expectNear(gpu.usage_percent, mean(gpu.utilization_samples), 0.001,
+                   "usage is the mean of the new samples only");
+        for (const auto& sample : gpu.utilization_samples) {
+            expectNear(sample.value, stubUtilization(i, sample.timestamp_us / UTILIZATION_PERIOD_US), 0.001,
+                       "each value keeps its own timestamp");
+        }
+    }
+
+    // No new samples at the same instant: the driver's averaged reading
+    uint64_t rates = stubCalls("nvmlDeviceGetUtilizationRates");
+    std::vector<float> power(GPUS, -1.0f);
+    for (unsigned int i = 0; i < metrics.gpus.size() && i < GPUS; ++i) {
+        power[i] = metrics.gpus[i].power_watts;
+    }
+    metrics = backend->collect();
+    history.append(metrics);
+    expect(stubCalls("nvmlDeviceGetUtilizationRates") - rates == GPUS,
+           "without new samples utilization falls back to GetUtilizationRates");
+    for (unsigned int i = 0; i < metrics.gpus.size() && i < GPUS; ++i) {
+        const GpuMetrics& gpu = metrics.gpus[i];
+        expect(gpu.utilization_samples.empty() && gpu.power_samples.empty(), "no samples are repeated");
+        // The stub's first GetUtilizationRates reading
+        expectNear(gpu.usage_percent, static_cast<float>((7 + i * 13) % 101), 0.001, "the fallback reading");
+        expectNear(gpu.power_watts, power[i], 0.001, "power keeps its newest sample");
+    }
+
+    // The history holds every sample once, at the driver's timestamps
+    for (unsigned int i = 0; i < GPUS; ++i) {
+        size_t expected = STUB_SAMPLE_BUFFER_SIZE + STEP_US / UTILIZATION_PERIOD_US;
+        expect(history.size(GpuSampleSeries::Utilization, i) == expected, "history keeps every utilization sample");
+        expect(history.size(GpuSampleSeries::Power, i) == STUB_SAMPLE_BUFFER_SIZE + STEP_US / POWER_PERIOD_US,
+               "history keeps every power sample");
+        expect(history.newest(GpuSampleSeries::Utilization, i) == now / UTILIZATION_PERIOD_US * UTILIZATION_PERIOD_US,
+               "the newest history sample is the driver's newest");
+
+        HistoryRange range = history.range(GpuSampleSeries::Utilization, i, 0, UINT64_MAX);
+        auto timestamps = history.timestamps(GpuSampleSeries::Utilization, i, range);
+        auto values = history.values(GpuSampleSeries::Utilization, i, range);
+        bool consecutive = timestamps.size() == expected;
+        bool matching = consecutive;
+        for (size_t j = 0; j < timestamps.size(); ++j) {
+            if (j > 0 && timestamps[j] != timestamps[j - 1] + UTILIZATION_PERIOD_US) {
+                consecutive = false;
+            }
+            if (values[j] != stubUtilization(i, timestamps[j] / UTILIZATION_PERIOD_US)) {
+                matching = false;
+            }
+        }
+        expect(consecutive, "history samples are consecutive grid points, no gaps or repeats");
+        expect(matching, "history values sit at their own timestamps");
+    }
+    stubSetClock(0);
+}
+
+int main() {
+    setenv("RESMON_STUB_GPUS", std::to_string(GPUS).c_str(), 1);
+    if (!loadStub()) {
+        std::fprintf(stderr, "cannot load the NVML stub %s\n", RESMON_NVML_STUB);
+        return 1;
+    }
+
+    testCallsPerSample();
+    testProcessTable();
+    testSizeQueries(NVML_ERROR_INSUFFICIENT_SIZE);
+    testSizeQueries(NVML_SUCCESS);
+    testDriverSamples();
+    return testResult("nvidia_test");
+}
@@ -0,0 +1,396 @@
+// Minimal stand-in for libnvidia-ml.so, for testing and benchmarking the
+// NVIDIA collector on machines without an NVIDIA driver.
+//
+// Exposes RESMON_STUB_GPUS devices (default 8) with slowly changing
+// synthetic readings, and counts every NVML call, in total
+// (resmonStubCallCount()) and per function (resmonStubCalls()), so callers
+// can check the driver round trips per sample.
+//
+// Each device runs resmonStubSetProcesses() processes (default 3): the
+// calling process (compute), then synthetic pids that are compute+graphics,
+// and a last one that is graphics-only. Per-process utilization yields one
+// sample per process per call, timestamped with the clock, and honours
+// lastSeenTimeStamp like the real library. nvmlDeviceGetSamples serves
+// bursty utilization (every 1/6 s) and power (every 20 ms) samples on a
+// clock-aligned grid, SAMPLE_BUFFER_SIZE deep and in the order of the
+// driver's ring, so a read that spans its wrap point comes back unsorted.
+//
+// Tests can pin the clock (resmonStubSetClock()) and make size queries
+// answer SUCCESS with the count needed, as some drivers do
+// (resmonStubSetSizeAnswer()).
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <unistd.h>
+
+namespace {
+
+constexpr int NVML_SUCCESS = 0;
+constexpr int NVML_ERROR_INVALID_ARGUMENT = 2;
+constexpr int NVML_ERROR_UNINITIALIZED = 1;
+constexpr int NVML_ERROR_NOT_FOUND = 6;
+constexpr int NVML_ERROR_INSUFFICIENT_SIZE = 7;
+constexpr unsigned int MAX_DEVICES = 64;
+constexpr unsigned int MAX_PROCESSES = 64;
+constexpr unsigned int SAMPLE_BUFFER_SIZE = 120;
+constexpr int TOTAL_POWER_SAMPLES = 0;
+constexpr int GPU_UTILIZATION_SAMPLES = 1;
+constexpr int VALUE_TYPE_UNSIGNED_INT = 1;
+
+enum Function {
+    INIT,
+    SHUTDOWN,
+    GET_COUNT,
+    GET_HANDLE_BY_INDEX,
+    GET_NAME,
+    GET_UUID,
+    GET_UTILIZATION_RATES,
+    GET_TEMPERATURE,
+    GET_MEMORY_INFO,
+    GET_COMPUTE_RUNNING_PROCESSES,
+    GET_GRAPHICS_RUNNING_PROCESSES,
+    GET_PROCESS_UTILIZATION,
+    GET_SAMPLES,
+    FUNCTION_COUNT
+};
+
+const char* const FUNCTION_NAMES[FUNCTION_COUNT] = {
+    "nvmlInit_v2",
+    "nvmlShutdown",
+    "nvmlDeviceGetCount_v2",
+    "nvmlDeviceGetHandleByIndex_v2",
+    "nvmlDeviceGetName",
+    "nvmlDeviceGetUUID",
+    "nvmlDeviceGetUtilizationRates",
+    "nvmlDeviceGetTemperature",
+    "nvmlDeviceGetMemoryInfo",
+    "nvmlDeviceGetComputeRunningProcesses_v3",
+    "nvmlDeviceGetGraphicsRunningProcesses_v3",
+    "nvmlDeviceGetProcessUtilization",
+    "nvmlDeviceGetSamples",
+};
+
+struct StubDevice {
+    unsigned int index;
+    unsigned int tick;
+};
+
+struct ProcessInfo {
+    unsigned int pid;
+    unsigned long long usedGpuMemory;
+    unsigned int gpuInstanceId;
+    unsigned int computeInstanceId;
+};
+
+struct Sample {
+    unsigned long long timeStamp;
+    union {
+        double dVal;
+        unsigned int uiVal;
+        unsigned long long ullVal;
+    } sampleValue;
+};
+
+struct ProcessUtilizationSample {
+    unsigned int pid;
+    unsigned long long timeStamp;
+    unsigned int smUtil;
+    unsigned int memUtil;
+    unsigned int encUtil;
+    unsigned int decUtil;
+};
+
+struct Utilization {
+    unsigned int gpu;
+    unsigned int memory;
+};
+
+struct Memory {
+    unsigned long long total;
+    unsigned long long free;
+    unsigned long long used;
+};
+
+StubDevice g_devices[MAX_DEVICES];
+unsigned int g_device_count = 0;
+bool g_initialized = false;
+std::atomic<uint64_t> g_calls[FUNCTION_COUNT];
+std::atomic<unsigned int> g_processes{3};
+std::atomic<int> g_size_answer{NVML_ERROR_INSUFFICIENT_SIZE};
+std::atomic<unsigned long long> g_clock{0};
+
+void called(Function function) {
+    ++g_calls[function];
+}
+
+StubDevice* device(void* handle) {
+    auto* d = static_cast<StubDevice*>(handle);
+    if (!g_initialized || d < g_devices || d >= g_devices + g_device_count) {
+        return nullptr;
+    }
+    return d;
+}
+
+unsigned long long nowMicros() {
+    unsigned long long pinned = g_clock.load();
+    if (pinned != 0) {
+        return pinned;
+    }
+    timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return static_cast<unsigned long long>(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+}
+
+// Utilization in percent, power in milliwatts; both with a short burst
+// every few samples
+unsigned int sampleAt(const StubDevice* d, int type, unsigned long long slot) {
+    if (type == GPU_UTILIZATION_SAMPLES) {
+        return (slot + d->index) % 6 == 0 ? 97 : 4 + static_cast<unsigned int>(slot % 5);
+    }
+    return (slot + d->index) % 50 < 5 ? 650000 : 120000 + static_cast<unsigned int>(slot % 7) * 1000;
+}
+
+// Process k of a device; pids well above any real pid_max, except the
+// caller's own so its name resolves
+unsigned int processPid(const StubDevice* d, unsigned int k) {
+    if (k == 0) {
+        return static_cast<unsigned int>(getpid());
+    }
+    return 5000000 + d->index * MAX_PROCESSES + k;
+}
+
+// Processes 0..n-2 are compute, 1..n-1 graphics
+int runningProcesses(void* handle, unsigned int* count, ProcessInfo* infos, unsigned int first) {
+    StubDevice* d = device(handle);
+    if (!d || !count) {
+        return NVML_ERROR_INVALID_ARGUMENT;
+    }
+    unsigned int n = g_processes.load() - 1;
+    if (*count < n || !infos) {
+        *count = n;
+        return g_size_answer.load();
+    }
+    for (unsigned int i = 0; i < n; ++i) {
+        unsigned int k = first + i;
+        infos[i] = ProcessInfo{processPid(d, k), (256ull << 20) * (1 + k + d->index % 4), 0, 0};
+    }
+    *count = n;
+    return NVML_SUCCESS;
+}
+
+} // namespace
+
+extern "C" {
+
+uint64_t resmonStubCallCount() {
+    uint64_t total = 0;
+    for (const auto& calls : g_calls) {
+        total += calls.load();
+    }
+    return total;
+}
+
+// Calls of one NVML function, by its exported name; 0 for unknown names
+uint64_t resmonStubCalls(const char* function) {
+    for (int i = 0; i < FUNCTION_COUNT; ++i) {
+        if (std::strcmp(function, FUNCTION_NAMES[i]) == 0) {
+            return g_calls[i].load();
+        }
+    }
+    return 0;
+}
+
+// Processes per device, 2 to MAX_PROCESSES
+void resmonStubSetProcesses(unsigned int processes) {
+    g_processes = processes < 2 ? 2 : processes > MAX_PROCESSES ? MAX_PROCESSES : processes;
+}
+
+// What a size query (no buffer, or one too small) returns along with the
+// count needed: NVML_ERROR_INSUFFICIENT_SIZE (default) or NVML_SUCCESS
+void resmonStubSetSizeAnswer(int result) {
+    g_size_answer = result;
+}
+
+// Pin the clock to micros since the epoch; 0 = the wall clock (default)
+void resmonStubSetClock(unsigned long long micros) {
+    g_clock = micros;
+}
+
+int nvmlInit_v2() {
+    called(INIT);
+    const char* env = std::getenv("RESMON_STUB_GPUS");
+    long gpus = env ? std::strtol(env, nullptr, 10) : 8;
+    if (gpus < 0) {
+        gpus = 0;
+    }
+    g_device_count = static_cast<unsigned int>(gpus) < MAX_DEVICES ? static_cast<unsigned int>(gpus) : MAX_DEVICES;
+    for (unsigned int i = 0; i < g_device_count; ++i) {
+        g_devices[i] = StubDevice{i, 0};
+    }
+    g_initialized = true;
+    return NVML_SUCCESS;
+}
+
+int nvmlShutdown() {
+    called(SHUTDOWN);
+    g_initialized = false;
+    return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetCount_v2(unsigned int* device_count) {
+    called(GET_COUNT);
+    if (!g_initialized) {
+        return NVML_ERROR_UNINITIALIZED;
+    }
+    *device_count = g_device_count;
+    return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetHandleByIndex_v2(unsigned int index, void** handle) {
+    called(GET_HANDLE_BY_INDEX);
+    if (!g_initialized || index >= g_device_count) {
+        return NVML_ERROR_INVALID_ARGUMENT;
+    }
+    *handle = &g_devices[index];
+    return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetName(void* handle, char* name, unsigned int length) {
+    called(GET_NAME);
+    StubDevice* d = device(handle);
+    if (!d || length == 0) {
+        return NVML_ERROR_INVALID_ARGUMENT;
+    }
+    std::snprintf(name, length, "NVIDIA H100 80GB HBM3 (stub %u)", d->index);
+    return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetUUID(void* handle, char* uuid, unsigned int length) {
+    called(GET_UUID);
+    StubDevice* d = device(handle);
+    if (!d || length == 0) {
+        return NVML_ERROR_INVALID_ARGUMENT;
+    }
+    std::snprintf(uuid, length, "GPU-00000000-0000-0000-0000-%012u", d->index);
+    return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetUtilizationRates(void* handle, Utilization* utilization) {
+    called(GET_UTILIZATION_RATES);
+    StubDevice* d = device(handle);
+    if (!d) {
+        return NVML_ERROR_INVALID_ARGUMENT;
+    }
+    ++d->tick;
+    utilization->gpu = (d->tick * 7 + d->index * 13) % 101;
+    utilization->memory = (d->tick * 3 + d->index) % 101;
+    return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetTemperature(void* handle, int sensor, unsigned int* temp) {
+    called(GET_TEMPERATURE);
+    StubDevice* d = device(handle);
+    if (!d || sensor != 0) {
+        return NVML_ERROR_INVALID_ARGUMENT;
+    }
+    *temp = 40 + (d->tick + d->index) % 40;
+    return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetMemoryInfo(void* handle, Memory* memory) {
+    called(GET_MEMORY_INFO);
+    StubDevice* d = device(handle);
+    if (!d) {
+        return NVML_ERROR_INVALID_ARGUMENT;
+    }
+    memory->total = 80ull << 30;
+    memory->used = (1ull << 30) * (1 + (d->tick + d->index) % 79);
+    memory->free = memory->total - memory->used;
+    return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetComputeRunningProcesses_v3(void* handle, unsigned int* count, ProcessInfo* infos) {
+    called(GET_COMPUTE_RUNNING_PROCESSES);
+    return runningProcesses(handle, count, infos, 0);
+}
+
+int nvmlDeviceGetGraphicsRunningProcesses_v3(void* handle, unsigned int* count, ProcessInfo* infos) {
+    called(GET_GRAPHICS_RUNNING_PROCESSES);
+    return runningProcesses(handle, count, infos, 1);
+}
+
+// SM% of process k: 5-40, changing with the device's utilization reads
+int nvmlDeviceGetProcessUtilization(void* handle, ProcessUtilizationSample* samples, unsigned int* count,
+                                    unsigned long long last_seen) {
+    called(GET_PROCESS_UTILIZATION);
+    StubDevice* d = device(handle);
+    if (!d || !count) {
+        return NVML_ERROR_INVALID_ARGUMENT;
+    }
+    unsigned long long timestamp = nowMicros();
+    if (timestamp <= last_seen) {
+        return NVML_ERROR_NOT_FOUND;
+    }
+    unsigned int n = g_processes.load();
+    if (*count < n || !samples) {
+        *count = n;
+        return g_size_answer.load();
+    }
+    for (unsigned int k = 0; k < n; ++k) {
+        unsigned int sm = 5 + (d->tick + k * 7 + d->index * 11) % 36;
+        samples[k] = ProcessUtilizationSample{processPid(d, k), timestamp, sm, sm / 2, 0, 0};
+    }
+    *count = n;
+    return NVML_SUCCESS;
+}
+
+int nvmlDeviceGetSamples(void* handle, int type, unsigned long long last_seen, int* value_type,
+                         unsigned int* count, Sample* samples) {
+    called(GET_SAMPLES);
+    StubDevice* d = device(handle);
+    if (!d || !count || !value_type || (type != TOTAL_POWER_SAMPLES && type != GPU_UTILIZATION_SAMPLES)) {
+        return NVML_ERROR_INVALID_ARGUMENT;
+    }
+    *value_type = VALUE_TYPE_UNSIGNED_INT;
+    if (!samples) {
+        *count = SAMPLE_BUFFER_SIZE;
+        return NVML_SUCCESS;
+    }
+
+    // The newest SAMPLE_BUFFER_SIZE grid points are "in the driver's buffer"
+    const unsigned long long period = type == GPU_UTILIZATION_SAMPLES ? 166667 : 20000;
+    unsigned long long newest = nowMicros() / period;
+    unsigned long long oldest = newest - (SAMPLE_BUFFER_SIZE - 1);
+    unsigned long long first = last_seen / period + 1;
+    if (first < oldest) {
+        first = oldest;
+    }
+    if (*count > 0 && newest - first + 1 > *count) {
+        first = newest - *count + 1;
+    }
+    if (first > newest || *count == 0) {
+        return NVML_ERROR_NOT_FOUND;
+    }
+
+    // Slot s sits at s % SAMPLE_BUFFER_SIZE in the ring, which is returned
+    // from its start: slots from the wrap point on come first
+    unsigned long long wrap = (first + SAMPLE_BUFFER_SIZE - 1) / SAMPLE_BUFFER_SIZE * SAMPLE_BUFFER_SIZE;
+    if (wrap > newest) {
+        wrap = first;
+    }
+    unsigned int n = 0;
+    for (unsigned long long i = 0; i <= newest - first; ++i, ++n) {
+        unsigned long long slot = wrap + i <= newest ? wrap + i : first + (wrap + i - newest - 1);
+        std::memset(&samples[n], 0, sizeof(Sample));
+        samples[n].timeStamp = slot * period;
+        samples[n].sampleValue.uiVal = sampleAt(d, type, slot);
+    }
+    *count = n;
+    return NVML_SUCCESS;
+}
+
+} // extern "C"